@@ -0,0 +1,155 @@
+#pragma once
+
+#include "auto.hpp"
+#include "bytes.hpp"
+#include "funcs.hpp"
+#include "moves.hpp"
+#include "name.hpp"
+#include "typeinf.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "cxx.h"
+
+#include "types_index.h"
+
+#ifndef CXXBRIDGE1_STRUCT_annotation_op_t
+#define CXXBRIDGE1_STRUCT_annotation_op_t
+struct annotation_op_t final {
+  ::std::uint64_t ea;
+  ::std::uint8_t kind;
+  ::std::int32_t flags;
+  ::std::uint32_t value;
+  ::std::uint32_t text;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_annotation_op_t
+
+// Operation kinds; `text` is an offset into the NUL-separated text arena
+enum : std::uint8_t {
+  IDALIB_ANNOTATE_NAME,
+  IDALIB_ANNOTATE_COMMENT,
+  IDALIB_ANNOTATE_APPEND_COMMENT,
+  IDALIB_ANNOTATE_FUNC_COMMENT,
+  IDALIB_ANNOTATE_TYPE_DECL,
+  IDALIB_ANNOTATE_TYPE_ORDINAL,
+  IDALIB_ANNOTATE_BOOKMARK,
+};
+
+// Per-operation outcomes
+enum : std::uint8_t {
+  IDALIB_ANNOTATE_APPLIED,
+  IDALIB_ANNOTATE_FAILED,
+  IDALIB_ANNOTATE_INVALID,
+};
+
+// Apply `ops` in address order (ties keep their order in `ops`) with
+// auto-analysis disabled, restoring its previous state once at the end.
+// `statuses` receives one outcome per operation, in the order of `ops`;
+// returns the number of operations applied.
+size_t idalib_apply_annotations(rust::Slice<const annotation_op_t> ops,
+                                rust::Slice<const std::uint8_t> text,
+                                rust::Vec<std::uint8_t> &statuses) {
+  statuses.clear();
+  statuses.reserve(ops.size());
+  for (size_t i = 0; i < ops.size(); i++) {
+    statuses.push_back(IDALIB_ANNOTATE_INVALID);
+  }
+
+  // Every string must be NUL-terminated within the arena
+  if (!text.empty() && text[text.size() - 1] != 0) {
+    return 0;
+  }
+
+  std::vector<size_t> order(ops.size());
+  std::iota(std::begin(order), std::end(order), 0);
+  std::stable_sort(std::begin(order), std::end(order),
+                   [&](size_t a, size_t b) { return ops[a].ea < ops[b].ea; });
+
+  til_t *til = get_idati();
+
+  // A single bookmark location, re-pointed for each bookmark in the batch
+  auto widget = qstring();
+  idaplace_t ipl(0, 0);
+  renderer_info_t rinfo;
+  rinfo.rtype = TCCRT_FLAT;
+  rinfo.pos.cx = 0;
+  rinfo.pos.cy = 5;
+#if IDA_SDK_VERSION >= 920
+  lochist_entry_t loc(&ipl, rinfo, widget);
+#else
+  lochist_entry_t loc(&ipl, rinfo);
+#endif
+  auto next_bookmark = BOOKMARKS_BAD_INDEX;
+
+  auto was_enabled = enable_auto(false);
+  size_t applied = 0;
+
+  for (auto i : order) {
+    const auto &op = ops[i];
+
+    if (op.text >= text.size()) {
+      continue;
+    }
+    auto s = reinterpret_cast<const char *>(text.data() + op.text);
+
+    bool ok = false;
+
+    switch (op.kind) {
+    case IDALIB_ANNOTATE_NAME:
+      ok = set_name(op.ea, s, op.flags);
+      break;
+    case IDALIB_ANNOTATE_COMMENT:
+      ok = set_cmt(op.ea, s, op.flags != 0);
+      break;
+    case IDALIB_ANNOTATE_APPEND_COMMENT:
+      ok = append_cmt(op.ea, s, op.flags != 0);
+      break;
+    case IDALIB_ANNOTATE_FUNC_COMMENT: {
+      auto f = get_func(op.ea);
+      ok = f != nullptr && set_func_cmt(f, s, op.flags != 0);
+      break;
+    }
+    case IDALIB_ANNOTATE_TYPE_DECL:
+      ok = til != nullptr && apply_cdecl(til, op.ea, s, op.flags);
+      idalib_type_index_invalidate();
+      break;
+    case IDALIB_ANNOTATE_TYPE_ORDINAL: {
+      tinfo_t tif;
+      ok = tif.get_numbered_type(til, op.value) &&
+           apply_tinfo(op.ea, tif, op.flags);
+      break;
+    }
+    case IDALIB_ANNOTATE_BOOKMARK: {
+      if (next_bookmark == BOOKMARKS_BAD_INDEX) {
+        next_bookmark = bookmarks_t_size(loc, nullptr);
+      }
+
+      ipl.ea = op.ea;
+      loc.set_place(ipl);
+
+      auto index = op.value == BOOKMARKS_BAD_INDEX ? next_bookmark : op.value;
+      auto slot = bookmarks_t_mark(loc, index, nullptr, s, nullptr);
+
+      ok = slot != BOOKMARKS_BAD_INDEX;
+      if (ok) {
+        next_bookmark = std::max(next_bookmark, slot + 1);
+      }
+      break;
+    }
+    default:
+      continue;
+    }
+
+    statuses[i] = ok ? IDALIB_ANNOTATE_APPLIED : IDALIB_ANNOTATE_FAILED;
+    applied += ok;
+  }
+
+  enable_auto(was_enabled);
+
+  return applied;
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "auto.hpp"
+#include "pro.h"
+
+#include <chrono>
+#include <cstdint>
+
+#include "cxx.h"
+
+#ifndef CXXBRIDGE1_STRUCT_auto_stage_time_t
+#define CXXBRIDGE1_STRUCT_auto_stage_time_t
+struct auto_stage_time_t final {
+  ::std::int32_t queue;
+  ::std::uint64_t nanos;
+  ::std::uint64_t steps;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_auto_stage_time_t
+
+#ifndef CXXBRIDGE1_STRUCT_auto_step_t
+#define CXXBRIDGE1_STRUCT_auto_step_t
+struct auto_step_t final {
+  ::std::uint64_t steps;
+  ::std::uint64_t nanos;
+  ::std::int32_t queue;
+  ::std::uint64_t ea;
+  bool done;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_auto_step_t
+
+#ifndef CXXBRIDGE1_STRUCT_auto_queue_depth_t
+#define CXXBRIDGE1_STRUCT_auto_queue_depth_t
+struct auto_queue_depth_t final {
+  ::std::int32_t queue;
+  ::std::uint64_t pending;
+  ::std::uint64_t next;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_auto_queue_depth_t
+
+// Auto-analysis queues, in the order the kernel drains them.
+static constexpr atype_t idalib_auto_queues[] = {
+    AU_UNK,  AU_CODE, AU_WEAK, AU_PROC, AU_TAIL, AU_FCHUNKS, AU_USED,
+    AU_USD2, AU_TYPE, AU_LIBF, AU_LBF2, AU_LBF3, AU_CHLB,    AU_FINAL,
+};
+
+// The queue the next analysis step will be taken from, or AU_NONE if all
+// queues are empty.
+static atype_t idalib_auto_next_queue() {
+  for (auto queue : idalib_auto_queues) {
+    if (peek_auto_queue(0, queue) != BADADDR) {
+      return queue;
+    }
+  }
+  return AU_NONE;
+}
+
+static void idalib_auto_record_stage(rust::Vec<auto_stage_time_t> &stages,
+                                     atype_t queue,
+                                     std::chrono::steady_clock::duration spent,
+                                     uint64_t steps) {
+  auto nanos =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(spent).count();
+
+  for (auto &stage : stages) {
+    if (stage.queue == queue) {
+      stage.nanos += nanos;
+      stage.steps += steps;
+      return;
+    }
+  }
+
+  stages.push_back(auto_stage_time_t{queue, (uint64_t)nanos, steps});
+}
+
+// Run auto-analysis one step at a time until the queues are empty, or
+// `max_steps` steps or `max_nanos` nanoseconds have been spent (zero for no
+// limit), accumulating the time spent on each queue into `stages`. Stepping
+// also stops, with `done` as reported by auto_is_ok, if no further step can
+// be made; the budget is never exceeded by draining the rest with auto_wait.
+auto_step_t idalib_auto_step(uint64_t max_steps, uint64_t max_nanos,
+                             rust::Vec<auto_stage_time_t> &stages) {
+  using clock = std::chrono::steady_clock;
+
+  auto_step_t out{0, 0, AU_NONE, BADADDR, false};
+
+  auto start = clock::now();
+  auto deadline = start + std::chrono::nanoseconds(max_nanos);
+
+  while (max_steps == 0 || out.steps < max_steps) {
+    auto queue = idalib_auto_next_queue();
+
+    if (queue != AU_NONE) {
+      auto ea = peek_auto_queue(0, queue);
+      auto step_start = clock::now();
+
+      if (auto_make_step(0, BADADDR)) {
+        idalib_auto_record_stage(stages, queue, clock::now() - step_start, 1);
+
+        out.queue = queue;
+        out.ea = ea;
+        out.steps++;
+
+        if (max_nanos != 0 && clock::now() >= deadline) {
+          break;
+        }
+        continue;
+      }
+    }
+
+    out.done = auto_is_ok();
+    break;
+  }
+
+  out.nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  clock::now() - start)
+                  .count();
+
+  return out;
+}
+
+// Run auto-analysis to completion, as auto_wait, with per-queue timings.
+// Whatever auto_wait still does once no more steps can be made (e.g., the
+// kernel's final pass) is charged to AU_FINAL.
+bool idalib_auto_wait_profiled(rust::Vec<auto_stage_time_t> &stages) {
+  if (idalib_auto_step(0, 0, stages).done) {
+    return true;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  auto done = auto_wait();
+  idalib_auto_record_stage(stages, AU_FINAL,
+                           std::chrono::steady_clock::now() - start, 0);
+
+  return done;
+}
+
+// Count the pending entries of each non-empty queue, stopping at `limit`
+// entries per queue.
+void idalib_auto_queue_depths(uint64_t limit,
+                              rust::Vec<auto_queue_depth_t> &out) {
+  out.clear();
+
+  for (auto queue : idalib_auto_queues) {
+    auto next = peek_auto_queue(0, queue);
+    if (next == BADADDR) {
+      continue;
+    }
+
+    uint64_t pending = 0;
+    for (auto ea = next; ea != BADADDR && pending < limit;
+         ea = ea + 1 == BADADDR ? BADADDR : peek_auto_queue(ea + 1, queue)) {
+      pending++;
+    }
+
+    out.push_back(auto_queue_depth_t{queue, pending, next});
+  }
+}
+
+// Whether any queue still has work in [start, end).
+bool idalib_auto_pending_in(ea_t start, ea_t end) {
+  for (auto queue : idalib_auto_queues) {
+    auto ea = peek_auto_queue(start, queue);
+    if (ea != BADADDR && ea < end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool idalib_auto_is_done() { return auto_is_ok(); }
@@ -1,9 +1,56 @@
 #pragma once
 
+#include "auto.hpp"
 #include "bytes.hpp"
+#include "funcs.hpp"
+#include "segment.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "cxx.h"
 
+#ifndef CXXBRIDGE1_STRUCT_patch_range_t
+#define CXXBRIDGE1_STRUCT_patch_range_t
+struct patch_range_t final {
+  ::std::uint64_t ea;
+  ::std::uint64_t offset;
+  ::std::uint64_t size;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_patch_range_t
+
+#ifndef CXXBRIDGE1_STRUCT_patch_result_t
+#define CXXBRIDGE1_STRUCT_patch_result_t
+struct patch_result_t final {
+  ::std::uint64_t written;
+  ::rust::Vec<::std::uint8_t> applied;
+  ::rust::Vec<::std::uint64_t> planned;
+  ::rust::Vec<::std::uint64_t> heads;
+  ::rust::Vec<::std::uint64_t> functions;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_patch_result_t
+
+#ifndef CXXBRIDGE1_STRUCT_flags_map_t
+#define CXXBRIDGE1_STRUCT_flags_map_t
+struct flags_map_t final {
+  ::std::uint64_t start;
+  ::std::uint64_t end;
+  ::std::uint64_t words;
+  ::rust::Vec<::std::uint64_t> bits;
+  ::rust::Vec<::std::uint64_t> span_starts;
+  ::rust::Vec<::std::uint8_t> span_kinds;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_flags_map_t
+
 std::uint8_t idalib_get_byte(ea_t ea) { return get_byte(ea); }
 std::uint16_t idalib_get_word(ea_t ea) { return get_word(ea); }
 std::uint32_t idalib_get_dword(ea_t ea) { return get_dword(ea); }
@@ -17,3 +64,254 @@ std::size_t idalib_get_bytes(ea_t ea, rust::Vec<rust::u8> &buf) {
     return 0;
   }
 }
+
+// Read `buf.size()` bytes at `ea` into a borrowed buffer. When `mask` is
+// non-empty, it receives one bit per byte (LSB first) that is set for bytes
+// holding a value; bytes without one are read as 0xFF.
+std::size_t idalib_get_bytes_into(ea_t ea, rust::Slice<rust::u8> buf,
+                                  rust::Slice<rust::u8> mask) {
+  if (buf.empty()) {
+    return 0;
+  }
+
+  if (!mask.empty() && mask.size() < (buf.size() + 7) / 8) {
+    throw std::runtime_error("mask too small for buffer");
+  }
+
+  if (auto sz = get_bytes(buf.data(), buf.size(), ea, GMB_READALL,
+                          mask.empty() ? nullptr : mask.data());
+      sz >= 0) {
+    return sz;
+  } else {
+    return 0;
+  }
+}
+
+// True if every byte of [start, end) lies within a segment.
+static bool idalib_range_is_mapped(ea_t start, ea_t end) {
+  while (start < end) {
+    auto s = getseg(start);
+    if (s == nullptr) {
+      return false;
+    }
+    start = s->end_ea;
+  }
+  return true;
+}
+
+// Write each of `ranges` (slices of `data`) in order, with `patch_bytes` when
+// `patch` is set (keeping the original bytes) and `put_bytes` otherwise.
+// Ranges that are empty, out of bounds of `data`, or not entirely mapped are
+// skipped. Auto-analysis is disabled while writing; afterwards, the written
+// ranges are widened to the items they touch, merged, and (if `reanalyze` is
+// set) each merged range is queued once with `plan_range`.
+//
+// `out.applied` receives one flag per range, in the order of `ranges`;
+// `out.planned` receives the merged [start, end) pairs; `out.heads` and
+// `out.functions` the (sorted, unique) item heads within them and the start
+// addresses of the functions owning those heads.
+void idalib_patch_ranges(rust::Slice<const patch_range_t> ranges,
+                         rust::Slice<const std::uint8_t> data, bool patch,
+                         bool reanalyze, patch_result_t &out) {
+  out.written = 0;
+  out.applied.clear();
+  out.planned.clear();
+  out.heads.clear();
+  out.functions.clear();
+
+  out.applied.reserve(ranges.size());
+
+  std::vector<std::pair<ea_t, ea_t>> touched;
+  touched.reserve(ranges.size());
+
+  auto was_enabled = enable_auto(false);
+
+  for (const auto &r : ranges) {
+    ea_t start = r.ea;
+    ea_t end = start + r.size;
+
+    bool ok = r.size != 0 && r.offset <= data.size() &&
+              r.size <= data.size() - r.offset && end > start &&
+              idalib_range_is_mapped(start, end);
+
+    out.applied.push_back(ok);
+
+    if (!ok) {
+      continue;
+    }
+
+    auto buf = data.data() + r.offset;
+    if (patch) {
+      patch_bytes(start, buf, r.size);
+    } else {
+      put_bytes(start, buf, r.size);
+    }
+
+    out.written += r.size;
+    touched.emplace_back(start, end);
+  }
+
+  enable_auto(was_enabled);
+
+  // Widen to item boundaries so partially overwritten heads are covered
+  for (auto &t : touched) {
+    t.first = get_item_head(t.first);
+    t.second = std::max(t.second, get_item_end(get_item_head(t.second - 1)));
+  }
+
+  std::sort(std::begin(touched), std::end(touched));
+
+  std::vector<std::pair<ea_t, ea_t>> merged;
+  for (const auto &t : touched) {
+    if (!merged.empty() && t.first <= merged.back().second) {
+      merged.back().second = std::max(merged.back().second, t.second);
+    } else {
+      merged.push_back(t);
+    }
+  }
+
+  std::vector<ea_t> functions;
+
+  out.planned.reserve(merged.size() * 2);
+  for (const auto &[start, end] : merged) {
+    out.planned.push_back(start);
+    out.planned.push_back(end);
+
+    auto head = is_head(get_flags(start)) ? start : next_head(start, end);
+    while (head != BADADDR && head < end) {
+      out.heads.push_back(head);
+      if (auto f = get_func(head); f != nullptr) {
+        if (functions.empty() || functions.back() != f->start_ea) {
+          functions.push_back(f->start_ea);
+        }
+      }
+      head = next_head(head, end);
+    }
+
+    if (reanalyze) {
+      plan_range(start, end);
+    }
+  }
+
+  std::sort(std::begin(functions), std::end(functions));
+  functions.erase(std::unique(std::begin(functions), std::end(functions)),
+                  std::end(functions));
+
+  out.functions.reserve(functions.size());
+  for (auto f : functions) {
+    out.functions.push_back(f);
+  }
+}
+
+// Bitmap planes of `flags_map_t::bits`, each `words` 64-bit words long
+enum : std::uint8_t {
+  IDALIB_FLAGS_CODE,
+  IDALIB_FLAGS_DATA,
+  IDALIB_FLAGS_HEAD,
+  IDALIB_FLAGS_TAIL,
+  IDALIB_FLAGS_UNKNOWN,
+  IDALIB_FLAGS_PLANES,
+};
+
+// Kinds of `flags_map_t::span_kinds`
+enum : std::uint8_t {
+  IDALIB_SPAN_CODE,
+  IDALIB_SPAN_DATA,
+  IDALIB_SPAN_OTHER,
+  IDALIB_SPAN_UNKNOWN,
+};
+
+// Set bits [from, to) of the plane starting at `words`.
+static void idalib_set_bits(std::uint64_t *words, std::uint64_t from,
+                            std::uint64_t to) {
+  while (from < to && from % 64 != 0) {
+    words[from / 64] |= std::uint64_t(1) << (from % 64);
+    from++;
+  }
+  while (to - from >= 64) {
+    words[from / 64] = ~std::uint64_t(0);
+    from += 64;
+  }
+  while (from < to) {
+    words[from / 64] |= std::uint64_t(1) << (from % 64);
+    from++;
+  }
+}
+
+// Classify every byte of [start, end) by walking it item by item: one
+// `get_flags` per item head (or unexplored run) rather than per byte. Bit
+// `i` of each plane (LSB first) describes `start + i`; code and data bits
+// cover whole items. With `spans`, `span_starts`/`span_kinds` also receive
+// one entry per item and per run of unexplored bytes, each ending where the
+// next begins (or at `end`).
+void idalib_get_flags_map(ea_t start, ea_t end, bool spans,
+                          flags_map_t &out) {
+  end = std::max(start, end);
+
+  std::uint64_t size = end - start;
+  std::uint64_t words = (size + 63) / 64;
+
+  out.start = start;
+  out.end = end;
+  out.words = words;
+
+  out.bits.clear();
+  out.span_starts.clear();
+  out.span_kinds.clear();
+
+  out.bits.reserve(words * IDALIB_FLAGS_PLANES);
+  for (std::uint64_t i = 0; i < words * IDALIB_FLAGS_PLANES; i++) {
+    out.bits.push_back(0);
+  }
+
+  auto plane = [&](std::uint8_t p) { return out.bits.data() + p * words; };
+
+  auto ea = start;
+  while (ea < end) {
+    auto f = get_flags(ea);
+
+    std::uint8_t kind;
+    ea_t next;
+
+    if (is_head(f) || is_tail(f)) {
+      // A range may start in the middle of an item
+      auto head = is_head(f) ? ea : get_item_head(ea);
+      auto hf = head == ea ? f : get_flags(head);
+
+      next = std::min(std::max(get_item_end(ea), ea + 1), end);
+
+      if (is_head(f)) {
+        idalib_set_bits(plane(IDALIB_FLAGS_HEAD), ea - start, ea - start + 1);
+        idalib_set_bits(plane(IDALIB_FLAGS_TAIL), ea - start + 1,
+                        next - start);
+      } else {
+        idalib_set_bits(plane(IDALIB_FLAGS_TAIL), ea - start, next - start);
+      }
+
+      if (is_code(hf)) {
+        kind = IDALIB_SPAN_CODE;
+        idalib_set_bits(plane(IDALIB_FLAGS_CODE), ea - start, next - start);
+      } else if (is_data(hf)) {
+        kind = IDALIB_SPAN_DATA;
+        idalib_set_bits(plane(IDALIB_FLAGS_DATA), ea - start, next - start);
+      } else {
+        kind = IDALIB_SPAN_OTHER;
+      }
+    } else {
+      next = next_head(ea, end);
+      if (next == BADADDR || next > end) {
+        next = end;
+      }
+
+      kind = IDALIB_SPAN_UNKNOWN;
+      idalib_set_bits(plane(IDALIB_FLAGS_UNKNOWN), ea - start, next - start);
+    }
+
+    if (spans) {
+      out.span_starts.push_back(ea);
+      out.span_kinds.push_back(kind);
+    }
+
+    ea = next;
+  }
+}
@@ -3,14 +3,65 @@
 #include "pro.h"
 #include "funcs.hpp"
 #include "gdl.hpp"
+#include "idp.hpp"
 #include "name.hpp"
+#include "ua.hpp"
+#include "xref.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <exception>
+#include <stdexcept>
 #include <memory>
+#include <vector>
 
 #include "cxx.h"
 
+#include "insn_extras.h"
+
+#ifndef CXXBRIDGE1_STRUCT_func_cfg_t
+#define CXXBRIDGE1_STRUCT_func_cfg_t
+struct func_cfg_t final {
+  ::rust::Vec<::std::uint64_t> starts;
+  ::rust::Vec<::std::uint64_t> ends;
+  ::rust::Vec<::std::int32_t> kinds;
+  ::rust::Vec<::std::uint32_t> succ_offsets;
+  ::rust::Vec<::std::uint32_t> succs;
+  ::rust::Vec<::std::uint32_t> pred_offsets;
+  ::rust::Vec<::std::uint32_t> preds;
+  ::std::int32_t entry;
+  ::std::int32_t exit;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_func_cfg_t
+
+#ifndef CXXBRIDGE1_STRUCT_call_graph_t
+#define CXXBRIDGE1_STRUCT_call_graph_t
+struct call_graph_t final {
+  ::rust::Vec<::std::uint64_t> callers;
+  ::rust::Vec<::std::uint64_t> callees;
+  ::rust::Vec<::std::uint64_t> sites;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_call_graph_t
+
+#ifndef CXXBRIDGE1_STRUCT_func_features_t
+#define CXXBRIDGE1_STRUCT_func_features_t
+struct func_features_t final {
+  ::std::uint32_t dims;
+  ::std::uint32_t minhash_size;
+  ::rust::Vec<::std::uint64_t> starts;
+  ::rust::Vec<float> vectors;
+  ::rust::Vec<::std::uint64_t> minhash;
+  ::rust::Vec<::std::uint64_t> simhash;
+  ::rust::Vec<::std::uint32_t> tokens;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_func_features_t
+
 uint64_t idalib_func_flags(const func_t *f) {
   return f == nullptr ? 0 : f->flags;
 }
@@ -32,6 +83,309 @@ std::unique_ptr<qflow_chart_t> idalib_func_flow_chart(func_t *f, int fc_options)
   throw std::runtime_error("cannot build function flow chart");
 }
 
+// Build the flow chart of `f` and flatten it into `out`: block ranges and
+// types indexed by block id, with successors and predecessors in CSR form
+// (the edges of block `i` are `succs[succ_offsets[i]..succ_offsets[i + 1]]`).
+void idalib_func_flow_chart_flat(func_t *f, int fc_options, func_cfg_t &out) {
+  if (f == nullptr) {
+    throw std::runtime_error("cannot build flow chart of null function");
+  }
+
+  qflow_chart_t cfg(nullptr, f, BADADDR, BADADDR, fc_options);
+  auto n = std::size(cfg.blocks);
+
+  out.starts.clear();
+  out.ends.clear();
+  out.kinds.clear();
+  out.succ_offsets.clear();
+  out.succs.clear();
+  out.pred_offsets.clear();
+  out.preds.clear();
+
+  out.starts.reserve(n);
+  out.ends.reserve(n);
+  out.kinds.reserve(n);
+  out.succ_offsets.reserve(n + 1);
+  out.pred_offsets.reserve(n + 1);
+
+  out.succ_offsets.push_back(0);
+  out.pred_offsets.push_back(0);
+
+  for (size_t i = 0; i < n; i++) {
+    const auto &blk = cfg.blocks[i];
+
+    out.starts.push_back(blk.start_ea);
+    out.ends.push_back(blk.end_ea);
+    out.kinds.push_back(cfg.calc_block_type(i));
+
+    for (auto succ : blk.succ) {
+      out.succs.push_back(succ);
+    }
+    out.succ_offsets.push_back(out.succs.size());
+
+    for (auto pred : blk.pred) {
+      out.preds.push_back(pred);
+    }
+    out.pred_offsets.push_back(out.preds.size());
+  }
+
+  out.entry = n == 0 ? -1 : cfg.entry();
+  out.exit = n == 0 ? -1 : cfg.exit();
+}
+
+static void idalib_func_call_edges(func_t *f, call_graph_t &out) {
+  func_item_iterator_t fii;
+
+  for (bool ok = fii.set(f); ok; ok = fii.next_code()) {
+    auto ea = fii.current();
+
+    xrefblk_t xb;
+    for (bool x = xb.first_from(ea, XREF_FAR); x; x = xb.next_from()) {
+      if (!xb.iscode || (xb.type != fl_CF && xb.type != fl_CN)) {
+        continue;
+      }
+
+      // Calls into the middle of a function are attributed to its start;
+      // targets outside any function (e.g., imports) are kept as-is
+      auto callee = get_func(xb.to);
+
+      out.callers.push_back(f->start_ea);
+      out.callees.push_back(callee != nullptr ? callee->start_ea : xb.to);
+      out.sites.push_back(ea);
+    }
+  }
+}
+
+// Collect caller -> callee edges (one per call site) for the functions
+// starting at `starts`, or for every function if `starts` is empty.
+void idalib_func_call_graph(rust::Slice<const std::uint64_t> starts,
+                             call_graph_t &out) {
+  out.callers.clear();
+  out.callees.clear();
+  out.sites.clear();
+
+  if (starts.empty()) {
+    auto qty = get_func_qty();
+    for (size_t i = 0; i < qty; i++) {
+      if (auto f = getn_func(i); f != nullptr) {
+        idalib_func_call_edges(f, out);
+      }
+    }
+  } else {
+    for (auto start : starts) {
+      if (auto f = get_func(start); f != nullptr && f->start_ea == start) {
+        idalib_func_call_edges(f, out);
+      }
+    }
+  }
+}
+
+// Column indices of the fixed part of a feature vector; the mnemonic
+// histogram follows in the remaining `dims - IDALIB_FEAT_FIXED` columns.
+enum : uint32_t {
+  IDALIB_FEAT_INSNS,
+  IDALIB_FEAT_BYTES,
+  IDALIB_FEAT_BLOCKS,
+  IDALIB_FEAT_EDGES,
+  IDALIB_FEAT_EXITS,
+  IDALIB_FEAT_CALLS,
+  IDALIB_FEAT_CALLERS,
+  IDALIB_FEAT_CONSTANTS,
+  IDALIB_FEAT_MEMREFS,
+  IDALIB_FEAT_CHUNKS,
+  IDALIB_FEAT_FIXED,
+};
+
+// SplitMix64 finaliser; used to hash feature tokens and to derive the
+// MinHash permutations.
+static inline uint64_t idalib_mix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+static uint64_t idalib_mnemonic_shingle(const std::vector<uint16_t> &window) {
+  uint64_t h = 0;
+  for (auto itype : window) {
+    h = idalib_mix64(h ^ itype);
+  }
+  return h;
+}
+
+// Append the feature vector and sketches of `f` to `out`. Sketch tokens are
+// mnemonic shingles (`shingle` consecutive itypes) and immediate constants;
+// their number is recorded, as a function without any has a meaningless
+// MinHash signature (every value is UINT64_MAX).
+static void idalib_func_features_of(func_t *f, uint32_t buckets,
+                                    uint32_t shingle,
+                                    const std::vector<uint64_t> &seeds,
+                                    insn_batch_t &batch,
+                                    std::vector<uint64_t> &tokens,
+                                    std::vector<uint16_t> &window,
+                                    func_features_t &out) {
+  constexpr uint64_t const_tag = 0x636f6e7374616e74ULL;
+
+  auto base = std::size(out.vectors);
+  for (uint32_t i = 0; i < out.dims; i++) {
+    out.vectors.push_back(0.0f);
+  }
+  auto *row = out.vectors.data() + base;
+
+  idalib_insn_batch_clear(batch);
+  tokens.clear();
+  window.clear();
+
+  // Calls are the one property not kept in the batch
+  auto insns = idalib_visit_func_insns(f, [&](const insn_t &insn) {
+    idalib_insn_batch_push(batch, insn);
+    if (is_call_insn(insn)) {
+      row[IDALIB_FEAT_CALLS] += 1.0f;
+    }
+  });
+
+  for (size_t i = 0; i < insns; i++) {
+    auto itype = batch.itypes[i];
+
+    row[IDALIB_FEAT_INSNS] += 1.0f;
+    row[IDALIB_FEAT_BYTES] += batch.sizes[i];
+
+    if (buckets != 0) {
+      row[IDALIB_FEAT_FIXED + idalib_mix64(itype) % buckets] += 1.0f;
+    }
+
+    for (auto op = batch.op_offsets[i]; op < batch.op_offsets[i + 1]; op++) {
+      auto type = batch.op_types[op];
+
+      if (type == o_imm) {
+        row[IDALIB_FEAT_CONSTANTS] += 1.0f;
+        tokens.push_back(idalib_mix64(batch.op_values[op] ^ const_tag));
+      } else if (type == o_mem || type == o_phrase || type == o_displ) {
+        row[IDALIB_FEAT_MEMREFS] += 1.0f;
+      }
+    }
+
+    window.push_back(itype);
+    if (std::size(window) > shingle) {
+      window.erase(std::begin(window));
+    }
+    if (std::size(window) == shingle) {
+      tokens.push_back(idalib_mnemonic_shingle(window));
+    }
+  }
+
+  // Functions shorter than one shingle still get a token
+  if (!window.empty() && std::size(window) < shingle) {
+    tokens.push_back(idalib_mnemonic_shingle(window));
+  }
+
+  qflow_chart_t cfg(nullptr, f, BADADDR, BADADDR, FC_NOEXT);
+  auto n = std::size(cfg.blocks);
+
+  row[IDALIB_FEAT_BLOCKS] = static_cast<float>(n);
+  for (size_t i = 0; i < n; i++) {
+    row[IDALIB_FEAT_EDGES] += std::size(cfg.blocks[i].succ);
+
+    auto kind = cfg.calc_block_type(i);
+    if (kind == fcb_ret || kind == fcb_cndret) {
+      row[IDALIB_FEAT_EXITS] += 1.0f;
+    }
+  }
+
+  xrefblk_t xb;
+  for (bool x = xb.first_to(f->start_ea, XREF_FAR); x; x = xb.next_to()) {
+    if (xb.iscode && (xb.type == fl_CF || xb.type == fl_CN)) {
+      row[IDALIB_FEAT_CALLERS] += 1.0f;
+    }
+  }
+
+  row[IDALIB_FEAT_CHUNKS] = static_cast<float>(f->tailqty + 1);
+
+  int32_t weights[64] = {};
+  for (auto token : tokens) {
+    for (int bit = 0; bit < 64; bit++) {
+      weights[bit] += (token >> bit) & 1 ? 1 : -1;
+    }
+  }
+
+  uint64_t simhash = 0;
+  for (int bit = 0; bit < 64; bit++) {
+    if (weights[bit] > 0) {
+      simhash |= uint64_t(1) << bit;
+    }
+  }
+  out.simhash.push_back(simhash);
+
+  std::sort(std::begin(tokens), std::end(tokens));
+  tokens.erase(std::unique(std::begin(tokens), std::end(tokens)),
+               std::end(tokens));
+
+  for (auto seed : seeds) {
+    auto lowest = UINT64_MAX;
+    for (auto token : tokens) {
+      lowest = std::min(lowest, idalib_mix64(token ^ seed));
+    }
+    out.minhash.push_back(lowest);
+  }
+  out.tokens.push_back(static_cast<uint32_t>(std::size(tokens)));
+
+  out.starts.push_back(f->start_ea);
+}
+
+// Compute feature vectors and MinHash/SimHash sketches for the functions
+// starting at `starts`, or for every function if `starts` is empty. Vectors
+// are stored row-major (`dims` floats per function) and the MinHash
+// signatures `minhash_size` values per function, in the order of `starts`;
+// `tokens` is the number of distinct sketch tokens of each function.
+void idalib_func_features(rust::Slice<const std::uint64_t> starts,
+                          uint32_t buckets, uint32_t minhash_size,
+                          uint32_t shingle, func_features_t &out) {
+  out.starts.clear();
+  out.vectors.clear();
+  out.minhash.clear();
+  out.simhash.clear();
+  out.tokens.clear();
+
+  out.dims = IDALIB_FEAT_FIXED + buckets;
+  out.minhash_size = minhash_size;
+
+  shingle = std::max<uint32_t>(shingle, 1);
+
+  std::vector<uint64_t> seeds;
+  seeds.reserve(minhash_size);
+  for (uint32_t i = 0; i < minhash_size; i++) {
+    seeds.push_back(idalib_mix64(0x6d696e68617368ULL + i));
+  }
+
+  insn_batch_t batch;
+  std::vector<uint64_t> tokens;
+  std::vector<uint16_t> window;
+
+  auto count = starts.empty() ? get_func_qty() : std::size(starts);
+
+  out.starts.reserve(count);
+  out.vectors.reserve(count * out.dims);
+  out.minhash.reserve(count * minhash_size);
+  out.simhash.reserve(count);
+  out.tokens.reserve(count);
+
+  if (starts.empty()) {
+    for (size_t i = 0; i < count; i++) {
+      if (auto f = getn_func(i); f != nullptr) {
+        idalib_func_features_of(f, buckets, shingle, seeds, batch, tokens,
+                                window, out);
+      }
+    }
+  } else {
+    for (auto start : starts) {
+      if (auto f = get_func(start); f != nullptr && f->start_ea == start) {
+        idalib_func_features_of(f, buckets, shingle, seeds, batch, tokens,
+                                window, out);
+      }
+    }
+  }
+}
+
 const qbasic_block_t *idalib_qflow_graph_getn_block(const qflow_chart_t *cfg, size_t n) {
   return n < std::size(cfg->blocks) ? &cfg->blocks[n] : nullptr;
 }
@@ -4,9 +4,12 @@
 #include "lines.hpp"
 #include "pro.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "cxx.h"
 
@@ -21,6 +24,92 @@ struct hexrays_error_t final {
 };
 #endif // CXXBRIDGE1_STRUCT_hexrays_error_t
 
+#ifndef CXXBRIDGE1_STRUCT_pseudocode_span_t
+#define CXXBRIDGE1_STRUCT_pseudocode_span_t
+struct pseudocode_span_t final {
+  ::std::uint32_t start;
+  ::std::uint32_t end;
+  ::std::uint8_t color;
+  ::std::uint64_t addr;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_pseudocode_span_t
+
+#ifndef CXXBRIDGE1_STRUCT_ctree_node_t
+#define CXXBRIDGE1_STRUCT_ctree_node_t
+struct ctree_node_t final {
+  ::std::uint16_t op;
+  bool is_expr;
+  ::std::int32_t parent;
+  ::std::uint32_t subtree_end;
+  ::std::uint64_t ea;
+  bool has_value;
+  ::std::uint64_t value;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_ctree_node_t
+
+#ifndef CXXBRIDGE1_STRUCT_ctree_export_t
+#define CXXBRIDGE1_STRUCT_ctree_export_t
+struct ctree_export_t final {
+  ::rust::Vec<::ctree_node_t> nodes;
+  ::rust::Vec<::std::uint32_t> child_offsets;
+  ::rust::Vec<::std::uint32_t> children;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_ctree_export_t
+
+#ifndef CXXBRIDGE1_STRUCT_minsn_node_t
+#define CXXBRIDGE1_STRUCT_minsn_node_t
+struct minsn_node_t final {
+  ::std::uint16_t opcode;
+  ::std::uint64_t ea;
+  ::std::uint32_t block;
+  ::std::int32_t parent;
+  ::std::int32_t l;
+  ::std::int32_t r;
+  ::std::int32_t d;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_minsn_node_t
+
+#ifndef CXXBRIDGE1_STRUCT_mop_node_t
+#define CXXBRIDGE1_STRUCT_mop_node_t
+struct mop_node_t final {
+  ::std::uint8_t kind;
+  ::std::int32_t size;
+  ::std::uint64_t value;
+  ::std::uint32_t insn;
+  ::std::int32_t parent;
+  ::std::int32_t sub_insn;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_mop_node_t
+
+#ifndef CXXBRIDGE1_STRUCT_microcode_export_t
+#define CXXBRIDGE1_STRUCT_microcode_export_t
+struct microcode_export_t final {
+  ::std::int32_t maturity;
+  ::rust::Vec<::std::uint64_t> block_starts;
+  ::rust::Vec<::std::uint64_t> block_ends;
+  ::rust::Vec<::std::int32_t> block_types;
+  ::rust::Vec<::std::uint32_t> insn_offsets;
+  ::rust::Vec<::std::uint32_t> succ_offsets;
+  ::rust::Vec<::std::uint32_t> succs;
+  ::rust::Vec<::std::uint32_t> pred_offsets;
+  ::rust::Vec<::std::uint32_t> preds;
+  ::rust::Vec<::minsn_node_t> insns;
+  ::rust::Vec<::mop_node_t> operands;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_microcode_export_t
+
 struct cblock_iter {
   qlist<cinsn_t>::iterator start;
   qlist<cinsn_t>::iterator end;
@@ -46,6 +135,12 @@ idalib_hexrays_decompile_func(func_t *f, hexrays_error_t *err, int flags) {
   return nullptr;
 }
 
+bool idalib_hexrays_has_cached_cfunc(ea_t ea) { return has_cached_cfunc(ea); }
+
+bool idalib_hexrays_mark_cfunc_dirty(ea_t ea, bool close_views) {
+  return mark_cfunc_dirty(ea, close_views);
+}
+
 rust::String idalib_hexrays_cfunc_pseudocode(cfunc_t *f) {
   auto sv = f->get_pseudocode();
   auto sb = std::stringstream();
@@ -60,6 +155,421 @@ rust::String idalib_hexrays_cfunc_pseudocode(cfunc_t *f) {
   return rust::String(sb.str());
 }
 
+// Upper bound on the size of the rendered pseudocode of `f` (tags stripped,
+// one '\n' per line)
+std::size_t idalib_hexrays_cfunc_pseudocode_size(cfunc_t *f) {
+  const auto &sv = f->get_pseudocode();
+  auto size = std::size_t(0);
+
+  for (int i = 0; i < sv.size(); i++) {
+    size += sv[i].line.length() + 1;
+  }
+
+  return size;
+}
+
+// Render the pseudocode of `f` into `out` with color tags stripped in place,
+// returning the number of bytes written. If `with_lines` is set, the offset
+// just past each line's '\n' is appended to `line_ends`; if `with_spans` is
+// set, each colored region is appended to `spans` (with offsets into `out`)
+// and each address anchor as an empty span with color COLOR_ADDR.
+std::size_t idalib_hexrays_cfunc_render(cfunc_t *f, rust::Slice<rust::u8> out,
+                                        bool with_lines,
+                                        rust::Vec<std::uint32_t> &line_ends,
+                                        bool with_spans,
+                                        rust::Vec<pseudocode_span_t> &spans) {
+  const auto &sv = f->get_pseudocode();
+
+  auto *dst = out.data();
+  auto *lim = out.data() + out.size();
+
+  auto open = std::vector<pseudocode_span_t>();
+
+  for (int i = 0; i < sv.size(); i++) {
+    const char *p = sv[i].line.c_str();
+
+    while (*p != '\0' && dst < lim) {
+      switch (*p) {
+      case COLOR_ON:
+        if (p[1] == '\0') {
+          p++;
+          break;
+        }
+
+        if (p[1] == COLOR_ADDR) {
+          auto pos = std::uint32_t(dst - out.data());
+          auto addr = std::uint64_t(0);
+
+          p += 2;
+          for (int n = 0; n < COLOR_ADDR_SIZE && *p != '\0'; n++, p++) {
+            auto c = *p;
+            addr = (addr << 4) | (c >= 'a'   ? c - 'a' + 10
+                                  : c >= 'A' ? c - 'A' + 10
+                                             : c - '0');
+          }
+
+          if (with_spans) {
+            spans.push_back(pseudocode_span_t{pos, pos, COLOR_ADDR, addr});
+          }
+        } else {
+          if (with_spans) {
+            auto pos = std::uint32_t(dst - out.data());
+            open.push_back(pseudocode_span_t{pos, pos, uchar(p[1]), BADADDR});
+          }
+          p += 2;
+        }
+        break;
+      case COLOR_OFF:
+        if (p[1] == '\0') {
+          p++;
+          break;
+        }
+
+        if (with_spans) {
+          // Tags nest; close the innermost open span of this color
+          for (auto it = open.rbegin(); it != open.rend(); ++it) {
+            if (it->color == uchar(p[1])) {
+              it->end = std::uint32_t(dst - out.data());
+              spans.push_back(*it);
+              open.erase(std::next(it).base());
+              break;
+            }
+          }
+        }
+        p += 2;
+        break;
+      case COLOR_ESC:
+        if (p[1] != '\0') {
+          p++;
+          *dst++ = *p++;
+        } else {
+          p++;
+        }
+        break;
+      case COLOR_INV:
+        p++;
+        break;
+      default:
+        *dst++ = *p++;
+        break;
+      }
+    }
+
+    // Unterminated spans end with their line
+    for (auto &span : open) {
+      span.end = std::uint32_t(dst - out.data());
+      spans.push_back(span);
+    }
+    open.clear();
+
+    if (dst < lim) {
+      *dst++ = '\n';
+    }
+
+    if (with_lines) {
+      line_ends.push_back(std::uint32_t(dst - out.data()));
+    }
+  }
+
+  return dst - out.data();
+}
+
+struct idalib_ctree_exporter_t : public ctree_visitor_t {
+  std::vector<ctree_node_t> nodes;
+  std::unordered_map<const citem_t *, std::int32_t> index;
+
+  idalib_ctree_exporter_t() : ctree_visitor_t(CV_PARENTS) {}
+
+  std::int32_t parent_index() const {
+    if (parents.empty()) {
+      return -1;
+    }
+
+    auto it = index.find(parents.back());
+    return it != index.end() ? it->second : -1;
+  }
+
+  void add(const citem_t *item, bool has_value, std::uint64_t value) {
+    index.emplace(item, std::int32_t(nodes.size()));
+    nodes.push_back(ctree_node_t{std::uint16_t(item->op), item->is_expr(),
+                                 parent_index(), 0, item->ea, has_value,
+                                 value});
+  }
+
+  int idaapi visit_insn(cinsn_t *i) override {
+    add(i, false, 0);
+    return 0;
+  }
+
+  int idaapi visit_expr(cexpr_t *e) override {
+    auto value = std::uint64_t(0);
+    auto has_value = true;
+
+    switch (e->op) {
+    case cot_obj:
+      value = e->obj_ea;
+      break;
+    case cot_num:
+      value = e->numval();
+      break;
+    case cot_var:
+      value = e->v.idx;
+      break;
+    case cot_memref:
+    case cot_memptr:
+      value = e->m;
+      break;
+    default:
+      has_value = false;
+      break;
+    }
+
+    add(e, has_value, value);
+    return 0;
+  }
+};
+
+// Flatten the ctree of `f` into `out`: nodes in pre-order (so the subtree of
+// node `i` is `i..subtree_end`), each with its operator, address, parent
+// index and an operator-specific value (object address for cot_obj, value
+// for cot_num, variable index for cot_var, member offset for cot_memref and
+// cot_memptr), plus children in CSR form.
+void idalib_hexrays_cfunc_export_ctree(cfunc_t *f, ctree_export_t &out) {
+  idalib_ctree_exporter_t exporter;
+  exporter.apply_to(&f->body, nullptr);
+
+  auto &nodes = exporter.nodes;
+  auto n = nodes.size();
+
+  // Pre-order: a node's subtree ends where the next node outside it starts
+  for (size_t i = n; i-- > 0;) {
+    if (nodes[i].subtree_end == 0) {
+      nodes[i].subtree_end = std::uint32_t(i + 1);
+    }
+
+    if (auto parent = nodes[i].parent; parent >= 0) {
+      auto &p = nodes[parent];
+      p.subtree_end = std::max(p.subtree_end, nodes[i].subtree_end);
+    }
+  }
+
+  out.nodes.clear();
+  out.child_offsets.clear();
+  out.children.clear();
+
+  out.nodes.reserve(n);
+  out.child_offsets.reserve(n + 1);
+  out.children.reserve(n == 0 ? 0 : n - 1);
+
+  auto counts = std::vector<std::uint32_t>(n + 1, 0);
+  for (const auto &node : nodes) {
+    if (node.parent >= 0) {
+      counts[node.parent + 1]++;
+    }
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    counts[i + 1] += counts[i];
+  }
+
+  auto children = std::vector<std::uint32_t>(counts[n]);
+  auto fill = std::vector<std::uint32_t>(counts.begin(), counts.end() - 1);
+
+  for (size_t i = 0; i < n; i++) {
+    if (auto parent = nodes[i].parent; parent >= 0) {
+      children[fill[parent]++] = std::uint32_t(i);
+    }
+  }
+
+  for (const auto &node : nodes) {
+    out.nodes.push_back(node);
+  }
+
+  for (auto offset : counts) {
+    out.child_offsets.push_back(offset);
+  }
+
+  for (auto child : children) {
+    out.children.push_back(child);
+  }
+}
+
+struct idalib_microcode_exporter_t {
+  microcode_export_t &out;
+  std::uint32_t block = 0;
+
+  std::int32_t add_insn(const minsn_t *ins, std::int32_t parent) {
+    auto index = std::int32_t(out.insns.size());
+    out.insns.push_back(minsn_node_t{std::uint16_t(ins->opcode), ins->ea, block,
+                                     parent, -1, -1, -1});
+
+    auto l = add_mop(ins->l, index, -1);
+    auto r = add_mop(ins->r, index, -1);
+    auto d = add_mop(ins->d, index, -1);
+
+    auto &node = out.insns[index];
+    node.l = l;
+    node.r = r;
+    node.d = d;
+
+    return index;
+  }
+
+  std::int32_t add_mop(const mop_t &op, std::int32_t insn,
+                       std::int32_t parent) {
+    if (op.t == mop_z) {
+      return -1;
+    }
+
+    auto value = std::uint64_t(0);
+    switch (op.t) {
+    case mop_r:
+      value = op.r;
+      break;
+    case mop_n:
+      value = op.nnn->value;
+      break;
+    case mop_v:
+      value = op.g;
+      break;
+    case mop_S:
+      value = op.s->off;
+      break;
+    case mop_l:
+      value = op.l->idx;
+      break;
+    case mop_b:
+      value = op.b;
+      break;
+    case mop_f:
+      value = op.f->callee;
+      break;
+    default:
+      break;
+    }
+
+    auto index = std::int32_t(out.operands.size());
+    out.operands.push_back(mop_node_t{op.t, op.size, value,
+                                      std::uint32_t(insn), parent, -1});
+
+    switch (op.t) {
+    case mop_d: {
+      auto sub = add_insn(op.d, insn);
+      out.operands[index].sub_insn = sub;
+      break;
+    }
+    case mop_a:
+      add_mop(*op.a, insn, index);
+      break;
+    case mop_f:
+      for (const auto &arg : op.f->args) {
+        add_mop(arg, insn, index);
+      }
+      break;
+    case mop_p:
+      add_mop(op.pair->lop, insn, index);
+      add_mop(op.pair->hop, insn, index);
+      break;
+    default:
+      break;
+    }
+
+    return index;
+  }
+};
+
+// Generate microcode for `f` up to `maturity` (an `mba_maturity_t`), without
+// building a ctree, and flatten it into `out`:
+//
+// - blocks, with their address ranges and types, successors and
+//   predecessors in CSR form, and the range of instructions they hold;
+// - instructions in pre-order: each top-level instruction is followed by the
+//   instructions nested in its operands (`mop_d`), which record the
+//   instruction they belong to as `parent`;
+// - operands, each referencing its instruction; operands nested in another
+//   (`mop_a`, call arguments of `mop_f`, halves of `mop_p`) reference it as
+//   `parent`, and `mop_d` operands reference their instruction as
+//   `sub_insn`. `value` is operand-specific: the register for `mop_r`, the
+//   constant for `mop_n`, the address for `mop_v`, the stack offset for
+//   `mop_S`, the local variable index for `mop_l`, the block for `mop_b` and
+//   the callee for `mop_f`.
+bool idalib_hexrays_gen_microcode(func_t *f, int maturity, int flags,
+                                  microcode_export_t &out,
+                                  hexrays_error_t *err) {
+  out.block_starts.clear();
+  out.block_ends.clear();
+  out.block_types.clear();
+  out.insn_offsets.clear();
+  out.succ_offsets.clear();
+  out.succs.clear();
+  out.pred_offsets.clear();
+  out.preds.clear();
+  out.insns.clear();
+  out.operands.clear();
+
+  hexrays_failure_t failure;
+  mba_ranges_t ranges(f);
+
+  auto mba = std::unique_ptr<mba_t>(gen_microcode(
+      ranges, &failure, nullptr, flags, mba_maturity_t(maturity)));
+
+  if (mba == nullptr || failure.code < 0) {
+    err->code = failure.code;
+    err->desc = rust::String(failure.desc().c_str());
+    err->addr = failure.errea;
+    return false;
+  }
+
+  out.maturity = mba->maturity;
+
+  auto n = std::size_t(mba->qty);
+
+  out.block_starts.reserve(n);
+  out.block_ends.reserve(n);
+  out.block_types.reserve(n);
+  out.insn_offsets.reserve(n + 1);
+  out.succ_offsets.reserve(n + 1);
+  out.pred_offsets.reserve(n + 1);
+
+  idalib_microcode_exporter_t exporter{out};
+
+  out.succ_offsets.push_back(0);
+  out.pred_offsets.push_back(0);
+
+  for (int i = 0; i < mba->qty; i++) {
+    auto b = mba->get_mblock(i);
+
+    out.block_starts.push_back(b->start);
+    out.block_ends.push_back(b->end);
+    out.block_types.push_back(b->type);
+    out.insn_offsets.push_back(std::uint32_t(out.insns.size()));
+
+    exporter.block = std::uint32_t(i);
+    for (auto ins = b->head; ins != nullptr; ins = ins->next) {
+      exporter.add_insn(ins, -1);
+    }
+
+    for (auto succ : b->succset) {
+      out.succs.push_back(std::uint32_t(succ));
+    }
+    out.succ_offsets.push_back(std::uint32_t(out.succs.size()));
+
+    for (auto pred : b->predset) {
+      out.preds.push_back(std::uint32_t(pred));
+    }
+    out.pred_offsets.push_back(std::uint32_t(out.preds.size()));
+  }
+
+  out.insn_offsets.push_back(std::uint32_t(out.insns.size()));
+
+  return true;
+}
+
+rust::String idalib_hexrays_ctype_name(std::uint16_t op) {
+  auto name = get_ctype_name(ctype_t(op));
+  return rust::String(name != nullptr ? name : "");
+}
+
 std::unique_ptr<cblock_iter> idalib_hexrays_cblock_iter(cblock_t *b) {
   return std::unique_ptr<cblock_iter>(new cblock_iter(b));
 }
@@ -1,12 +1,197 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 
 #include "pro.h"
 #include "ida.hpp"
+#include "nalt.hpp"
 
 #include "cxx.h"
 
+#include "nalt_extras.h"
+
+#ifndef CXXBRIDGE1_STRUCT_inf_snapshot_t
+#define CXXBRIDGE1_STRUCT_inf_snapshot_t
+struct inf_snapshot_t final {
+  ::std::uint16_t version;
+  ::std::uint16_t genflags;
+  bool is_auto_enabled;
+  bool use_allasm;
+  bool loading_idc;
+  bool no_store_user_info;
+  bool readonly_idb;
+  bool check_manual_ops;
+  bool allow_non_matched_ops;
+  bool is_graph_view;
+  ::std::uint32_t lflags;
+  bool decode_fpp;
+  bool is_32bit_or_higher;
+  bool is_32bit_exactly;
+  bool is_16bit;
+  bool is_64bit;
+  bool is_dll;
+  bool is_flat_off32;
+  bool is_be;
+  bool is_wide_high_byte_first;
+  bool dbg_no_store_path;
+  bool is_snapshot;
+  bool pack_idb;
+  bool compress_idb;
+  bool is_kernel_mode;
+  ::std::uint32_t app_bitness;
+  ::std::uint32_t database_change_count;
+  ::std::uint32_t filetype;
+  ::std::uint16_t ostype;
+  ::std::uint16_t apptype;
+  ::std::uint8_t asmtype;
+  ::std::uint8_t specsegs;
+  ::std::uint32_t af;
+  bool trace_flow;
+  bool mark_code;
+  bool create_jump_tables;
+  bool noflow_to_data;
+  bool create_all_xrefs;
+  bool create_func_from_ptr;
+  bool create_func_from_call;
+  bool create_func_tails;
+  bool should_create_stkvars;
+  bool propagate_stkargs;
+  bool propagate_regargs;
+  bool should_trace_sp;
+  bool full_sp_ana;
+  bool noret_ana;
+  bool guess_func_type;
+  bool truncate_on_del;
+  bool create_strlit_on_xref;
+  bool check_unicode_strlits;
+  bool create_off_using_fixup;
+  bool create_off_on_dref;
+  bool op_offset;
+  bool data_offset;
+  bool use_flirt;
+  bool append_sigcmt;
+  bool allow_sigmulti;
+  bool hide_libfuncs;
+  bool rename_jumpfunc;
+  bool rename_nullsub;
+  bool coagulate_data;
+  bool coagulate_code;
+  bool final_pass;
+  ::std::uint32_t af2;
+  bool handle_eh;
+  bool handle_rtti;
+  bool macros_enabled;
+  bool merge_strlits;
+  ::std::uint64_t base_address;
+  ::std::uint64_t start_stack_segment;
+  ::std::uint64_t start_code_segment;
+  ::std::uint64_t start_instruction_pointer;
+  ::std::uint64_t start_address;
+  ::std::uint64_t start_stack_pointer;
+  ::std::uint64_t main_address;
+  ::std::uint64_t min_address;
+  ::std::uint64_t max_address;
+  ::std::uint64_t omin_address;
+  ::std::uint64_t omax_ea;
+  ::std::uint64_t lowoff;
+  ::std::uint64_t highoff;
+  ::std::uint64_t maxref;
+  ::std::int64_t netdelta;
+  ::std::uint8_t xrefnum;
+  ::std::uint8_t type_xrefnum;
+  ::std::uint8_t refcmtnum;
+  ::std::uint8_t xrefflag;
+  bool show_xref_seg;
+  bool show_xref_tmarks;
+  bool show_xref_fncoff;
+  bool show_xref_val;
+  ::std::uint16_t max_autoname_len;
+  ::std::int8_t nametype;
+  ::std::uint32_t short_demnames;
+  ::std::uint32_t long_demnames;
+  ::std::uint8_t demnames;
+  ::std::uint8_t listnames;
+  ::std::uint8_t indent;
+  ::std::uint8_t cmt_indent;
+  ::std::uint16_t margin;
+  ::std::uint16_t lenxref;
+  ::std::uint32_t outflags;
+  bool show_void;
+  bool show_auto;
+  bool gen_null;
+  bool show_line_pref;
+  bool line_pref_with_seg;
+  bool gen_lzero;
+  bool gen_org;
+  bool gen_assume;
+  bool gen_tryblks;
+  ::std::uint8_t cmtflg;
+  bool show_repeatables;
+  bool show_all_comments;
+  bool hide_comments;
+  bool show_src_linnum;
+  bool test_mode;
+  bool show_hidden_insns;
+  bool show_hidden_funcs;
+  bool show_hidden_segms;
+  ::std::uint8_t limiter;
+  bool is_limiter_thin;
+  bool is_limiter_thick;
+  bool is_limiter_empty;
+  ::std::int16_t bin_prefix_size;
+  ::std::uint8_t prefflag;
+  bool prefix_show_segaddr;
+  bool prefix_show_funcoff;
+  bool prefix_show_stack;
+  bool prefix_truncate_opcode_bytes;
+  ::std::uint8_t strlit_flags;
+  bool strlit_names;
+  bool strlit_name_bit;
+  bool strlit_serial_names;
+  bool unicode_strlits;
+  bool strlit_autocmt;
+  bool strlit_savecase;
+  ::std::uint8_t strlit_break;
+  ::std::int8_t strlit_zeroes;
+  ::std::int32_t strtype;
+  ::std::uint64_t strlit_sernum;
+  ::std::uint64_t datatypes;
+  ::std::uint32_t abibits;
+  bool is_mem_aligned4;
+  bool pack_stkargs;
+  bool big_arg_align;
+  bool stack_ldbl;
+  bool stack_varargs;
+  bool is_hard_float;
+  bool abi_set_by_user;
+  bool use_gcc_layout;
+  bool map_stkargs;
+  bool huge_arg_align;
+  ::std::uint32_t appcall_options;
+  ::std::uint64_t privrange_start_address;
+  ::std::uint64_t privrange_end_address;
+  ::std::uint8_t cc_id;
+  ::std::uint8_t cc_cm;
+  ::std::uint8_t cc_size_i;
+  ::std::uint8_t cc_size_b;
+  ::std::uint8_t cc_size_e;
+  ::std::uint8_t cc_defalign;
+  ::std::uint8_t cc_size_s;
+  ::std::uint8_t cc_size_l;
+  ::std::uint8_t cc_size_ll;
+  ::std::uint8_t cc_size_ldbl;
+  ::rust::String procname;
+  ::rust::String strlit_pref;
+  ::std::array<::std::uint8_t, 16> input_file_md5;
+  ::std::array<::std::uint8_t, 32> input_file_sha256;
+  ::rust::String input_file_path;
+  ::std::size_t input_file_size;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_inf_snapshot_t
+
 std::uint16_t idalib_inf_get_version() { return inf_get_version(); }
 
 std::uint16_t idalib_inf_get_genflags() { return inf_get_genflags(); }
@@ -393,3 +578,183 @@ rust::String idalib_inf_get_strlit_pref() {
 bool idalib_inf_get_cc(compiler_info_t *out)  { return inf_get_cc(out); }
 
 bool idalib_inf_get_privrange(range_t *out)  { return inf_get_privrange(out); }
+
+// Copy everything exposed by the individual getters above into `out` in one
+// call. Each field is read back by the accessor of the same name generated by
+// `metadata_accessors!` (idalib/src/meta.rs), alongside the one calling the
+// getter directly.
+void idalib_inf_snapshot(inf_snapshot_t &out) {
+  out.version = idalib_inf_get_version();
+  out.genflags = idalib_inf_get_genflags();
+  out.is_auto_enabled = idalib_inf_is_auto_enabled();
+  out.use_allasm = idalib_inf_use_allasm();
+  out.loading_idc = idalib_inf_loading_idc();
+  out.no_store_user_info = idalib_inf_no_store_user_info();
+  out.readonly_idb = idalib_inf_readonly_idb();
+  out.check_manual_ops = idalib_inf_check_manual_ops();
+  out.allow_non_matched_ops = idalib_inf_allow_non_matched_ops();
+  out.is_graph_view = idalib_inf_is_graph_view();
+  out.lflags = idalib_inf_get_lflags();
+  out.decode_fpp = idalib_inf_decode_fpp();
+  out.is_32bit_or_higher = idalib_inf_is_32bit_or_higher();
+  out.is_32bit_exactly = idalib_inf_is_32bit_exactly();
+  out.is_16bit = idalib_inf_is_16bit();
+  out.is_64bit = idalib_inf_is_64bit();
+  out.is_dll = idalib_inf_is_dll();
+  out.is_flat_off32 = idalib_inf_is_flat_off32();
+  out.is_be = idalib_inf_is_be();
+  out.is_wide_high_byte_first = idalib_inf_is_wide_high_byte_first();
+  out.dbg_no_store_path = idalib_inf_dbg_no_store_path();
+  out.is_snapshot = idalib_inf_is_snapshot();
+  out.pack_idb = idalib_inf_pack_idb();
+  out.compress_idb = idalib_inf_compress_idb();
+  out.is_kernel_mode = idalib_inf_is_kernel_mode();
+  out.app_bitness = idalib_inf_get_app_bitness();
+  out.database_change_count = idalib_inf_get_database_change_count();
+  out.filetype = static_cast<std::uint32_t>(idalib_inf_get_filetype());
+  out.ostype = idalib_inf_get_ostype();
+  out.apptype = idalib_inf_get_apptype();
+  out.asmtype = idalib_inf_get_asmtype();
+  out.specsegs = idalib_inf_get_specsegs();
+  out.af = idalib_inf_get_af();
+  out.trace_flow = idalib_inf_trace_flow();
+  out.mark_code = idalib_inf_mark_code();
+  out.create_jump_tables = idalib_inf_create_jump_tables();
+  out.noflow_to_data = idalib_inf_noflow_to_data();
+  out.create_all_xrefs = idalib_inf_create_all_xrefs();
+  out.create_func_from_ptr = idalib_inf_create_func_from_ptr();
+  out.create_func_from_call = idalib_inf_create_func_from_call();
+  out.create_func_tails = idalib_inf_create_func_tails();
+  out.should_create_stkvars = idalib_inf_should_create_stkvars();
+  out.propagate_stkargs = idalib_inf_propagate_stkargs();
+  out.propagate_regargs = idalib_inf_propagate_regargs();
+  out.should_trace_sp = idalib_inf_should_trace_sp();
+  out.full_sp_ana = idalib_inf_full_sp_ana();
+  out.noret_ana = idalib_inf_noret_ana();
+  out.guess_func_type = idalib_inf_guess_func_type();
+  out.truncate_on_del = idalib_inf_truncate_on_del();
+  out.create_strlit_on_xref = idalib_inf_create_strlit_on_xref();
+  out.check_unicode_strlits = idalib_inf_check_unicode_strlits();
+  out.create_off_using_fixup = idalib_inf_create_off_using_fixup();
+  out.create_off_on_dref = idalib_inf_create_off_on_dref();
+  out.op_offset = idalib_inf_op_offset();
+  out.data_offset = idalib_inf_data_offset();
+  out.use_flirt = idalib_inf_use_flirt();
+  out.append_sigcmt = idalib_inf_append_sigcmt();
+  out.allow_sigmulti = idalib_inf_allow_sigmulti();
+  out.hide_libfuncs = idalib_inf_hide_libfuncs();
+  out.rename_jumpfunc = idalib_inf_rename_jumpfunc();
+  out.rename_nullsub = idalib_inf_rename_nullsub();
+  out.coagulate_data = idalib_inf_coagulate_data();
+  out.coagulate_code = idalib_inf_coagulate_code();
+  out.final_pass = idalib_inf_final_pass();
+  out.af2 = idalib_inf_get_af2();
+  out.handle_eh = idalib_inf_handle_eh();
+  out.handle_rtti = idalib_inf_handle_rtti();
+  out.macros_enabled = idalib_inf_macros_enabled();
+  out.merge_strlits = idalib_inf_merge_strlits();
+  out.base_address = idalib_inf_get_baseaddr();
+  out.start_stack_segment = idalib_inf_get_start_ss();
+  out.start_code_segment = idalib_inf_get_start_cs();
+  out.start_instruction_pointer = idalib_inf_get_start_ip();
+  out.start_address = idalib_inf_get_start_ea();
+  out.start_stack_pointer = idalib_inf_get_start_sp();
+  out.main_address = idalib_inf_get_main();
+  out.min_address = idalib_inf_get_min_ea();
+  out.max_address = idalib_inf_get_max_ea();
+  out.omin_address = idalib_inf_get_omin_ea();
+  out.omax_ea = idalib_inf_get_omax_ea();
+  out.lowoff = idalib_inf_get_lowoff();
+  out.highoff = idalib_inf_get_highoff();
+  out.maxref = idalib_inf_get_maxref();
+  out.netdelta = idalib_inf_get_netdelta();
+  out.xrefnum = idalib_inf_get_xrefnum();
+  out.type_xrefnum = idalib_inf_get_type_xrefnum();
+  out.refcmtnum = idalib_inf_get_refcmtnum();
+  out.xrefflag = idalib_inf_get_xrefflag();
+  out.show_xref_seg = idalib_inf_show_xref_seg();
+  out.show_xref_tmarks = idalib_inf_show_xref_tmarks();
+  out.show_xref_fncoff = idalib_inf_show_xref_fncoff();
+  out.show_xref_val = idalib_inf_show_xref_val();
+  out.max_autoname_len = idalib_inf_get_max_autoname_len();
+  out.nametype = idalib_inf_get_nametype();
+  out.short_demnames = idalib_inf_get_short_demnames();
+  out.long_demnames = idalib_inf_get_long_demnames();
+  out.demnames = idalib_inf_get_demnames();
+  out.listnames = idalib_inf_get_listnames();
+  out.indent = idalib_inf_get_indent();
+  out.cmt_indent = idalib_inf_get_cmt_indent();
+  out.margin = idalib_inf_get_margin();
+  out.lenxref = idalib_inf_get_lenxref();
+  out.outflags = idalib_inf_get_outflags();
+  out.show_void = idalib_inf_show_void();
+  out.show_auto = idalib_inf_show_auto();
+  out.gen_null = idalib_inf_gen_null();
+  out.show_line_pref = idalib_inf_show_line_pref();
+  out.line_pref_with_seg = idalib_inf_line_pref_with_seg();
+  out.gen_lzero = idalib_inf_gen_lzero();
+  out.gen_org = idalib_inf_gen_org();
+  out.gen_assume = idalib_inf_gen_assume();
+  out.gen_tryblks = idalib_inf_gen_tryblks();
+  out.cmtflg = idalib_inf_get_cmtflg();
+  out.show_repeatables = idalib_inf_show_repeatables();
+  out.show_all_comments = idalib_inf_show_all_comments();
+  out.hide_comments = idalib_inf_hide_comments();
+  out.show_src_linnum = idalib_inf_show_src_linnum();
+  out.test_mode = idalib_inf_test_mode();
+  out.show_hidden_insns = idalib_inf_show_hidden_insns();
+  out.show_hidden_funcs = idalib_inf_show_hidden_funcs();
+  out.show_hidden_segms = idalib_inf_show_hidden_segms();
+  out.limiter = idalib_inf_get_limiter();
+  out.is_limiter_thin = idalib_inf_is_limiter_thin();
+  out.is_limiter_thick = idalib_inf_is_limiter_thick();
+  out.is_limiter_empty = idalib_inf_is_limiter_empty();
+  out.bin_prefix_size = idalib_inf_get_bin_prefix_size();
+  out.prefflag = idalib_inf_get_prefflag();
+  out.prefix_show_segaddr = idalib_inf_prefix_show_segaddr();
+  out.prefix_show_funcoff = idalib_inf_prefix_show_funcoff();
+  out.prefix_show_stack = idalib_inf_prefix_show_stack();
+  out.prefix_truncate_opcode_bytes = idalib_inf_prefix_truncate_opcode_bytes();
+  out.strlit_flags = idalib_inf_get_strlit_flags();
+  out.strlit_names = idalib_inf_strlit_names();
+  out.strlit_name_bit = idalib_inf_strlit_name_bit();
+  out.strlit_serial_names = idalib_inf_strlit_serial_names();
+  out.unicode_strlits = idalib_inf_unicode_strlits();
+  out.strlit_autocmt = idalib_inf_strlit_autocmt();
+  out.strlit_savecase = idalib_inf_strlit_savecase();
+  out.strlit_break = idalib_inf_get_strlit_break();
+  out.strlit_zeroes = idalib_inf_get_strlit_zeroes();
+  out.strtype = idalib_inf_get_strtype();
+  out.strlit_sernum = idalib_inf_get_strlit_sernum();
+  out.datatypes = idalib_inf_get_datatypes();
+  out.abibits = idalib_inf_get_abibits();
+  out.is_mem_aligned4 = idalib_inf_is_mem_aligned4();
+  out.pack_stkargs = idalib_inf_pack_stkargs();
+  out.big_arg_align = idalib_inf_big_arg_align();
+  out.stack_ldbl = idalib_inf_stack_ldbl();
+  out.stack_varargs = idalib_inf_stack_varargs();
+  out.is_hard_float = idalib_inf_is_hard_float();
+  out.abi_set_by_user = idalib_inf_abi_set_by_user();
+  out.use_gcc_layout = idalib_inf_use_gcc_layout();
+  out.map_stkargs = idalib_inf_map_stkargs();
+  out.huge_arg_align = idalib_inf_huge_arg_align();
+  out.appcall_options = idalib_inf_get_appcall_options();
+  out.privrange_start_address = idalib_inf_get_privrange_start_ea();
+  out.privrange_end_address = idalib_inf_get_privrange_end_ea();
+  out.cc_id = idalib_inf_get_cc_id() & COMP_MASK;
+  out.cc_cm = idalib_inf_get_cc_cm();
+  out.cc_size_i = idalib_inf_get_cc_size_i();
+  out.cc_size_b = idalib_inf_get_cc_size_b();
+  out.cc_size_e = idalib_inf_get_cc_size_e();
+  out.cc_defalign = idalib_inf_get_cc_defalign();
+  out.cc_size_s = idalib_inf_get_cc_size_s();
+  out.cc_size_l = idalib_inf_get_cc_size_l();
+  out.cc_size_ll = idalib_inf_get_cc_size_ll();
+  out.cc_size_ldbl = idalib_inf_get_cc_size_ldbl();
+  out.procname = idalib_inf_get_procname();
+  out.strlit_pref = idalib_inf_get_strlit_pref();
+  retrieve_input_file_md5(out.input_file_md5.data());
+  retrieve_input_file_sha256(out.input_file_sha256.data());
+  out.input_file_path = idalib_get_input_file_path();
+  out.input_file_size = retrieve_input_file_size();
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "bytes.hpp"
+#include "funcs.hpp"
+#include "ua.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "cxx.h"
+
+#ifndef CXXBRIDGE1_STRUCT_insn_batch_t
+#define CXXBRIDGE1_STRUCT_insn_batch_t
+struct insn_batch_t final {
+  ::rust::Vec<::std::uint64_t> eas;
+  ::rust::Vec<::std::uint16_t> sizes;
+  ::rust::Vec<::std::uint16_t> itypes;
+  ::rust::Vec<::std::uint32_t> flags;
+  ::rust::Vec<::std::uint32_t> op_offsets;
+  ::rust::Vec<::std::uint8_t> op_types;
+  ::rust::Vec<::std::uint8_t> op_dtypes;
+  ::rust::Vec<::std::uint8_t> op_flags;
+  ::rust::Vec<::std::uint16_t> op_regs;
+  ::rust::Vec<::std::uint64_t> op_values;
+  ::rust::Vec<::std::uint64_t> op_addrs;
+  ::rust::Vec<::std::uint64_t> op_specvals;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_insn_batch_t
+
+// Append `insn` to `out`; operands are stored in CSR form, so the operands
+// of instruction `i` are `op_*[op_offsets[i]..op_offsets[i + 1]]`.
+static void idalib_insn_batch_push(insn_batch_t &out, const insn_t &insn) {
+  if (out.op_offsets.empty()) {
+    out.op_offsets.push_back(0);
+  }
+
+  out.eas.push_back(insn.ea);
+  out.sizes.push_back(insn.size);
+  out.itypes.push_back(insn.itype);
+  out.flags.push_back(insn.flags);
+
+  for (const auto &op : insn.ops) {
+    if (op.type == o_void) {
+      break;
+    }
+
+    out.op_types.push_back(op.type);
+    out.op_dtypes.push_back(op.dtype);
+    out.op_flags.push_back(op.flags);
+    out.op_regs.push_back(op.reg);
+    out.op_values.push_back(op.value);
+    out.op_addrs.push_back(op.addr);
+    out.op_specvals.push_back(op.specval);
+  }
+
+  out.op_offsets.push_back(static_cast<uint32_t>(std::size(out.op_types)));
+}
+
+static void idalib_insn_batch_clear(insn_batch_t &out) {
+  out.eas.clear();
+  out.sizes.clear();
+  out.itypes.clear();
+  out.flags.clear();
+  out.op_offsets.clear();
+  out.op_types.clear();
+  out.op_dtypes.clear();
+  out.op_flags.clear();
+  out.op_regs.clear();
+  out.op_values.clear();
+  out.op_addrs.clear();
+  out.op_specvals.clear();
+}
+
+// Call `visit` with every instruction of `f`, including its tail chunks,
+// returning how many were visited.
+template <typename Visit>
+static size_t idalib_visit_func_insns(func_t *f, Visit &&visit) {
+  size_t count = 0;
+  insn_t insn;
+  func_item_iterator_t fii;
+
+  for (auto ok = fii.set(f); ok; ok = fii.next_code()) {
+    auto ea = fii.current();
+    if (is_code(get_flags(ea)) && decode_insn(&insn, ea) > 0) {
+      visit(insn);
+      count++;
+    }
+  }
+
+  return count;
+}
+
+// Decode the instructions in [start, end) into `out`, returning how many
+// were appended. By default only items marked as code are decoded; with
+// `linear` every address is tried in turn, continuing after each decoded
+// instruction or at the next address when decoding fails.
+size_t idalib_decode_range(ea_t start, ea_t end, bool linear,
+                           insn_batch_t &out) {
+  size_t count = 0;
+  insn_t insn;
+
+  if (linear) {
+    for (auto ea = start; ea != BADADDR && ea < end;) {
+      auto size = decode_insn(&insn, ea);
+      if (size > 0) {
+        idalib_insn_batch_push(out, insn);
+        count++;
+        ea += size;
+      } else {
+        ea = next_addr(ea);
+      }
+    }
+    return count;
+  }
+
+  auto ea = is_head(get_flags(start)) ? start : next_head(start, end);
+
+  for (; ea != BADADDR && ea < end; ea = next_head(ea, end)) {
+    if (is_code(get_flags(ea)) && decode_insn(&insn, ea) > 0) {
+      idalib_insn_batch_push(out, insn);
+      count++;
+    }
+  }
+
+  return count;
+}
+
+// Decode every instruction of `f`, including its tail chunks, into `out`.
+size_t idalib_decode_func(func_t *f, insn_batch_t &out) {
+  if (f == nullptr) {
+    throw std::runtime_error("cannot decode null function");
+  }
+
+  return idalib_visit_func_insns(
+      f, [&](const insn_t &insn) { idalib_insn_batch_push(out, insn); });
+}
@@ -1,13 +1,31 @@
 #pragma once
 
 #include "auto.hpp"
+#include "idp.hpp"
 #include "kernwin.hpp"
+#include "loader.hpp"
 #include "pro.h"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdint>
 
+#include "cxx.h"
+
+#include "auto_extras.h"
+
+#ifndef CXXBRIDGE1_STRUCT_open_profile_t
+#define CXXBRIDGE1_STRUCT_open_profile_t
+struct open_profile_t final {
+  ::std::uint64_t loader_nanos;
+  ::std::uint64_t init_database_nanos;
+  ::rust::Vec<::auto_stage_time_t> stages;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_open_profile_t
+
 struct license_manager_t;
 struct license_manager_t_vtbl;
 
@@ -102,53 +120,121 @@ struct config_t {
 extern "C" license_manager_t *get_license_manager();
 extern "C" config_t *get_current_config();
 
-bool idalib_check_license() {
+#ifndef CXXBRIDGE1_STRUCT_license_state_t
+#define CXXBRIDGE1_STRUCT_license_state_t
+struct license_state_t final {
+  bool valid;
+  bool borrowed;
+  ::std::int32_t borrow_result;
+  ::std::array<::std::uint8_t, 6> id;
+  ::rust::String error;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_license_state_t
+
+// Check the license, borrowing (or re-acquiring) one only if the check
+// fails; the license manager is asked at most once per step. `borrowed` is
+// set if a borrow was attempted, with its result in `borrow_result` (0 on
+// success) and any description of the failure in `error`.
+void idalib_query_license(license_state_t &out) {
+  out.valid = false;
+  out.borrowed = false;
+  out.borrow_result = 0;
+  out.id.fill(0);
+  out.error = rust::String();
+
   auto manager = get_license_manager();
   if (!manager) {
-    return false;
+    out.error = "no license manager";
+    return;
   }
 
   auto res = manager->_vtbl->check(manager, 0, 0);
-  if (res && res->is_ok) {
-    return true;
-  }
+  if (!res || !res->is_ok) {
+    config_t *config = get_current_config();
+    uint64_t flags = 16;
+    qstring estr;
 
-  config_t *config = get_current_config();
-  uint64_t flags = 16;
+    out.borrowed = true;
+    out.borrow_result = manager->_vtbl->get_or_borrow_license(
+        manager, &config->license_location, &config->license_info, flags,
+        &estr);
 
-  // NOTE: this will contain a description of any error; we should likely
-  // figure out how to expose it...
-  qstring estr;
+    if (!estr.empty()) {
+      out.error = rust::String(estr.c_str(), estr.length());
+    }
 
-  auto nres = manager->_vtbl->get_or_borrow_license(
-      manager, &config->license_location, &config->license_info, flags, &estr);
+    if (out.borrow_result != 0) {
+      return;
+    }
 
-  return !nres;
-}
-
-bool idalib_get_license_id(std::array<uint8_t, 6> &id) {
-  if (!idalib_check_license()) {
-    return false;
+    // The identifier is only known once the borrowed license is checked
+    res = manager->_vtbl->check(manager, 0, 0);
   }
 
-  auto manager = get_license_manager();
-  if (!manager) {
-    return false;
+  if (!res || !res->is_ok) {
+    if (out.error.empty()) {
+      out.error = "license check failed after borrowing";
+    }
+    return;
   }
 
-  auto res = manager->_vtbl->check(manager, 0, 0);
-  if (res && res->is_ok) {
-    std::copy(std::begin(res->lid), std::end(res->lid), std::begin(id));
-    return true;
-  }
+  out.valid = true;
+  std::copy(std::begin(res->lid), std::end(res->lid), std::begin(out.id));
+}
 
-  return false;
+struct idalib_open_timer_t {
+  std::chrono::steady_clock::time_point loaded;
+  bool seen;
+};
+
+static ssize_t idaapi idalib_open_timer_cb(void *user_data, int code,
+                                           va_list) {
+  if (code == idb_event::loader_finished) {
+    auto timer = static_cast<idalib_open_timer_t *>(user_data);
+    timer->loaded = std::chrono::steady_clock::now();
+    timer->seen = true;
+  }
+  return 0;
 }
 
-int idalib_open_database_quiet(int argc, const char *const *argv,
-                               bool auto_analysis) {
+// Open the database named by the command line `argv`, optionally running
+// auto-analysis to completion. If `profile` is given, also record where the
+// time goes: `loader` runs from the start of init_database until the loader
+// finishes (it is zero when opening an existing database), `init_database`
+// is the remainder of init_database, and auto-analysis is broken down by
+// queue.
+static int idalib_open_database_impl(int argc, const char *const *argv,
+                                     bool auto_analysis,
+                                     open_profile_t *profile) {
+  using clock = std::chrono::steady_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  idalib_open_timer_t timer{clock::time_point(), false};
+
+  if (profile != nullptr) {
+    profile->loader_nanos = 0;
+    profile->init_database_nanos = 0;
+    profile->stages.clear();
+
+    hook_to_notification_point(HT_IDB, idalib_open_timer_cb, &timer);
+  }
+
   auto new_file = 0;
+  auto start = clock::now();
   auto result = init_database(argc, argv, &new_file);
+  auto opened = clock::now();
+
+  if (profile != nullptr) {
+    unhook_from_notification_point(HT_IDB, idalib_open_timer_cb, &timer);
+
+    auto loaded = timer.seen ? timer.loaded : start;
+    profile->loader_nanos = duration_cast<nanoseconds>(loaded - start).count();
+    profile->init_database_nanos =
+        duration_cast<nanoseconds>(opened - loaded).count();
+  }
 
   if (result != 0) {
     return result;
@@ -157,12 +243,42 @@ int idalib_open_database_quiet(int argc, const char *const *argv,
   (*callui)(ui_notification_t::ui_ready_to_run);
 
   if (auto_analysis) {
-    result = !auto_wait();
+    result = profile != nullptr ? !idalib_auto_wait_profiled(profile->stages)
+                                : !auto_wait();
   }
 
   return result;
 }
 
+int idalib_open_database_quiet(int argc, const char *const *argv,
+                               bool auto_analysis) {
+  return idalib_open_database_impl(argc, argv, auto_analysis, nullptr);
+}
+
+int idalib_open_database_profiled(int argc, const char *const *argv,
+                                  bool auto_analysis, open_profile_t &profile) {
+  return idalib_open_database_impl(argc, argv, auto_analysis, &profile);
+}
+
+// Save the open database to its own path, packed (and compressed if
+// `compress` is set), so its file can be copied; the packing it is saved with
+// on close is unchanged.
+//
+// NOTE: save_database's DBFL_COMP only collects garbage; how the database is
+// packed follows its LFLG_PACK and LFLG_COMPRESS flags, so they are set for
+// the save and restored afterwards. Saving under another name is avoided, as
+// that is a Save-as and may retarget the working database to the new file.
+bool idalib_save_database_packed(bool compress) {
+  auto lflags = inf_get_lflags();
+  auto packing = LFLG_PACK | (compress ? LFLG_COMPRESS : 0);
+
+  inf_set_lflags((lflags & ~(LFLG_PACK | LFLG_COMPRESS)) | packing);
+  auto saved = save_database(nullptr, 0);
+  inf_set_lflags(lflags);
+
+  return saved;
+}
+
 rust::String idalib_ea2str(ea_t ea) {
   auto out = qstring();
 
@@ -540,9 +540,13 @@ pub mod hexrays {
         carg_t, carglist_t, cfuncptr_t, init_hexrays_plugin, term_hexrays_plugin,
     };
     pub use super::ffix::{
-        cblock_iter, idalib_hexrays_cblock_iter, idalib_hexrays_cblock_iter_next,
-        idalib_hexrays_cblock_len, idalib_hexrays_cfunc_pseudocode, idalib_hexrays_cfuncptr_inner,
-        idalib_hexrays_decompile_func,
+        cblock_iter, ctree_export_t, ctree_node_t, idalib_hexrays_cblock_iter,
+        idalib_hexrays_cblock_iter_next, idalib_hexrays_cblock_len,
+        idalib_hexrays_cfunc_export_ctree, idalib_hexrays_cfunc_pseudocode,
+        idalib_hexrays_cfunc_pseudocode_size, idalib_hexrays_cfunc_render,
+        idalib_hexrays_cfuncptr_inner, idalib_hexrays_ctype_name, idalib_hexrays_decompile_func,
+        idalib_hexrays_has_cached_cfunc, idalib_hexrays_mark_cfunc_dirty, microcode_export_t,
+        minsn_node_t, mop_node_t, pseudocode_span_t,
     };
 
     unsafe impl cxx::ExternType for cfunc_t {
@@ -589,7 +593,21 @@ pub mod hexrays {
         f: *mut super::ffi::func_t,
         all_blocks: bool,
     ) -> Result<cxx::UniquePtr<cfuncptr_t>, HexRaysError> {
-        let mut flags = __impl::DECOMP_NO_WAIT | __impl::DECOMP_NO_CACHE;
+        unsafe { decompile_func_with(f, all_blocks, false) }
+    }
+
+    /// Like `decompile_func`, but when `use_cache` is set Hex-Rays may return
+    /// its cached result for functions that have not been marked dirty.
+    pub unsafe fn decompile_func_with(
+        f: *mut super::ffi::func_t,
+        all_blocks: bool,
+        use_cache: bool,
+    ) -> Result<cxx::UniquePtr<cfuncptr_t>, HexRaysError> {
+        let mut flags = __impl::DECOMP_NO_WAIT;
+
+        if !use_cache {
+            flags |= __impl::DECOMP_NO_CACHE;
+        }
 
         if all_blocks {
             flags |= __impl::DECOMP_ALL_BLKS;
@@ -614,6 +632,42 @@ pub mod hexrays {
             Ok(result)
         }
     }
+
+    /// Generate microcode for `f` up to `maturity` (an `mba_maturity_t`)
+    /// and flatten it into `out`, without building a ctree.
+    pub unsafe fn gen_microcode(
+        f: *mut super::ffi::func_t,
+        maturity: i32,
+        all_blocks: bool,
+        out: &mut super::ffix::microcode_export_t,
+    ) -> Result<(), HexRaysError> {
+        let mut flags = __impl::DECOMP_NO_WAIT | __impl::DECOMP_NO_CACHE;
+
+        if all_blocks {
+            flags |= __impl::DECOMP_ALL_BLKS;
+        }
+
+        let mut failure = super::ffix::hexrays_error_t::default();
+        let generated = super::ffix::idalib_hexrays_gen_microcode(
+            f,
+            maturity.into(),
+            (flags as i32).into(),
+            out,
+            &mut failure as *mut _,
+        );
+
+        let code = HexRaysErrorCode::from(mem::transmute::<i32, merror_t>(failure.code));
+
+        if !generated || code.is_err() {
+            Err(HexRaysError {
+                addr: failure.addr,
+                code,
+                desc: failure.desc,
+            })
+        } else {
+            Ok(())
+        }
+    }
 }
 
 pub mod idp {
@@ -637,6 +691,7 @@ pub mod inf {
     }
 
     pub use super::ffi::filetype_t;
+    pub use super::ffix::{idalib_inf_snapshot, inf_snapshot_t};
     pub use super::ffix::{
         idalib_inf_abi_set_by_user, idalib_inf_allow_non_matched_ops, idalib_inf_allow_sigmulti,
         idalib_inf_append_sigcmt, idalib_inf_big_arg_align, idalib_inf_check_manual_ops,
@@ -728,11 +783,420 @@ mod ffix {
         desc: String,
     }
 
+    #[derive(Default)]
+    struct pseudocode_span_t {
+        start: u32,
+        end: u32,
+        color: u8,
+        addr: u64,
+    }
+
+    #[derive(Default)]
+    struct ctree_node_t {
+        op: u16,
+        is_expr: bool,
+        parent: i32,
+        subtree_end: u32,
+        ea: u64,
+        has_value: bool,
+        value: u64,
+    }
+
+    #[derive(Default)]
+    struct ctree_export_t {
+        nodes: Vec<ctree_node_t>,
+        child_offsets: Vec<u32>,
+        children: Vec<u32>,
+    }
+
+    #[derive(Clone, Copy, Debug, Default)]
+    struct minsn_node_t {
+        opcode: u16,
+        ea: u64,
+        block: u32,
+        parent: i32,
+        l: i32,
+        r: i32,
+        d: i32,
+    }
+
+    #[derive(Clone, Copy, Debug, Default)]
+    struct mop_node_t {
+        kind: u8,
+        size: i32,
+        value: u64,
+        insn: u32,
+        parent: i32,
+        sub_insn: i32,
+    }
+
+    #[derive(Default)]
+    struct microcode_export_t {
+        maturity: i32,
+        block_starts: Vec<u64>,
+        block_ends: Vec<u64>,
+        block_types: Vec<i32>,
+        insn_offsets: Vec<u32>,
+        succ_offsets: Vec<u32>,
+        succs: Vec<u32>,
+        pred_offsets: Vec<u32>,
+        preds: Vec<u32>,
+        insns: Vec<minsn_node_t>,
+        operands: Vec<mop_node_t>,
+    }
+
+    #[derive(Default)]
+    struct func_cfg_t {
+        starts: Vec<u64>,
+        ends: Vec<u64>,
+        kinds: Vec<i32>,
+        succ_offsets: Vec<u32>,
+        succs: Vec<u32>,
+        pred_offsets: Vec<u32>,
+        preds: Vec<u32>,
+        entry: i32,
+        exit: i32,
+    }
+
+    #[derive(Default)]
+    struct call_graph_t {
+        callers: Vec<u64>,
+        callees: Vec<u64>,
+        sites: Vec<u64>,
+    }
+
+    #[derive(Default)]
+    struct type_table_t {
+        ordinals: Vec<u32>,
+        kinds: Vec<u8>,
+        sizes: Vec<u64>,
+        name_offsets: Vec<u32>,
+        names: Vec<u8>,
+        type_offsets: Vec<u32>,
+        field_offsets: Vec<u32>,
+        serialized: Vec<u8>,
+    }
+
+    #[derive(Default)]
+    struct func_features_t {
+        dims: u32,
+        minhash_size: u32,
+        starts: Vec<u64>,
+        vectors: Vec<f32>,
+        minhash: Vec<u64>,
+        simhash: Vec<u64>,
+        tokens: Vec<u32>,
+    }
+
+    #[derive(Clone, Copy, Debug, Default)]
+    struct annotation_op_t {
+        ea: u64,
+        kind: u8,
+        flags: i32,
+        value: u32,
+        text: u32,
+    }
+
+    #[derive(Default)]
+    struct auto_stage_time_t {
+        queue: i32,
+        nanos: u64,
+        steps: u64,
+    }
+
+    #[derive(Default)]
+    struct auto_step_t {
+        steps: u64,
+        nanos: u64,
+        queue: i32,
+        ea: u64,
+        done: bool,
+    }
+
+    #[derive(Default)]
+    struct auto_queue_depth_t {
+        queue: i32,
+        pending: u64,
+        next: u64,
+    }
+
+    #[derive(Default)]
+    struct open_profile_t {
+        loader_nanos: u64,
+        init_database_nanos: u64,
+        stages: Vec<auto_stage_time_t>,
+    }
+
+    #[derive(Clone, Debug, Default)]
+    struct license_state_t {
+        valid: bool,
+        borrowed: bool,
+        borrow_result: i32,
+        id: [u8; 6],
+        error: String,
+    }
+
+    #[derive(Clone, Debug, Default)]
+    struct inf_snapshot_t {
+        version: u16,
+        genflags: u16,
+        is_auto_enabled: bool,
+        use_allasm: bool,
+        loading_idc: bool,
+        no_store_user_info: bool,
+        readonly_idb: bool,
+        check_manual_ops: bool,
+        allow_non_matched_ops: bool,
+        is_graph_view: bool,
+        lflags: u32,
+        decode_fpp: bool,
+        is_32bit_or_higher: bool,
+        is_32bit_exactly: bool,
+        is_16bit: bool,
+        is_64bit: bool,
+        is_dll: bool,
+        is_flat_off32: bool,
+        is_be: bool,
+        is_wide_high_byte_first: bool,
+        dbg_no_store_path: bool,
+        is_snapshot: bool,
+        pack_idb: bool,
+        compress_idb: bool,
+        is_kernel_mode: bool,
+        app_bitness: u32,
+        database_change_count: u32,
+        filetype: u32,
+        ostype: u16,
+        apptype: u16,
+        asmtype: u8,
+        specsegs: u8,
+        af: u32,
+        trace_flow: bool,
+        mark_code: bool,
+        create_jump_tables: bool,
+        noflow_to_data: bool,
+        create_all_xrefs: bool,
+        create_func_from_ptr: bool,
+        create_func_from_call: bool,
+        create_func_tails: bool,
+        should_create_stkvars: bool,
+        propagate_stkargs: bool,
+        propagate_regargs: bool,
+        should_trace_sp: bool,
+        full_sp_ana: bool,
+        noret_ana: bool,
+        guess_func_type: bool,
+        truncate_on_del: bool,
+        create_strlit_on_xref: bool,
+        check_unicode_strlits: bool,
+        create_off_using_fixup: bool,
+        create_off_on_dref: bool,
+        op_offset: bool,
+        data_offset: bool,
+        use_flirt: bool,
+        append_sigcmt: bool,
+        allow_sigmulti: bool,
+        hide_libfuncs: bool,
+        rename_jumpfunc: bool,
+        rename_nullsub: bool,
+        coagulate_data: bool,
+        coagulate_code: bool,
+        final_pass: bool,
+        af2: u32,
+        handle_eh: bool,
+        handle_rtti: bool,
+        macros_enabled: bool,
+        merge_strlits: bool,
+        base_address: u64,
+        start_stack_segment: u64,
+        start_code_segment: u64,
+        start_instruction_pointer: u64,
+        start_address: u64,
+        start_stack_pointer: u64,
+        main_address: u64,
+        min_address: u64,
+        max_address: u64,
+        omin_address: u64,
+        omax_ea: u64,
+        lowoff: u64,
+        highoff: u64,
+        maxref: u64,
+        netdelta: i64,
+        xrefnum: u8,
+        type_xrefnum: u8,
+        refcmtnum: u8,
+        xrefflag: u8,
+        show_xref_seg: bool,
+        show_xref_tmarks: bool,
+        show_xref_fncoff: bool,
+        show_xref_val: bool,
+        max_autoname_len: u16,
+        nametype: i8,
+        short_demnames: u32,
+        long_demnames: u32,
+        demnames: u8,
+        listnames: u8,
+        indent: u8,
+        cmt_indent: u8,
+        margin: u16,
+        lenxref: u16,
+        outflags: u32,
+        show_void: bool,
+        show_auto: bool,
+        gen_null: bool,
+        show_line_pref: bool,
+        line_pref_with_seg: bool,
+        gen_lzero: bool,
+        gen_org: bool,
+        gen_assume: bool,
+        gen_tryblks: bool,
+        cmtflg: u8,
+        show_repeatables: bool,
+        show_all_comments: bool,
+        hide_comments: bool,
+        show_src_linnum: bool,
+        test_mode: bool,
+        show_hidden_insns: bool,
+        show_hidden_funcs: bool,
+        show_hidden_segms: bool,
+        limiter: u8,
+        is_limiter_thin: bool,
+        is_limiter_thick: bool,
+        is_limiter_empty: bool,
+        bin_prefix_size: i16,
+        prefflag: u8,
+        prefix_show_segaddr: bool,
+        prefix_show_funcoff: bool,
+        prefix_show_stack: bool,
+        prefix_truncate_opcode_bytes: bool,
+        strlit_flags: u8,
+        strlit_names: bool,
+        strlit_name_bit: bool,
+        strlit_serial_names: bool,
+        unicode_strlits: bool,
+        strlit_autocmt: bool,
+        strlit_savecase: bool,
+        strlit_break: u8,
+        strlit_zeroes: i8,
+        strtype: i32,
+        strlit_sernum: u64,
+        datatypes: u64,
+        abibits: u32,
+        is_mem_aligned4: bool,
+        pack_stkargs: bool,
+        big_arg_align: bool,
+        stack_ldbl: bool,
+        stack_varargs: bool,
+        is_hard_float: bool,
+        abi_set_by_user: bool,
+        use_gcc_layout: bool,
+        map_stkargs: bool,
+        huge_arg_align: bool,
+        appcall_options: u32,
+        privrange_start_address: u64,
+        privrange_end_address: u64,
+        cc_id: u8,
+        cc_cm: u8,
+        cc_size_i: u8,
+        cc_size_b: u8,
+        cc_size_e: u8,
+        cc_defalign: u8,
+        cc_size_s: u8,
+        cc_size_l: u8,
+        cc_size_ll: u8,
+        cc_size_ldbl: u8,
+        procname: String,
+        strlit_pref: String,
+        input_file_md5: [u8; 16],
+        input_file_sha256: [u8; 32],
+        input_file_path: String,
+        input_file_size: usize,
+    }
+
+    #[derive(Default)]
+    struct insn_batch_t {
+        eas: Vec<u64>,
+        sizes: Vec<u16>,
+        itypes: Vec<u16>,
+        flags: Vec<u32>,
+        op_offsets: Vec<u32>,
+        op_types: Vec<u8>,
+        op_dtypes: Vec<u8>,
+        op_flags: Vec<u8>,
+        op_regs: Vec<u16>,
+        op_values: Vec<u64>,
+        op_addrs: Vec<u64>,
+        op_specvals: Vec<u64>,
+    }
+
+    #[derive(Default)]
+    struct name_table_t {
+        eas: Vec<u64>,
+        offsets: Vec<u32>,
+        flags: Vec<u8>,
+        arena: Vec<u8>,
+    }
+
+    #[derive(Default)]
+    struct xref_item_t {
+        from: u64,
+        to: u64,
+        iscode: bool,
+        kind: u8,
+        user: bool,
+    }
+
+    #[derive(Default)]
+    struct strlist_item_t {
+        ea: u64,
+        offset: usize,
+        length: usize,
+        strtype: i32,
+        index: usize,
+    }
+
+    #[derive(Clone, Copy, Debug, Default)]
+    struct patch_range_t {
+        ea: u64,
+        offset: u64,
+        size: u64,
+    }
+
+    #[derive(Default)]
+    struct patch_result_t {
+        written: u64,
+        applied: Vec<u8>,
+        planned: Vec<u64>,
+        heads: Vec<u64>,
+        functions: Vec<u64>,
+    }
+
+    #[derive(Clone, Debug, Default)]
+    struct sreg_ranges_t {
+        starts: Vec<u64>,
+        ends: Vec<u64>,
+        values: Vec<u64>,
+        tags: Vec<u8>,
+        thumb: bool,
+    }
+
+    #[derive(Clone, Debug, Default)]
+    struct flags_map_t {
+        start: u64,
+        end: u64,
+        words: u64,
+        bits: Vec<u64>,
+        span_starts: Vec<u64>,
+        span_kinds: Vec<u8>,
+    }
+
     unsafe extern "C++" {
         include!("autocxxgen_ffi.h");
         include!("idalib.hpp");
 
         include!("types.h");
+        include!("annotations_extras.h");
+        include!("auto_extras.h");
         include!("bookmarks_extras.h");
         include!("bytes_extras.h");
         include!("comments_extras.h");
@@ -741,14 +1205,17 @@ mod ffix {
         include!("hexrays_extras.h");
         include!("idalib_extras.h");
         include!("inf_extras.h");
+        include!("insn_extras.h");
         include!("kernwin_extras.h");
         include!("loader_extras.h");
+        include!("name_extras.h");
         include!("nalt_extras.h");
         include!("ph_extras.h");
         include!("segm_extras.h");
         include!("search_extras.h");
         include!("strings_extras.h");
         include!("types_extras.h");
+        include!("xref_extras.h");
 
         type c_short = autocxx::c_short;
         type c_int = autocxx::c_int;
@@ -786,8 +1253,30 @@ mod ffix {
             argv: *const *const c_char,
             auto_analysis: bool,
         ) -> c_int;
-        unsafe fn idalib_check_license() -> bool;
-        unsafe fn idalib_get_license_id(id: &mut [u8; 6]) -> bool;
+        unsafe fn idalib_open_database_profiled(
+            argc: c_int,
+            argv: *const *const c_char,
+            auto_analysis: bool,
+            profile: &mut open_profile_t,
+        ) -> c_int;
+        unsafe fn idalib_save_database_packed(compress: bool) -> bool;
+        unsafe fn idalib_auto_wait_profiled(stages: &mut Vec<auto_stage_time_t>) -> bool;
+        unsafe fn idalib_auto_step(
+            max_steps: u64,
+            max_nanos: u64,
+            stages: &mut Vec<auto_stage_time_t>,
+        ) -> auto_step_t;
+        unsafe fn idalib_auto_queue_depths(limit: u64, out: &mut Vec<auto_queue_depth_t>);
+        unsafe fn idalib_auto_pending_in(start: c_ulonglong, end: c_ulonglong) -> bool;
+        unsafe fn idalib_auto_is_done() -> bool;
+
+        unsafe fn idalib_apply_annotations(
+            ops: &[annotation_op_t],
+            text: &[u8],
+            statuses: &mut Vec<u8>,
+        ) -> usize;
+
+        unsafe fn idalib_query_license(out: &mut license_state_t);
 
         // NOTE: we can't use uval_t here due to it resolving to c_ulonglong,
         // which causes `verify_extern_type` to fail...
@@ -802,11 +1291,33 @@ mod ffix {
             f: *mut func_t,
             flags: c_int,
         ) -> Result<UniquePtr<qflow_chart_t>>;
+        unsafe fn idalib_func_flow_chart_flat(
+            f: *mut func_t,
+            flags: c_int,
+            out: &mut func_cfg_t,
+        ) -> Result<()>;
+        unsafe fn idalib_func_call_graph(starts: &[u64], out: &mut call_graph_t);
+        unsafe fn idalib_func_features(
+            starts: &[u64],
+            buckets: u32,
+            minhash_size: u32,
+            shingle: u32,
+            out: &mut func_features_t,
+        );
 
         unsafe fn idalib_hexrays_cfuncptr_inner(
             f: *const qrefcnt_t_cfunc_t_AutocxxConcrete,
         ) -> *mut cfunc_t;
         unsafe fn idalib_hexrays_cfunc_pseudocode(f: *mut cfunc_t) -> String;
+        unsafe fn idalib_hexrays_cfunc_pseudocode_size(f: *mut cfunc_t) -> usize;
+        unsafe fn idalib_hexrays_cfunc_render(
+            f: *mut cfunc_t,
+            out: &mut [u8],
+            with_lines: bool,
+            line_ends: &mut Vec<u32>,
+            with_spans: bool,
+            spans: &mut Vec<pseudocode_span_t>,
+        ) -> usize;
 
         unsafe fn idalib_hexrays_decompile_func(
             f: *mut func_t,
@@ -814,10 +1325,25 @@ mod ffix {
             flags: c_int,
         ) -> UniquePtr<qrefcnt_t_cfunc_t_AutocxxConcrete>;
 
+        unsafe fn idalib_hexrays_cfunc_export_ctree(f: *mut cfunc_t, out: &mut ctree_export_t);
+        unsafe fn idalib_hexrays_gen_microcode(
+            f: *mut func_t,
+            maturity: c_int,
+            flags: c_int,
+            out: &mut microcode_export_t,
+            err: *mut hexrays_error_t,
+        ) -> bool;
+        unsafe fn idalib_hexrays_ctype_name(op: u16) -> String;
+
+        unsafe fn idalib_hexrays_has_cached_cfunc(ea: c_ulonglong) -> bool;
+        unsafe fn idalib_hexrays_mark_cfunc_dirty(ea: c_ulonglong, close_views: bool) -> bool;
+
         unsafe fn idalib_hexrays_cblock_iter(b: *mut cblock_t) -> UniquePtr<cblock_iter>;
         unsafe fn idalib_hexrays_cblock_iter_next(slf: Pin<&mut cblock_iter>) -> *mut cinsn_t;
         unsafe fn idalib_hexrays_cblock_len(b: *mut cblock_t) -> usize;
 
+        unsafe fn idalib_inf_snapshot(out: &mut inf_snapshot_t);
+
         unsafe fn idalib_inf_get_version() -> u16;
         unsafe fn idalib_inf_get_genflags() -> u16;
         unsafe fn idalib_inf_is_auto_enabled() -> bool;
@@ -997,7 +1523,13 @@ mod ffix {
         unsafe fn idalib_ph_id(ph: *const processor_t) -> i32;
         unsafe fn idalib_ph_short_name(ph: *const processor_t) -> String;
         unsafe fn idalib_ph_long_name(ph: *const processor_t) -> String;
+        unsafe fn idalib_arm_t_register() -> i32;
         unsafe fn idalib_is_thumb_at(ph: *const processor_t, ea: c_ulonglong) -> bool;
+        unsafe fn idalib_get_sreg_ranges(
+            ph: *const processor_t,
+            rg: c_int,
+            out: &mut sreg_ranges_t,
+        ) -> bool;
 
         unsafe fn idalib_qflow_graph_getn_block(
             f: *const qflow_chart_t,
@@ -1034,19 +1566,52 @@ mod ffix {
 
         unsafe fn idalib_get_strlist_item_addr(index: usize) -> c_ulonglong;
         unsafe fn idalib_get_strlist_item_length(index: usize) -> usize;
+        unsafe fn idalib_get_strlist_items(items: &mut Vec<strlist_item_t>) -> usize;
+        unsafe fn idalib_get_strlist_contents(
+            items: &mut [strlist_item_t],
+            arena: &mut [u8],
+        ) -> Result<()>;
 
         unsafe fn idalib_ea2str(ea: c_ulonglong) -> String;
 
+        unsafe fn idalib_xrefs_collect(
+            start: c_ulonglong,
+            end: c_ulonglong,
+            to: bool,
+            flags: c_int,
+            kinds: u8,
+            out: &mut Vec<xref_item_t>,
+        );
+
         unsafe fn idalib_get_byte(ea: c_ulonglong) -> u8;
         unsafe fn idalib_get_word(ea: c_ulonglong) -> u16;
         unsafe fn idalib_get_dword(ea: c_ulonglong) -> u32;
         unsafe fn idalib_get_qword(ea: c_ulonglong) -> u64;
         unsafe fn idalib_get_bytes(ea: c_ulonglong, buf: &mut Vec<u8>) -> Result<usize>;
+        unsafe fn idalib_get_bytes_into(
+            ea: c_ulonglong,
+            buf: &mut [u8],
+            mask: &mut [u8],
+        ) -> Result<usize>;
+        unsafe fn idalib_patch_ranges(
+            ranges: &[patch_range_t],
+            data: &[u8],
+            patch: bool,
+            reanalyze: bool,
+            out: &mut patch_result_t,
+        );
+        unsafe fn idalib_get_flags_map(
+            start: c_ulonglong,
+            end: c_ulonglong,
+            spans: bool,
+            out: &mut flags_map_t,
+        );
 
         unsafe fn idalib_get_input_file_path() -> String;
 
         unsafe fn idalib_plugin_version(p: *const plugin_t) -> u64;
         unsafe fn idalib_plugin_flags(p: *const plugin_t) -> u64;
+        unsafe fn idalib_get_database_path(unpacked: bool) -> String;
 
         unsafe fn idalib_get_library_version(
             major: *mut c_int,
@@ -1054,11 +1619,26 @@ mod ffix {
             build: *mut c_int,
         ) -> bool;
         unsafe fn idalib_set_name(ea: c_ulonglong, name: *const c_char, flags: c_int) -> bool;
+        unsafe fn idalib_get_name_table(out: &mut name_table_t);
+
+        unsafe fn idalib_decode_range(
+            start: c_ulonglong,
+            end: c_ulonglong,
+            linear: bool,
+            out: &mut insn_batch_t,
+        ) -> usize;
+        unsafe fn idalib_decode_func(f: *mut func_t, out: &mut insn_batch_t) -> Result<usize>;
 
         unsafe fn idalib_parse_header_file(filename: *const c_char) -> c_int;
         unsafe fn idalib_tinfo_get_name_by_ordinal(ordinal: u32) -> Result<String>;
         unsafe fn idalib_is_valid_type_ordinal(ordinal: u32) -> bool;
+        unsafe fn idalib_type_index_reset();
         unsafe fn idalib_get_type_ordinal_limit() -> u32;
+        unsafe fn idalib_get_type_table(
+            with_sizes: bool,
+            with_serialized: bool,
+            out: &mut type_table_t,
+        );
 
         // Type assignment functions
         unsafe fn idalib_apply_type_by_ordinal(ea: c_ulonglong, ordinal: u32, flags: u32) -> bool;
@@ -1094,6 +1674,7 @@ pub mod insn {
     use super::ea_t;
     use super::ffi::decode_insn;
 
+    pub use super::ffix::{idalib_decode_func, idalib_decode_range, insn_batch_t};
     pub use super::pod::insn_t;
 
     pub fn decode(ea: ea_t) -> Option<insn_t> {
@@ -1145,7 +1726,9 @@ pub mod func {
         get_func_qty, getn_func, lock_func, qbasic_block_t, qflow_chart_t,
     };
     pub use super::ffix::{
-        idalib_func_flags, idalib_func_flow_chart, idalib_func_name, idalib_func_set_name, idalib_func_set_noret, idalib_qbasic_block_preds,
+        call_graph_t, func_cfg_t, func_features_t, idalib_func_call_graph, idalib_func_features,
+        idalib_func_flags, idalib_func_flow_chart, idalib_func_flow_chart_flat, idalib_func_name,
+        idalib_func_set_name, idalib_func_set_noret, idalib_qbasic_block_preds,
         idalib_qbasic_block_succs, idalib_qflow_graph_getn_block,
     };
 
@@ -1169,7 +1752,8 @@ pub mod func {
 pub mod processor {
     pub use super::ffi::{get_ph, processor_t};
     pub use super::ffix::{
-        idalib_is_thumb_at, idalib_ph_id, idalib_ph_long_name, idalib_ph_short_name,
+        idalib_arm_t_register, idalib_get_sreg_ranges, idalib_is_thumb_at, idalib_ph_id,
+        idalib_ph_long_name, idalib_ph_short_name, sreg_ranges_t,
     };
 
     pub use super::idp as ids;
@@ -1194,7 +1778,9 @@ pub mod segment {
 pub mod bytes {
     pub use super::ffi::{flags64_t, get_flags, is_code, is_data};
     pub use super::ffix::{
-        idalib_get_byte, idalib_get_bytes, idalib_get_dword, idalib_get_qword, idalib_get_word,
+        flags_map_t, idalib_get_byte, idalib_get_bytes, idalib_get_bytes_into, idalib_get_dword,
+        idalib_get_flags_map, idalib_get_qword, idalib_get_word, idalib_patch_ranges,
+        patch_range_t, patch_result_t,
     };
 }
 
@@ -1211,6 +1797,7 @@ pub mod xref {
         cref_t, dref_t, has_external_refs, xrefblk_t, xrefblk_t_first_from, xrefblk_t_first_to,
         xrefblk_t_next_from, xrefblk_t_next_to,
     };
+    pub use super::ffix::{idalib_xrefs_collect, xref_item_t};
 }
 
 pub mod comments {
@@ -1222,6 +1809,10 @@ pub mod conversions {
     pub use super::ffix::idalib_ea2str;
 }
 
+pub mod annotations {
+    pub use super::ffix::{annotation_op_t, idalib_apply_annotations};
+}
+
 pub mod bookmarks {
     pub use super::ffix::{
         idalib_bookmarks_t_erase, idalib_bookmarks_t_find_index, idalib_bookmarks_t_get,
@@ -1235,12 +1826,15 @@ pub mod search {
 
 pub mod strings {
     pub use super::ffi::{build_strlist, clear_strlist, get_strlist_qty};
-    pub use super::ffix::{idalib_get_strlist_item_addr, idalib_get_strlist_item_length};
+    pub use super::ffix::{
+        idalib_get_strlist_contents, idalib_get_strlist_item_addr, idalib_get_strlist_item_length,
+        idalib_get_strlist_items, strlist_item_t,
+    };
 }
 
 pub mod loader {
     pub use super::ffi::{find_plugin, plugin_t, run_plugin};
-    pub use super::ffix::{idalib_plugin_flags, idalib_plugin_version};
+    pub use super::ffix::{idalib_get_database_path, idalib_plugin_flags, idalib_plugin_version};
 
     pub mod flags {
         pub use super::super::ffi::{
@@ -1262,14 +1856,17 @@ pub mod name {
         get_nlist_ea, get_nlist_idx, get_nlist_name, get_nlist_size, is_in_nlist, is_public_name,
         is_weak_name,
     };
-    pub use super::ffix::idalib_set_name;
+    pub use super::ffix::{idalib_get_name_table, idalib_set_name, name_table_t};
 }
 
 pub mod ida {
     use std::env;
-    use std::ffi::{CStr, CString};
+    use std::ffi::{CStr, CString, c_char};
     use std::path::Path;
     use std::ptr;
+    use std::sync::Mutex;
+    use std::sync::atomic::{AtomicU64, Ordering};
+    use std::time::{Duration, Instant};
 
     use autocxx::prelude::*;
 
@@ -1277,25 +1874,81 @@ pub mod ida {
     use super::{IDAError, ea_t, ffi, ffix};
 
     pub use ffi::auto_wait;
+    pub use ffix::{
+        auto_queue_depth_t, auto_stage_time_t, auto_step_t, idalib_auto_is_done,
+        idalib_auto_pending_in, idalib_auto_queue_depths, license_state_t, open_profile_t,
+    };
 
-    pub fn is_license_valid() -> bool {
+    // The last successful license query, shared by every database open in
+    // the process; failed queries are never cached, so they are retried.
+    static LICENSE_CACHE: Mutex<Option<(license_state_t, Instant)>> = Mutex::new(None);
+    static LICENSE_CACHE_TTL_NANOS: AtomicU64 =
+        AtomicU64::new(DEFAULT_LICENSE_CACHE_TTL.as_secs() * 1_000_000_000);
+
+    pub const DEFAULT_LICENSE_CACHE_TTL: Duration = Duration::from_secs(600);
+
+    /// Check (and if needed, borrow) the license, bypassing the cache; a
+    /// valid result replaces the cached one.
+    pub fn refresh_license_state() -> (license_state_t, Instant) {
         assert!(
             is_main_thread(),
             "IDA cannot function correctly when not running on the main thread"
         );
 
-        unsafe { ffix::idalib_check_license() }
+        let mut state = license_state_t::default();
+        unsafe { ffix::idalib_query_license(&mut state) };
+
+        let checked_at = Instant::now();
+
+        let mut cache = LICENSE_CACHE.lock().unwrap_or_else(|e| e.into_inner());
+        if state.valid {
+            *cache = Some((state.clone(), checked_at));
+        } else {
+            *cache = None;
+        }
+
+        (state, checked_at)
     }
 
-    pub fn license_id() -> Result<[u8; 6], IDAError> {
-        assert!(
-            is_main_thread(),
-            "IDA cannot function correctly when not running on the main thread"
-        );
+    /// The cached license state if it has not expired, otherwise a fresh
+    /// one (see `refresh_license_state`).
+    pub fn license_state() -> (license_state_t, Instant) {
+        let ttl = license_cache_ttl();
+        {
+            let cache = LICENSE_CACHE.lock().unwrap_or_else(|e| e.into_inner());
+            if let Some((state, checked_at)) = cache.as_ref() {
+                if checked_at.elapsed() < ttl {
+                    return (state.clone(), *checked_at);
+                }
+            }
+        }
+        refresh_license_state()
+    }
+
+    /// Drop the cached license state, so the next check queries the license
+    /// manager again.
+    pub fn invalidate_license_state() {
+        *LICENSE_CACHE.lock().unwrap_or_else(|e| e.into_inner()) = None;
+    }
+
+    pub fn license_cache_ttl() -> Duration {
+        Duration::from_nanos(LICENSE_CACHE_TTL_NANOS.load(Ordering::Relaxed))
+    }
+
+    /// Set how long a valid license state is reused; zero disables caching.
+    pub fn set_license_cache_ttl(ttl: Duration) {
+        let nanos = u64::try_from(ttl.as_nanos()).unwrap_or(u64::MAX);
+        LICENSE_CACHE_TTL_NANOS.store(nanos, Ordering::Relaxed);
+    }
+
+    pub fn is_license_valid() -> bool {
+        license_state().0.valid
+    }
 
-        let mut lid = [0u8; 6];
-        if unsafe { ffix::idalib_get_license_id(&mut lid) } {
-            Ok(lid)
+    pub fn license_id() -> Result<[u8; 6], IDAError> {
+        let (state, _) = license_state();
+        if state.valid {
+            Ok(state.id)
         } else {
             Err(IDAError::InvalidLicense)
         }
@@ -1390,6 +2043,60 @@ pub mod ida {
             return Err(IDAError::InvalidLicense);
         }
 
+        let args = open_database_args(path, args)?;
+        let argv = open_database_argv(&args)?;
+        let argc = argv.len();
+
+        let res = unsafe {
+            ffix::idalib_open_database_quiet(c_int(argc as _), argv.as_ptr(), auto_analysis)
+        };
+
+        if res != c_int(0) {
+            Err(IDAError::OpenDb(res))
+        } else {
+            Ok(())
+        }
+    }
+
+    pub fn open_database_profiled(
+        path: impl AsRef<Path>,
+        auto_analysis: bool,
+        args: &[impl AsRef<str>],
+        profile: &mut open_profile_t,
+    ) -> Result<(), IDAError> {
+        assert!(
+            is_main_thread(),
+            "IDA cannot function correctly when not running on the main thread"
+        );
+
+        if !is_license_valid() {
+            return Err(IDAError::InvalidLicense);
+        }
+
+        let args = open_database_args(path, args)?;
+        let argv = open_database_argv(&args)?;
+        let argc = argv.len();
+
+        let res = unsafe {
+            ffix::idalib_open_database_profiled(
+                c_int(argc as _),
+                argv.as_ptr(),
+                auto_analysis,
+                profile,
+            )
+        };
+
+        if res != c_int(0) {
+            Err(IDAError::OpenDb(res))
+        } else {
+            Ok(())
+        }
+    }
+
+    fn open_database_args(
+        path: impl AsRef<Path>,
+        args: &[impl AsRef<str>],
+    ) -> Result<Vec<CString>, IDAError> {
         let mut args = args
             .iter()
             .map(|s| CString::new(s.as_ref()).map_err(IDAError::ffi))
@@ -1398,22 +2105,66 @@ pub mod ida {
         let path = CString::new(path.as_ref().to_string_lossy().as_ref()).map_err(IDAError::ffi)?;
         args.push(path);
 
+        Ok(args)
+    }
+
+    fn open_database_argv(args: &[CString]) -> Result<Vec<*const c_char>, IDAError> {
         let idalib0 = CStr::from_bytes_with_nul(b"idalib\0").map_err(IDAError::ffi)?;
 
-        let argv = std::iter::once(idalib0.as_ptr())
+        Ok(std::iter::once(idalib0.as_ptr())
             .chain(args.iter().map(|s| s.as_ptr()))
-            .collect::<Vec<_>>();
-        let argc = argv.len();
+            .collect())
+    }
 
-        let res = unsafe {
-            ffix::idalib_open_database_quiet(c_int(argc as _), argv.as_ptr(), auto_analysis)
+    pub fn auto_wait_profiled(stages: &mut Vec<auto_stage_time_t>) -> bool {
+        assert!(
+            is_main_thread(),
+            "IDA cannot function correctly when not running on the main thread"
+        );
+
+        unsafe { ffix::idalib_auto_wait_profiled(stages) }
+    }
+
+    pub fn auto_step(
+        max_steps: u64,
+        max_nanos: u64,
+        stages: &mut Vec<auto_stage_time_t>,
+    ) -> auto_step_t {
+        assert!(
+            is_main_thread(),
+            "IDA cannot function correctly when not running on the main thread"
+        );
+
+        unsafe { ffix::idalib_auto_step(max_steps, max_nanos, stages) }
+    }
+
+    pub fn save_database_copy(path: impl AsRef<Path>, compress: bool) -> Result<(), IDAError> {
+        assert!(
+            is_main_thread(),
+            "IDA cannot function correctly when not running on the main thread"
+        );
+
+        let path = path.as_ref();
+        let failed = || {
+            IDAError::ffi_with(format!(
+                "failed to save database copy to {}",
+                path.display()
+            ))
         };
 
-        if res != c_int(0) {
-            Err(IDAError::OpenDb(res))
-        } else {
-            Ok(())
+        // NOTE: the database is saved in place and its file copied, rather
+        // than saved under `path`, which would retarget the open database
+        if !unsafe { ffix::idalib_save_database_packed(compress) } {
+            return Err(failed());
         }
+
+        let source = unsafe { ffix::idalib_get_database_path(false) };
+        if source.is_empty() || Path::new(&source) == path {
+            return Err(failed());
+        }
+
+        std::fs::copy(&source, path).map_err(IDAError::ffi)?;
+        Ok(())
     }
 
     pub fn close_database() {
@@ -1426,7 +2177,10 @@ pub mod ida {
             "IDA cannot function correctly when not running on the main thread"
         );
 
-        unsafe { ffi::close_database(save) }
+        unsafe {
+            ffi::close_database(save);
+            ffix::idalib_type_index_reset();
+        }
     }
 
     pub fn library_version() -> Result<(i32, i32, i32), IDAError> {
@@ -1456,7 +2210,7 @@ pub mod types {
         idalib_tinfo_get_name_by_ordinal, idalib_is_valid_type_ordinal,
         idalib_apply_type_by_ordinal, idalib_apply_type_by_decl,
         idalib_get_type_ordinal_at_address, idalib_get_type_string_at_address,
-        idalib_create_primitive_type,
+        idalib_create_primitive_type, idalib_get_type_table, type_table_t,
     };
     // CXX bridge functions for type creation
     pub use super::types_bridge::ffi_types::{
@@ -1467,5 +2221,7 @@ pub mod types {
         add_bitfield_to_struct,
         create_function_type, add_function_parameter,
         set_function_attributes, create_function_pointer_type,
+        set_udt_members, set_enum_members, set_function_parameters,
+        UdtFieldSpec, UdtBitfieldSpec, EnumMemberSpec, FuncParamSpec,
     };
 }
@@ -13,3 +13,10 @@ uint64_t idalib_plugin_version(const plugin_t *p) {
 uint64_t idalib_plugin_flags(const plugin_t *p) {
   return p == nullptr ? 0 : p->flags;
 }
+
+// The path of the packed database, or with `unpacked`, of its working .id0
+// file (the other unpacked components share its stem).
+rust::String idalib_get_database_path(bool unpacked) {
+  auto path = get_path(unpacked ? PATH_TYPE_ID0 : PATH_TYPE_IDB);
+  return path == nullptr ? rust::String() : rust::String(path);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "name.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include "cxx.h"
+
+#ifndef CXXBRIDGE1_STRUCT_name_table_t
+#define CXXBRIDGE1_STRUCT_name_table_t
+struct name_table_t final {
+  ::rust::Vec<::std::uint64_t> eas;
+  ::rust::Vec<::std::uint32_t> offsets;
+  ::rust::Vec<::std::uint8_t> flags;
+  ::rust::Vec<::std::uint8_t> arena;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_name_table_t
+
+// Export the whole name list (which the kernel keeps sorted by address) in
+// one pass: addresses, public (bit 0) and weak (bit 1) flags, and every name
+// packed into `arena`, where name `i` is `arena[offsets[i]..offsets[i + 1]]`.
+void idalib_get_name_table(name_table_t &out) {
+  auto qty = get_nlist_size();
+
+  out.eas.clear();
+  out.offsets.clear();
+  out.flags.clear();
+  out.arena.clear();
+
+  out.eas.reserve(qty);
+  out.offsets.reserve(qty + 1);
+  out.flags.reserve(qty);
+
+  size_t total = 0;
+  for (size_t i = 0; i < qty; i++) {
+    auto name = get_nlist_name(i);
+    if (name != nullptr) {
+      total += std::strlen(name);
+    }
+  }
+  out.arena.reserve(total);
+
+  out.offsets.push_back(0);
+
+  for (size_t i = 0; i < qty; i++) {
+    auto ea = get_nlist_ea(i);
+    auto name = get_nlist_name(i);
+
+    if (ea == BADADDR || name == nullptr) {
+      continue;
+    }
+
+    for (auto p = name; *p != '\0'; p++) {
+      out.arena.push_back(static_cast<uint8_t>(*p));
+    }
+
+    uint8_t flags = 0;
+    if (is_public_name(ea)) {
+      flags |= 1;
+    }
+    if (is_weak_name(ea)) {
+      flags |= 2;
+    }
+
+    out.eas.push_back(ea);
+    out.flags.push_back(flags);
+    out.offsets.push_back(static_cast<uint32_t>(out.arena.size()));
+  }
+}
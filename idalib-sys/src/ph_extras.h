@@ -4,8 +4,23 @@
 #include "idp.hpp"
 #include "segregs.hpp"
 
+#include <cstdint>
+
 #include "cxx.h"
 
+#ifndef CXXBRIDGE1_STRUCT_sreg_ranges_t
+#define CXXBRIDGE1_STRUCT_sreg_ranges_t
+struct sreg_ranges_t final {
+  ::rust::Vec<::std::uint64_t> starts;
+  ::rust::Vec<::std::uint64_t> ends;
+  ::rust::Vec<::std::uint64_t> values;
+  ::rust::Vec<::std::uint8_t> tags;
+  bool thumb;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_sreg_ranges_t
+
 std::int32_t idalib_ph_id(const processor_t *ph) {
   return ph->id;
 }
@@ -20,12 +35,61 @@ rust::String idalib_ph_long_name(const processor_t *ph) {
   return rust::String(name);
 }
 
-bool idalib_is_thumb_at(const processor_t *ph, ea_t ea) {
-  const auto T = 20;
+// The ARM `T` segment register, set in Thumb mode; only meaningful for a
+// 32-bit ARM database (see idalib_is_arm32).
+static const int IDALIB_ARM_T_REGISTER = 20;
+
+static bool idalib_is_arm32(const processor_t *ph) {
+  return ph->id == PLFM_ARM && !inf_is_64bit();
+}
+
+int idalib_arm_t_register() { return IDALIB_ARM_T_REGISTER; }
 
-  if (ph->id == PLFM_ARM && !inf_is_64bit()) {
-    auto tbit = get_sreg(ea, T);
+bool idalib_is_thumb_at(const processor_t *ph, ea_t ea) {
+  if (idalib_is_arm32(ph)) {
+    auto tbit = get_sreg(ea, IDALIB_ARM_T_REGISTER);
     return tbit != 0 && tbit != BADSEL;
   }
   return false;
 }
+
+// Enumerate every range of segment register `rg`, in address order; returns
+// false if `rg` is not a segment register of the current processor. `thumb`
+// is set if `rg` is the `T` register of a 32-bit ARM database, i.e., if the
+// values are those idalib_is_thumb_at tests.
+bool idalib_get_sreg_ranges(const processor_t *ph, int rg,
+                            sreg_ranges_t &out) {
+  out.starts.clear();
+  out.ends.clear();
+  out.values.clear();
+  out.tags.clear();
+  out.thumb = rg == IDALIB_ARM_T_REGISTER && idalib_is_arm32(ph);
+
+  if (rg < ph->reg_first_sreg || rg > ph->reg_last_sreg) {
+    return false;
+  }
+
+  auto n = get_sreg_ranges_qty(rg);
+  if (n <= 0) {
+    return true;
+  }
+
+  out.starts.reserve(n);
+  out.ends.reserve(n);
+  out.values.reserve(n);
+  out.tags.reserve(n);
+
+  sreg_range_t sr;
+  for (int i = 0; i < n; i++) {
+    if (!getn_sreg_range(&sr, rg, i)) {
+      continue;
+    }
+
+    out.starts.push_back(sr.start_ea);
+    out.ends.push_back(sr.end_ea);
+    out.values.push_back(sr.val);
+    out.tags.push_back(sr.tag);
+  }
+
+  return true;
+}
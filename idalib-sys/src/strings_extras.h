@@ -1,9 +1,26 @@
 #pragma once
 
+#include "bytes.hpp"
 #include "strlist.hpp"
 
+#include <cstdint>
+#include <stdexcept>
+
 #include "cxx.h"
 
+#ifndef CXXBRIDGE1_STRUCT_strlist_item_t
+#define CXXBRIDGE1_STRUCT_strlist_item_t
+struct strlist_item_t final {
+  ::std::uint64_t ea;
+  ::std::size_t offset;
+  ::std::size_t length;
+  ::std::int32_t strtype;
+  ::std::size_t index;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_strlist_item_t
+
 ea_t idalib_get_strlist_item_addr(size_t n) {
   string_info_t si;
   get_strlist_item(&si, n);
@@ -15,3 +32,47 @@ size_t idalib_get_strlist_item_length(size_t n) {
   get_strlist_item(&si, n);
   return (size_t)si.length;
 }
+
+// Walk the string list once, recording each item, its index in the string
+// list and the offset of its contents within a packed arena; items that
+// cannot be read are skipped. Returns the arena size required.
+size_t idalib_get_strlist_items(rust::Vec<strlist_item_t> &items) {
+  auto qty = get_strlist_qty();
+  auto offset = size_t(0);
+
+  items.clear();
+  items.reserve(qty);
+
+  for (size_t n = 0; n < qty; n++) {
+    string_info_t si;
+    if (!get_strlist_item(&si, n) || si.ea == BADADDR) {
+      continue;
+    }
+
+    auto length = si.length > 0 ? (size_t)si.length : 0;
+
+    items.push_back(strlist_item_t{si.ea, offset, length, si.type, n});
+    offset += length;
+  }
+
+  return offset;
+}
+
+// Read the contents of each item into `arena` at its offset; an item whose
+// bytes cannot be read has its length set to what was actually read.
+void idalib_get_strlist_contents(rust::Slice<strlist_item_t> items,
+                                 rust::Slice<rust::u8> arena) {
+  for (auto &item : items) {
+    if (item.length == 0) {
+      continue;
+    }
+
+    if (item.offset + item.length > arena.size()) {
+      throw std::runtime_error("string list arena too small");
+    }
+
+    auto sz = get_bytes(arena.data() + item.offset, item.length, item.ea,
+                        GMB_READALL);
+    item.length = sz >= 0 ? (size_t)sz : 0;
+  }
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <stdexcept>
 #include <string>
 #include "rust/cxx.h"
 #include "typeinf.hpp"
@@ -8,6 +9,53 @@
 #include "idp.hpp"
 #include "loader.hpp"
 
+#include "types_index.h"
+
+#ifndef CXXBRIDGE1_STRUCT_UdtFieldSpec
+#define CXXBRIDGE1_STRUCT_UdtFieldSpec
+struct UdtFieldSpec final {
+    ::rust::String name;
+    ::std::uint32_t type_ordinal;
+    ::std::uint64_t offset;
+    bool explicit_offset;
+
+    using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_UdtFieldSpec
+
+#ifndef CXXBRIDGE1_STRUCT_UdtBitfieldSpec
+#define CXXBRIDGE1_STRUCT_UdtBitfieldSpec
+struct UdtBitfieldSpec final {
+    ::rust::String name;
+    ::std::uint32_t bit_offset;
+    ::std::uint32_t bit_width;
+    bool is_unsigned;
+
+    using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_UdtBitfieldSpec
+
+#ifndef CXXBRIDGE1_STRUCT_EnumMemberSpec
+#define CXXBRIDGE1_STRUCT_EnumMemberSpec
+struct EnumMemberSpec final {
+    ::rust::String name;
+    ::std::int64_t value;
+
+    using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_EnumMemberSpec
+
+#ifndef CXXBRIDGE1_STRUCT_FuncParamSpec
+#define CXXBRIDGE1_STRUCT_FuncParamSpec
+struct FuncParamSpec final {
+    ::rust::String name;
+    ::std::uint32_t type_ordinal;
+    bool is_hidden;
+
+    using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_FuncParamSpec
+
 // Create a new struct type and return its ordinal
 inline uint32_t create_struct_type(rust::Str name) {
     std::string name_str(name);
@@ -111,6 +159,101 @@ inline bool add_field_to_type(
     return new_tif.set_numbered_type(til, type_ordinal, NTF_REPLACE) == 0;
 }
 
+// Compute the storage size of a bitfield from its end bit
+inline uint32_t bitfield_nbytes(uint32_t bit_offset, uint32_t bit_width) {
+    uint32_t end_bit = bit_offset + bit_width;
+    uint32_t nbytes = 1;
+    if (end_bit > 8) nbytes = 2;
+    if (end_bit > 16) nbytes = 4;
+    if (end_bit > 32) nbytes = 8;
+    return nbytes;
+}
+
+// Add all fields and bitfields to an existing struct/union at once; members
+// are staged and validated before a single create_udt + NTF_REPLACE store
+inline void set_udt_members(
+    uint32_t type_ordinal,
+    rust::Slice<const UdtFieldSpec> fields,
+    rust::Slice<const UdtBitfieldSpec> bitfields
+) {
+    til_t* til = get_idati();
+    if (!til) {
+        throw std::runtime_error("local type library is not available");
+    }
+    
+    // Get the struct type and its existing UDT details
+    tinfo_t struct_tif;
+    if (!struct_tif.get_numbered_type(til, type_ordinal)) {
+        throw std::runtime_error("invalid struct/union type ordinal");
+    }
+    
+    udt_type_data_t udt;
+    if (!struct_tif.get_udt_details(&udt)) {
+        throw std::runtime_error("type is not a struct or union");
+    }
+    
+    udt.reserve(udt.size() + fields.size() + bitfields.size());
+    
+    // Stage fields; offsets not given explicitly follow the previous field
+    uint64_t current_offset = 0;
+    for (const auto& field : fields) {
+        tinfo_t field_tif;
+        if (!field_tif.get_numbered_type(til, field.type_ordinal)) {
+            throw std::runtime_error(
+                "invalid type for field '" + std::string(field.name) + "'");
+        }
+        
+        uint64_t field_size = field_tif.get_size();
+        if (field_size == BADSIZE) field_size = 0;
+        
+        uint64_t offset = field.explicit_offset ? field.offset : current_offset;
+        
+        udm_t member;
+        member.name = qstring(field.name.data(), field.name.size());
+        member.type = field_tif;
+        member.offset = offset * 8; // Convert to bits
+        member.size = field_size * 8;
+        
+        udt.push_back(member);
+        
+        // Only structs advance the offset, union members all start at zero
+        if (!udt.is_union && !field.explicit_offset) {
+            current_offset += field_size > 0 ? field_size : 8;
+        }
+    }
+    
+    // Stage bitfields
+    for (const auto& bitfield : bitfields) {
+        tinfo_t bitfield_tif;
+        bitfield_type_data_t bfd(
+            bitfield_nbytes(bitfield.bit_offset, bitfield.bit_width),
+            bitfield.bit_width,
+            bitfield.is_unsigned);
+        if (!bitfield_tif.create_bitfield(bfd)) {
+            throw std::runtime_error(
+                "invalid bitfield '" + std::string(bitfield.name) + "'");
+        }
+        
+        udm_t member;
+        member.name = qstring(bitfield.name.data(), bitfield.name.size());
+        member.type = bitfield_tif;
+        member.offset = bitfield.bit_offset; // Offset in bits
+        member.size = bitfield.bit_width;    // Size in bits
+        
+        udt.push_back(member);
+    }
+    
+    // Create and store the type once
+    tinfo_t new_tif;
+    if (!new_tif.create_udt(udt)) {
+        throw std::runtime_error("failed to create struct/union type");
+    }
+    
+    if (new_tif.set_numbered_type(til, type_ordinal, NTF_REPLACE) != 0) {
+        throw std::runtime_error("failed to store struct/union type");
+    }
+}
+
 // Finalize type (ensure it's properly saved)
 inline bool finalize_type(uint32_t type_ordinal) {
     til_t* til = get_idati();
@@ -153,17 +296,12 @@ inline uint32_t get_primitive_type_ordinal(uint32_t bt_type) {
     if (!til) return 0;
     
     // Try to find existing ordinal
-    uint32_t limit = get_ordinal_limit(til);
-    for (uint32_t i = 1; i < limit; i++) {
-        tinfo_t check_tif;
-        if (check_tif.get_numbered_type(til, i)) {
-            if (tif.equals_to(check_tif)) {
-                return i;
-            }
-        }
+    if (uint32_t ordinal = idalib_type_index_find(til, tif); ordinal != 0) {
+        return ordinal;
     }
     
     // Create new ordinal
+    uint64_t generation = idalib_type_generation();
     uint32_t new_ordinal = alloc_type_ordinal(til);
     if (new_ordinal == 0) return 0;
     
@@ -171,6 +309,9 @@ inline uint32_t get_primitive_type_ordinal(uint32_t bt_type) {
         return 0;
     }
     
+    // Keep the type index in sync with the type we just added
+    idalib_type_index_insert(til, new_ordinal, tif, generation);
+    
     return new_ordinal;
 }
 
@@ -258,6 +399,46 @@ inline bool add_enum_member(uint32_t enum_ordinal, rust::Str member_name, int64_
     return new_tif.set_numbered_type(til, enum_ordinal, NTF_REPLACE) == 0;
 }
 
+// Add all members to an enum at once with a single create + store
+inline void set_enum_members(
+    uint32_t enum_ordinal,
+    rust::Slice<const EnumMemberSpec> members
+) {
+    til_t* til = get_idati();
+    if (!til) {
+        throw std::runtime_error("local type library is not available");
+    }
+    
+    tinfo_t enum_tif;
+    if (!enum_tif.get_numbered_type(til, enum_ordinal)) {
+        throw std::runtime_error("invalid enum type ordinal");
+    }
+    
+    enum_type_data_t etd;
+    if (!enum_tif.get_enum_details(&etd)) {
+        throw std::runtime_error("type is not an enum");
+    }
+    
+    etd.reserve(etd.size() + members.size());
+    
+    for (const auto& member : members) {
+        edm_t edm;
+        edm.name = qstring(member.name.data(), member.name.size());
+        edm.value = member.value;
+        
+        etd.push_back(edm);
+    }
+    
+    tinfo_t new_tif;
+    if (!new_tif.create_enum(etd)) {
+        throw std::runtime_error("failed to create enum type");
+    }
+    
+    if (new_tif.set_numbered_type(til, enum_ordinal, NTF_REPLACE) != 0) {
+        throw std::runtime_error("failed to store enum type");
+    }
+}
+
 // ============================================================================
 // Array Type Functions
 // ============================================================================
@@ -324,14 +505,8 @@ inline bool add_bitfield_to_struct(
     
     // Create bitfield type for the member
     // Calculate the nbytes based on the offset and width
-    uint32_t end_bit = bit_offset + bit_width;
-    uint32_t nbytes = 1;
-    if (end_bit > 8) nbytes = 2;
-    if (end_bit > 16) nbytes = 4;
-    if (end_bit > 32) nbytes = 8;
-    
     tinfo_t bitfield_tif;
-    bitfield_type_data_t bfd(nbytes, bit_width, is_unsigned);
+    bitfield_type_data_t bfd(bitfield_nbytes(bit_offset, bit_width), bit_width, is_unsigned);
     if (!bitfield_tif.create_bitfield(bfd)) {
         return false;
     }
@@ -464,6 +639,56 @@ inline bool add_function_parameter(
     return new_tif.set_numbered_type(til, func_ordinal, NTF_REPLACE) == 0;
 }
 
+// Add all parameters to a function type at once; parameter types are
+// validated before a single create + store
+inline void set_function_parameters(
+    uint32_t func_ordinal,
+    rust::Slice<const FuncParamSpec> params
+) {
+    til_t* til = get_idati();
+    if (!til) {
+        throw std::runtime_error("local type library is not available");
+    }
+    
+    tinfo_t func_tif;
+    if (!func_tif.get_numbered_type(til, func_ordinal)) {
+        throw std::runtime_error("invalid function type ordinal");
+    }
+    
+    func_type_data_t ftd;
+    if (!func_tif.get_func_details(&ftd)) {
+        throw std::runtime_error("type is not a function");
+    }
+    
+    ftd.reserve(ftd.size() + params.size());
+    
+    for (const auto& param : params) {
+        tinfo_t param_tif;
+        if (!param_tif.get_numbered_type(til, param.type_ordinal)) {
+            throw std::runtime_error(
+                "invalid type for parameter '" + std::string(param.name) + "'");
+        }
+        
+        funcarg_t arg;
+        arg.name = qstring(param.name.data(), param.name.size());
+        arg.type = param_tif;
+        if (param.is_hidden) {
+            arg.flags |= FAI_HIDDEN;
+        }
+        
+        ftd.push_back(arg);
+    }
+    
+    tinfo_t new_tif;
+    if (!new_tif.create_func(ftd)) {
+        throw std::runtime_error("failed to create function type");
+    }
+    
+    if (new_tif.set_numbered_type(til, func_ordinal, NTF_REPLACE) != 0) {
+        throw std::runtime_error("failed to store function type");
+    }
+}
+
 // Set function attributes
 inline bool set_function_attributes(
     uint32_t func_ordinal,
@@ -2,6 +2,33 @@
 
 #[cxx::bridge]
 pub mod ffi_types {
+    // Staged members for the batched builders; each set of members is
+    // validated and committed to the type library with a single store
+    struct UdtFieldSpec {
+        name: String,
+        type_ordinal: u32,
+        offset: u64,
+        explicit_offset: bool,
+    }
+
+    struct UdtBitfieldSpec {
+        name: String,
+        bit_offset: u32,
+        bit_width: u32,
+        is_unsigned: bool,
+    }
+
+    struct EnumMemberSpec {
+        name: String,
+        value: i64,
+    }
+
+    struct FuncParamSpec {
+        name: String,
+        type_ordinal: u32,
+        is_hidden: bool,
+    }
+
     unsafe extern "C++" {
         include!("types_bridge.h");
         
@@ -16,6 +43,15 @@ pub mod ffi_types {
         ) -> bool;
         fn finalize_type(type_ordinal: u32) -> bool;
         
+        // Batched member functions (single create + store per call)
+        fn set_udt_members(
+            type_ordinal: u32,
+            fields: &[UdtFieldSpec],
+            bitfields: &[UdtBitfieldSpec],
+        ) -> Result<()>;
+        fn set_enum_members(enum_ordinal: u32, members: &[EnumMemberSpec]) -> Result<()>;
+        fn set_function_parameters(func_ordinal: u32, params: &[FuncParamSpec]) -> Result<()>;
+        
         // Helper functions
         fn get_primitive_type_ordinal(bt_type: u32) -> u32;
         fn get_type_size(ordinal: u32) -> u64;
@@ -4,9 +4,27 @@
 #include "pro.h"
 #include "typeinf.hpp"
 
+#include "types_index.h"
+
 #include <cstdint>
 #include <memory>
 
+#ifndef CXXBRIDGE1_STRUCT_type_table_t
+#define CXXBRIDGE1_STRUCT_type_table_t
+struct type_table_t final {
+  ::rust::Vec<::std::uint32_t> ordinals;
+  ::rust::Vec<::std::uint8_t> kinds;
+  ::rust::Vec<::std::uint64_t> sizes;
+  ::rust::Vec<::std::uint32_t> name_offsets;
+  ::rust::Vec<::std::uint8_t> names;
+  ::rust::Vec<::std::uint32_t> type_offsets;
+  ::rust::Vec<::std::uint32_t> field_offsets;
+  ::rust::Vec<::std::uint8_t> serialized;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_type_table_t
+
 // Parse types from a header file
 inline int idalib_parse_header_file(const char *filename) {
   if (filename == nullptr) {
@@ -21,7 +39,11 @@ inline int idalib_parse_header_file(const char *filename) {
   // HTI_FIL = input is filename, HTI_MAC = define macros from base tils,
   // HTI_NWR = no warnings
   int flags = HTI_FIL | HTI_MAC | HTI_NWR;
-  return parse_decls(til, filename, nullptr, flags);
+  int errors = parse_decls(til, filename, nullptr, flags);
+
+  // Parsing may add or replace any number of local types
+  idalib_type_index_invalidate();
+  return errors;
 }
 
 // Get type name from tinfo_t (using void* to avoid direct tinfo_t exposure)
@@ -40,10 +62,137 @@ inline rust::String idalib_tinfo_get_name_by_ordinal(std::uint32_t ordinal) {
   return rust::String(name);
 }
 
-// Check if a type ordinal is valid
+// Check if a type ordinal is valid; this only looks the type up, without
+// deserializing it
 inline bool idalib_is_valid_type_ordinal(std::uint32_t ordinal) {
+  return get_numbered_type(get_idati(), ordinal);
+}
+
+// Kinds reported by idalib_get_type_table, from the leading type byte
+enum : std::uint8_t {
+  IDALIB_TYPE_KIND_UNKNOWN,
+  IDALIB_TYPE_KIND_PRIMITIVE,
+  IDALIB_TYPE_KIND_POINTER,
+  IDALIB_TYPE_KIND_ARRAY,
+  IDALIB_TYPE_KIND_FUNCTION,
+  IDALIB_TYPE_KIND_STRUCT,
+  IDALIB_TYPE_KIND_UNION,
+  IDALIB_TYPE_KIND_ENUM,
+  IDALIB_TYPE_KIND_TYPEDEF,
+};
+
+static std::uint8_t idalib_type_kind(const type_t *type) {
+  if (type == nullptr || *type == 0) {
+    return IDALIB_TYPE_KIND_UNKNOWN;
+  }
+
+  auto t = *type;
+
+  if (is_type_typedef(t)) {
+    return IDALIB_TYPE_KIND_TYPEDEF;
+  } else if (is_type_struct(t)) {
+    return IDALIB_TYPE_KIND_STRUCT;
+  } else if (is_type_union(t)) {
+    return IDALIB_TYPE_KIND_UNION;
+  } else if (is_type_enum(t)) {
+    return IDALIB_TYPE_KIND_ENUM;
+  } else if (is_type_func(t)) {
+    return IDALIB_TYPE_KIND_FUNCTION;
+  } else if (is_type_ptr(t)) {
+    return IDALIB_TYPE_KIND_POINTER;
+  } else if (is_type_array(t)) {
+    return IDALIB_TYPE_KIND_ARRAY;
+  }
+
+  return IDALIB_TYPE_KIND_PRIMITIVE;
+}
+
+// Walk the local type library once, collecting the ordinal, name, kind and
+// size of every numbered type (names and, with `with_serialized`, the
+// serialized type and fields strings are packed into arenas). Sizes need
+// the type to be deserialized, which reuses a single tinfo_t; they are
+// UINT64_MAX when unknown, or when `with_sizes` is false.
+inline void idalib_get_type_table(bool with_sizes, bool with_serialized,
+                                  type_table_t &out) {
+  out.ordinals.clear();
+  out.kinds.clear();
+  out.sizes.clear();
+  out.name_offsets.clear();
+  out.names.clear();
+  out.type_offsets.clear();
+  out.field_offsets.clear();
+  out.serialized.clear();
+
+  out.name_offsets.push_back(0);
+  out.type_offsets.push_back(0);
+
+  til_t *til = get_idati();
+  if (til == nullptr) {
+    return;
+  }
+
+  std::uint32_t limit = get_ordinal_limit(til);
+  if (limit == std::uint32_t(-1)) {
+    limit = 0;
+  }
+
+  out.ordinals.reserve(limit);
+  out.kinds.reserve(limit);
+  out.sizes.reserve(limit);
+  out.name_offsets.reserve(limit + 1);
+
   tinfo_t tif;
-  return tif.get_numbered_type(get_idati(), ordinal);
+
+  for (std::uint32_t i = 1; i < limit; i++) {
+    const type_t *type = nullptr;
+    const p_list *fields = nullptr;
+
+    if (!get_numbered_type(til, i, &type, &fields)) {
+      continue;
+    }
+
+    out.ordinals.push_back(i);
+    out.kinds.push_back(idalib_type_kind(type));
+
+    auto size = UINT64_MAX;
+    if (with_sizes) {
+      const type_t *ptype = type;
+      const p_list *pfields = fields;
+
+      if (tif.deserialize(til, &ptype, &pfields)) {
+        if (auto n = tif.get_size(); n != BADSIZE) {
+          size = n;
+        }
+      }
+      tif.clear();
+    }
+    out.sizes.push_back(size);
+
+    if (auto name = get_numbered_type_name(til, i); name != nullptr) {
+      for (auto c = name; *c != '\0'; c++) {
+        out.names.push_back(static_cast<std::uint8_t>(*c));
+      }
+    }
+    out.name_offsets.push_back(static_cast<std::uint32_t>(out.names.size()));
+
+    if (with_serialized) {
+      if (type != nullptr) {
+        for (auto c = type; *c != 0; c++) {
+          out.serialized.push_back(*c);
+        }
+      }
+      out.field_offsets.push_back(
+          static_cast<std::uint32_t>(out.serialized.size()));
+
+      if (fields != nullptr) {
+        for (auto c = fields; *c != 0; c++) {
+          out.serialized.push_back(*c);
+        }
+      }
+      out.type_offsets.push_back(
+          static_cast<std::uint32_t>(out.serialized.size()));
+    }
+  }
 }
 
 // Get the maximum ordinal for type iteration
@@ -75,7 +224,10 @@ inline bool idalib_apply_type_by_decl(std::uint64_t ea, const char *decl) {
     return false;
   }
 
-  return apply_cdecl(til, ea, decl);
+  // Declarations may define new local types as well
+  bool ok = apply_cdecl(til, ea, decl);
+  idalib_type_index_invalidate();
+  return ok;
 }
 
 // Get type information at an address (returns ordinal, 0 if no type)
@@ -86,18 +238,9 @@ inline std::uint32_t idalib_get_type_ordinal_at_address(std::uint64_t ea) {
     return 0;
   }
 
-  // Try to find the ordinal for this type
-  std::uint32_t limit = get_ordinal_limit(get_idati());
-  for (std::uint32_t i = 1; i < limit; i++) {
-    tinfo_t check_tif;
-    if (check_tif.get_numbered_type(get_idati(), i)) {
-      if (tif.equals_to(check_tif)) {
-        return i;
-      }
-    }
-  }
-
-  return 0; // Type not found in numbered types
+  // Find the ordinal for this type via the cached type index (0 if the type
+  // is not found in numbered types)
+  return idalib_type_index_find(get_idati(), tif);
 }
 
 // Get type declaration string at an address
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "pro.h"
+#include "ida.hpp"
+#include "idp.hpp"
+#include "typeinf.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Index from serialized type (type string + fields string) to the local type
+// ordinals carrying that definition. It is built lazily on first lookup and
+// rebuilt once the local types change (as seen by an IDB hook on
+// local_types_changed) or the ordinal limit moves; this is shared by the type
+// lookups in types_extras.h and the builders in types_bridge.h.
+//
+// NOTE: the database change count is not used, as it only moves on byte and
+// segment edits; adding or replacing a type leaves it as is
+struct idalib_type_index_t {
+  bool valid = false;
+  std::uint64_t generation = 0;
+  std::uint32_t limit = 0;
+  std::unordered_map<std::string, std::vector<std::uint32_t>> ordinals;
+};
+
+inline std::unordered_map<const til_t *, idalib_type_index_t> &
+idalib_type_indices() {
+  static std::unordered_map<const til_t *, idalib_type_index_t> indices;
+  return indices;
+}
+
+// Bumped on every change to the local types
+inline std::uint64_t &idalib_type_generation() {
+  static std::uint64_t generation = 0;
+  return generation;
+}
+
+inline bool &idalib_type_index_hooked() {
+  static bool hooked = false;
+  return hooked;
+}
+
+inline ssize_t idaapi idalib_type_index_cb(void *, int code, va_list) {
+  if (code == idb_event::local_types_changed) {
+    idalib_type_generation()++;
+  }
+  return 0;
+}
+
+// Watch for type changes; without the hook, no index is trusted past the
+// lookup that built it.
+inline bool idalib_type_index_hook() {
+  auto &hooked = idalib_type_index_hooked();
+  if (!hooked) {
+    hooked = hook_to_notification_point(HT_IDB, idalib_type_index_cb);
+  }
+  return hooked;
+}
+
+// Drop cached indices, e.g., after changing types in a way that may not be
+// notified.
+inline void idalib_type_index_invalidate() { idalib_type_generation()++; }
+
+// Drop every index and the hook; called when the database closes, since a
+// later database may reuse the same til_t pointer.
+inline void idalib_type_index_reset() {
+  if (idalib_type_index_hooked()) {
+    unhook_from_notification_point(HT_IDB, idalib_type_index_cb);
+    idalib_type_index_hooked() = false;
+  }
+
+  idalib_type_indices().clear();
+  idalib_type_generation()++;
+}
+
+inline std::uint32_t idalib_type_index_limit(const til_t *til) {
+  std::uint32_t limit = get_ordinal_limit(til);
+  return limit == std::uint32_t(-1) ? 0 : limit;
+}
+
+inline std::string idalib_type_index_key(const type_t *type,
+                                         const p_list *fields) {
+  auto key = std::string();
+
+  if (type != nullptr) {
+    key.append(reinterpret_cast<const char *>(type));
+  }
+
+  // NOTE: type strings are NUL-terminated, so NUL is a safe separator...
+  key.push_back('\0');
+
+  if (fields != nullptr) {
+    key.append(reinterpret_cast<const char *>(fields));
+  }
+
+  return key;
+}
+
+inline bool idalib_type_index_key(std::string *key, const tinfo_t &tif) {
+  qtype type;
+  qtype fields;
+
+  if (!tif.serialize(&type, &fields)) {
+    return false;
+  }
+
+  *key = idalib_type_index_key(type.c_str(), fields.c_str());
+  return true;
+}
+
+inline idalib_type_index_t &idalib_type_index_get(const til_t *til) {
+  auto &index = idalib_type_indices()[til];
+  auto hooked = idalib_type_index_hook();
+  auto generation = idalib_type_generation();
+  auto limit = idalib_type_index_limit(til);
+
+  if (index.valid && index.generation == generation && index.limit == limit) {
+    return index;
+  }
+
+  index.ordinals.clear();
+
+  for (std::uint32_t i = 1; i < limit; i++) {
+    const type_t *type = nullptr;
+    const p_list *fields = nullptr;
+
+    if (get_numbered_type(til, i, &type, &fields)) {
+      index.ordinals[idalib_type_index_key(type, fields)].push_back(i);
+    }
+  }
+
+  index.valid = hooked;
+  index.generation = generation;
+  index.limit = limit;
+
+  return index;
+}
+
+// Find the lowest ordinal whose type equals `tif` (0 if none)
+inline std::uint32_t idalib_type_index_find(const til_t *til,
+                                            const tinfo_t &tif) {
+  if (til == nullptr) {
+    return 0;
+  }
+
+  // References to numbered types already know their ordinal
+  if (auto ordinal = tif.get_ordinal(); ordinal != 0) {
+    return ordinal;
+  }
+
+  auto key = std::string();
+  if (!idalib_type_index_key(&key, tif)) {
+    return 0;
+  }
+
+  auto &index = idalib_type_index_get(til);
+
+  auto it = index.ordinals.find(key);
+  if (it == index.ordinals.end()) {
+    return 0;
+  }
+
+  // Candidates are in ascending ordinal order; confirm as the linear scan did
+  for (auto ordinal : it->second) {
+    tinfo_t check_tif;
+    if (check_tif.get_numbered_type(til, ordinal) && tif.equals_to(check_tif)) {
+      return ordinal;
+    }
+  }
+
+  return 0;
+}
+
+// Record a type we have just stored as a new ordinal; `generation` is the
+// type generation observed before the store. This keeps the index valid
+// across our own change instead of forcing a rebuild on the next lookup.
+inline void idalib_type_index_insert(const til_t *til, std::uint32_t ordinal,
+                                     const tinfo_t &tif,
+                                     std::uint64_t generation) {
+  auto indices = idalib_type_indices().find(til);
+  if (indices == idalib_type_indices().end() || !indices->second.valid ||
+      indices->second.generation != generation) {
+    return;
+  }
+
+  auto &index = indices->second;
+  auto key = std::string();
+
+  if (idalib_type_index_key(&key, tif)) {
+    index.ordinals[key].push_back(ordinal);
+    index.generation = idalib_type_generation();
+    index.limit = idalib_type_index_limit(til);
+  } else {
+    index.valid = false;
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "pro.h"
+#include "bytes.hpp"
+#include "xref.hpp"
+
+#include <cstdint>
+
+#include "cxx.h"
+
+#ifndef CXXBRIDGE1_STRUCT_xref_item_t
+#define CXXBRIDGE1_STRUCT_xref_item_t
+struct xref_item_t final {
+  ::std::uint64_t from;
+  ::std::uint64_t to;
+  bool iscode;
+  ::std::uint8_t kind;
+  bool user;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_xref_item_t
+
+// Values for the `kinds` argument below
+#define IDALIB_XREF_KINDS_ALL 0
+#define IDALIB_XREF_KINDS_CODE 1
+#define IDALIB_XREF_KINDS_DATA 2
+
+static void idalib_xrefs_push(const xrefblk_t &xb, std::uint8_t kinds,
+                              rust::Vec<xref_item_t> &out) {
+  if ((kinds == IDALIB_XREF_KINDS_CODE && !xb.iscode) ||
+      (kinds == IDALIB_XREF_KINDS_DATA && xb.iscode)) {
+    return;
+  }
+
+  out.push_back(xref_item_t{xb.from, xb.to, xb.iscode != 0, xb.type,
+                            xb.user != 0});
+}
+
+static bool idaapi idalib_xrefs_has_xref(flags64_t flags, void *) {
+  return has_xref(flags);
+}
+
+// Ordinary flow into an instruction is implied by FF_FLOW rather than
+// recorded as FF_REF
+static bool idaapi idalib_xrefs_has_xref_or_flow(flags64_t flags, void *) {
+  return has_xref(flags) || is_flow(flags);
+}
+
+// Append every xref to (`to` = true) or from an address in [start, end) to
+// `out`; `flags` are the usual XREF_* query flags.
+void idalib_xrefs_collect(ea_t start, ea_t end, bool to, int flags,
+                          std::uint8_t kinds, rust::Vec<xref_item_t> &out) {
+  xrefblk_t xb;
+
+  if (to) {
+    // Only addresses flagged as referenced (or, unless XREF_FAR excludes
+    // ordinary flow, flowed into) can be the target of an xref
+    auto targeted = (flags & XREF_FAR) != 0 ? idalib_xrefs_has_xref
+                                             : idalib_xrefs_has_xref_or_flow;
+
+    for (ea_t ea = start; ea < end && ea != BADADDR;
+         ea = next_that(ea, end, targeted)) {
+      for (bool ok = xb.first_to(ea, flags); ok; ok = xb.next_to()) {
+        idalib_xrefs_push(xb, kinds, out);
+      }
+    }
+  } else {
+    for (ea_t ea = start; ea < end && ea != BADADDR; ea = next_head(ea, end)) {
+      for (bool ok = xb.first_from(ea, flags); ok; ok = xb.next_from()) {
+        idalib_xrefs_push(xb, kinds, out);
+      }
+    }
+  }
+}
@@ -0,0 +1,216 @@
+//! Benchmarks of the common paths over the bundled `tests/ls` binary.
+//!
+//! Each benchmark measures one operation (e.g., listing every string), with
+//! throughput in the items it visits. Built with the `instrument` feature,
+//! each also prints the counted FFI calls per operation, e.g.:
+//!
+//! ```text
+//! cargo bench -p idalib --features instrument
+//! ```
+
+use std::cell::Cell;
+use std::hint::black_box;
+use std::time::{Duration, Instant};
+
+use criterion::measurement::WallTime;
+use criterion::{BenchmarkGroup, Criterion, Throughput, criterion_group, criterion_main};
+
+use idalib::idb::IDB;
+use idalib::instrument;
+use idalib::xref::XRefQuery;
+
+const PATH: &str = concat!(env!("CARGO_MANIFEST_DIR"), "/../tests/ls");
+
+// Number of functions decompiled per iteration of the decompiler benchmarks
+const DECOMPILE_LIMIT: usize = 16;
+
+// Samples taken of the benchmarks that open a database per iteration
+const OPEN_SAMPLES: usize = 10;
+
+/// Counted FFI calls and time over every iteration Criterion ran.
+#[derive(Default)]
+struct Calls {
+    iterations: Cell<u64>,
+    calls: Cell<u64>,
+    elapsed: Cell<Duration>,
+}
+
+impl Calls {
+    fn record(&self, iterations: u64, calls: u64, elapsed: Duration) {
+        self.iterations.set(self.iterations.get() + iterations);
+        self.calls.set(self.calls.get() + calls);
+        self.elapsed.set(self.elapsed.get() + elapsed);
+    }
+
+    fn report(&self, name: &str) {
+        if !instrument::enabled() {
+            return;
+        }
+
+        let iterations = self.iterations.get().max(1);
+        let ops = iterations as f64 / self.elapsed.get().as_secs_f64().max(f64::EPSILON);
+
+        println!(
+            "{name:<20} {:>10} ffi/op {ops:>12.1} ops/s",
+            self.calls.get() / iterations
+        );
+    }
+}
+
+/// Benchmark `f`, which returns the number of items it visited; `f` is run
+/// once up front to warm up and count them.
+fn bench(group: &mut BenchmarkGroup<WallTime>, name: &str, mut f: impl FnMut() -> usize) {
+    group.throughput(Throughput::Elements(black_box(f()) as u64));
+
+    let calls = Calls::default();
+    group.bench_function(name, |b| {
+        b.iter_custom(|iterations| {
+            let before = instrument::snapshot();
+            let start = Instant::now();
+            for _ in 0..iterations {
+                black_box(f());
+            }
+            let elapsed = start.elapsed();
+
+            let counted = instrument::snapshot().since(&before).total().calls;
+            calls.record(iterations, counted, elapsed);
+
+            elapsed
+        })
+    });
+    calls.report(name);
+}
+
+/// Benchmark `f` against a database freshly opened (without auto-analysis)
+/// for each iteration, timing only `f`.
+fn bench_fresh(group: &mut BenchmarkGroup<WallTime>, name: &str, f: impl Fn(&mut IDB)) {
+    group.throughput(Throughput::Elements(1));
+
+    let calls = Calls::default();
+    group.bench_function(name, |b| {
+        b.iter_custom(|iterations| {
+            let mut elapsed = Duration::ZERO;
+            let mut counted = 0;
+
+            for _ in 0..iterations {
+                let mut idb = IDB::open_with(PATH, false, false).expect("open tests/ls");
+
+                let before = instrument::snapshot();
+                let start = Instant::now();
+                f(&mut idb);
+                elapsed += start.elapsed();
+                counted += instrument::snapshot().since(&before).total().calls;
+            }
+
+            calls.record(iterations, counted, elapsed);
+            elapsed
+        })
+    });
+    calls.report(name);
+}
+
+fn open(c: &mut Criterion) {
+    let mut group = c.benchmark_group("open");
+    group.sample_size(OPEN_SAMPLES);
+
+    bench(&mut group, "open", || {
+        drop(IDB::open_with(PATH, false, false).expect("open tests/ls"));
+        1
+    });
+
+    bench_fresh(&mut group, "auto_wait", |idb| {
+        black_box(idb.auto_wait());
+    });
+
+    group.finish();
+}
+
+fn database(c: &mut Criterion) {
+    let mut idb = IDB::open_with(PATH, false, false).expect("open tests/ls");
+    idb.auto_wait();
+
+    let starts = idb
+        .functions()
+        .map(|(_, f)| f.start_address())
+        .collect::<Vec<_>>();
+
+    let mut group = c.benchmark_group("database");
+
+    bench(&mut group, "functions", || {
+        idb.functions()
+            .map(|(_, f)| black_box(f.start_address()))
+            .count()
+    });
+
+    bench(&mut group, "function names", || {
+        idb.functions().filter_map(|(_, f)| f.name()).count()
+    });
+
+    bench(&mut group, "cfg", || {
+        idb.functions()
+            .map(|(_, f)| f.cfg().expect("flow chart").blocks_count())
+            .sum()
+    });
+
+    bench(&mut group, "xrefs to", || {
+        let mut xrefs = 0;
+        for ea in &starts {
+            let mut current = idb.first_xref_to(*ea, XRefQuery::ALL);
+            while let Some(xref) = current {
+                black_box(xref.from());
+                xrefs += 1;
+                current = xref.next_to();
+            }
+        }
+        xrefs
+    });
+
+    bench(&mut group, "strings", || idb.strings().iter().count());
+
+    bench(&mut group, "names", || idb.names().iter().count());
+
+    bench(&mut group, "types", || {
+        let types = idb.types();
+        (1..=types.len() as u32)
+            .filter_map(|i| types.get_by_index(i))
+            .filter_map(|t| t.name())
+            .count()
+    });
+
+    group.finish();
+
+    if !idb.decompiler_available() {
+        println!("decompiler not available; skipping decompiler benchmarks");
+        return;
+    }
+
+    let functions = starts
+        .iter()
+        .take(DECOMPILE_LIMIT)
+        .filter_map(|ea| idb.function_at(*ea))
+        .collect::<Vec<_>>();
+
+    let mut group = c.benchmark_group("decompiler");
+    group.sample_size(OPEN_SAMPLES);
+
+    bench(&mut group, "decompile", || {
+        for f in &functions {
+            black_box(idb.decompile(f).expect("decompile"));
+        }
+        functions.len()
+    });
+
+    let decompiled = functions
+        .iter()
+        .map(|f| idb.decompile(f).expect("decompile"))
+        .collect::<Vec<_>>();
+
+    bench(&mut group, "pseudocode", || {
+        decompiled.iter().map(|cf| cf.pseudocode().len()).sum()
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, open, database);
+criterion_main!(benches);
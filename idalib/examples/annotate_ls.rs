@@ -0,0 +1,52 @@
+use idalib::annotations::{AnnotationStatus, Annotations};
+use idalib::func::NameFlags;
+use idalib::idb::IDB;
+use idalib::types::TypeFlags;
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database
+    let mut idb = IDB::open("./tests/ls")?;
+
+    let starts = idb
+        .functions()
+        .take(64)
+        .map(|(_, f)| f.start_address())
+        .collect::<Vec<_>>();
+
+    let mut batch = Annotations::with_capacity(starts.len() * 3 + 1);
+    for (i, ea) in starts.iter().enumerate().rev() {
+        batch
+            .set_name(*ea, format!("annotated_{i}"), NameFlags::NOWARN)
+            .set_comment(*ea, format!("function {i}"), false)
+            .bookmark(*ea, format!("bookmark {i}"));
+    }
+    batch.apply_type_decl(starts[0], "int annotated_0(void);", TypeFlags::DEFINITE);
+    batch.set_comment(starts[0], "bad\0comment", false);
+
+    println!("Testing apply_annotations():");
+    let report = idb.apply_annotations(&batch);
+
+    println!(
+        "\t{} operations, {} applied, {} failed",
+        report.len(),
+        report.applied(),
+        report.failed()
+    );
+    for (i, ea, status) in report.failures() {
+        println!("\t#{i} at {ea:#x}: {status:?}");
+    }
+
+    assert_eq!(
+        report.status(report.len() - 1),
+        Some(AnnotationStatus::Invalid)
+    );
+    assert_eq!(
+        idb.function_at(starts[0]).and_then(|f| f.name()).as_deref(),
+        Some("annotated_0")
+    );
+    assert_eq!(idb.get_cmt(starts[0]).as_deref(), Some("function 0"));
+
+    Ok(())
+}
@@ -0,0 +1,55 @@
+use std::ops::ControlFlow;
+use std::time::Duration;
+
+use idalib::IDBOpenOptions;
+use idalib::auto::{AutoBudget, AutoCancel};
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database without waiting for auto-analysis
+    let mut idb = IDBOpenOptions::new()
+        .auto_analyse(false)
+        .open("./tests/ls")?;
+
+    println!("Testing auto_queue_depths():");
+    for depth in idb.auto_queue_depths(10_000) {
+        println!(
+            "\t{:?}: {}{} pending from {:#x}",
+            depth.queue,
+            depth.pending,
+            if depth.saturated { "+" } else { "" },
+            depth.next
+        );
+    }
+
+    println!("Testing auto_step():");
+    let progress = idb.auto_step(AutoBudget::steps(1000));
+    println!(
+        "\t{} steps in {:?}, last {:?} at {:?}",
+        progress.steps, progress.elapsed, progress.queue, progress.address
+    );
+    println!("\t{} functions analysed", idb.analysed_functions().count());
+
+    println!("Testing auto_run():");
+    let cancel = AutoCancel::new();
+    let progress = idb.auto_run(
+        AutoBudget::time(Duration::from_secs(60)),
+        &cancel,
+        |idb, p| {
+            println!(
+                "\t{} steps, {} functions analysed",
+                p.steps,
+                idb.analysed_functions().count()
+            );
+            ControlFlow::Continue(())
+        },
+    );
+
+    for stage in &progress.stages {
+        println!("\t{:?}: {:?}", stage.queue, stage.elapsed);
+    }
+    println!("\tdone: {}", progress.done);
+
+    Ok(())
+}
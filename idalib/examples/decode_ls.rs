@@ -0,0 +1,37 @@
+use idalib::idb::IDB;
+use idalib::insn::DecodeMode;
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database
+    let idb = IDB::open("./tests/ls")?;
+
+    println!("Testing Function::decode():");
+    for (_, f) in idb.functions().take(16) {
+        let batch = f.decode()?;
+
+        for insn in batch.iter() {
+            let expected = idb.insn_at(insn.address()).unwrap();
+            assert_eq!(insn.itype(), expected.itype());
+            assert_eq!(insn.len(), expected.len());
+            assert_eq!(insn.operand_count(), expected.operand_count());
+        }
+
+        println!(
+            "\t{:#x}\t{} instructions, {} operands",
+            f.start_address(),
+            batch.len(),
+            batch.operand_types().len()
+        );
+    }
+
+    println!("Testing decode_segments():");
+    for mode in [DecodeMode::Code, DecodeMode::Linear] {
+        for batch in idb.decode_segments(mode) {
+            println!("\t{mode:?}\t{} instructions", batch.len());
+        }
+    }
+
+    Ok(())
+}
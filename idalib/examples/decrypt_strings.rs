@@ -1,6 +1,7 @@
 // tested samples:
 // e8cdc0697748e702cf2916a2c5670325a891402ee38c98d91873a0f03e3f9025
 
+use idalib::bytes::Patches;
 use idalib::idb::*;
 use idalib::insn::x86::{NN_lea, NN_mov};
 use idalib::insn::OperandType;
@@ -117,7 +118,7 @@ fn handle_xref(idb: &IDB, xref: &XRef) -> Option<EncString> {
 }
 
 fn main() -> anyhow::Result<()> {
-    let idb =
+    let mut idb =
         IDB::open("./tests/e8cdc0697748e702cf2916a2c5670325a891402ee38c98d91873a0f03e3f9025")?;
 
     let address = 0x180002A54; // address of DecryptString() function
@@ -125,12 +126,17 @@ fn main() -> anyhow::Result<()> {
         .first_xref_to(address, XRefQuery::ALL)
         .ok_or_else(|| anyhow::anyhow!("no xrefs to {address:#x}"))?;
 
+    // write the decrypted strings back over their encrypted bytes in one batch
+    let mut patches = Patches::new();
+
     loop {
         if let Some(enc_string) = handle_xref(&idb, &current) {
-            println!(
-                "found encrypted string: {enc_string:#?}, decrypted: {:#?}",
-                enc_string.decrypt(&idb)
-            );
+            let decrypted = enc_string.decrypt(&idb);
+            println!("found encrypted string: {enc_string:#?}, decrypted: {decrypted:#?}");
+
+            if let (Some(addr), Some(dec)) = (enc_string.address, decrypted) {
+                patches.add(addr, dec.as_bytes()).add(addr + dec.len() as u64, &[0]);
+            }
         }
 
         match current.next_to() {
@@ -139,5 +145,15 @@ fn main() -> anyhow::Result<()> {
         }
     }
 
+    let report = idb.apply_patches(&patches);
+    println!(
+        "patched {} bytes in {} ranges ({} skipped); {} heads in {} functions invalidated",
+        report.written(),
+        report.ranges().len(),
+        report.skipped(),
+        report.heads().len(),
+        report.functions().len()
+    );
+
     Ok(())
 }
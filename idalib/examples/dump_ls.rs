@@ -20,6 +20,23 @@ fn main() -> anyhow::Result<()> {
     println!("filetype: {:?}", idb.meta().filetype());
     println!("procname: {}", idb.meta().procname());
 
+    let processor = idb.processor();
+    if let Some(ranges) = idb
+        .register_by_name("ds")
+        .and_then(|reg| processor.sreg_ranges(reg))
+    {
+        println!("ds ranges: {}", ranges.len());
+        for range in ranges.iter() {
+            assert_eq!(ranges.value_at(range.start), range.value);
+        }
+    }
+    assert!(processor.thumb_ranges().is_none());
+
+    let meta = idb.meta_snapshot();
+    assert_eq!(meta.procname(), idb.meta().procname());
+    assert_eq!(meta.min_address(), idb.meta().min_address());
+    assert_eq!(meta.input_file_sha256(), idb.meta().input_file_sha256());
+
     println!("segments: {}", idb.segment_count());
 
     for (sid, s) in idb.segments() {
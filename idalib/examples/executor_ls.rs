@@ -0,0 +1,110 @@
+use std::future::Future;
+use std::pin::pin;
+use std::sync::Arc;
+use std::task::{Context, Poll, Wake};
+use std::thread::{self, Thread};
+
+use idalib::executor::{Executor, ExecutorOptions};
+use idalib::idb::IDB;
+
+const CLIENTS: usize = 8;
+const QUERIES: usize = 64;
+
+// A minimal stand-in for an async runtime's `block_on`
+struct Unpark(Thread);
+
+impl Wake for Unpark {
+    fn wake(self: Arc<Self>) {
+        self.0.unpark();
+    }
+}
+
+fn block_on<F: Future>(future: F) -> F::Output {
+    let waker = Arc::new(Unpark(thread::current())).into();
+    let mut cx = Context::from_waker(&waker);
+    let mut future = pin!(future);
+
+    loop {
+        if let Poll::Ready(output) = future.as_mut().poll(&mut cx) {
+            return output;
+        }
+        thread::park();
+    }
+}
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database; the kernel must be driven from the main thread
+    let mut idb = IDB::open("./tests/ls")?;
+    let functions = idb.function_count();
+
+    let mut options = ExecutorOptions::new();
+    options.capacity(16);
+
+    let executor = Executor::new(&options);
+    let handle = executor.handle();
+
+    println!("Testing concurrent clients:");
+    let service = thread::spawn(move || -> anyhow::Result<usize> {
+        let clients = (0..CLIENTS)
+            .map(|client| {
+                let handle = handle.clone();
+                thread::spawn(move || -> anyhow::Result<usize> {
+                    let mut named = 0;
+                    for i in (client..functions).step_by(CLIENTS).take(QUERIES) {
+                        let query = move |idb: &mut IDB| {
+                            idb.function_by_id(i).and_then(|f| f.name()).is_some()
+                        };
+
+                        // Alternate between the blocking and async interfaces
+                        let is_named = if i % 2 == 0 {
+                            handle.submit(query)?.wait()?
+                        } else {
+                            block_on(handle.run(query))?
+                        };
+                        named += is_named as usize;
+                    }
+                    Ok(named)
+                })
+            })
+            .collect::<Vec<_>>();
+
+        let mut named = 0;
+        for client in clients {
+            named += client.join().expect("client panicked")?;
+        }
+
+        // A panicking job is reported to its caller and the executor carries on
+        assert!(
+            handle
+                .submit(|_| -> usize { panic!("job failed") })?
+                .wait()
+                .is_err()
+        );
+        assert_eq!(
+            handle.submit(|idb| idb.function_count())?.wait()?,
+            functions
+        );
+
+        Ok(named)
+    });
+
+    // Serve until the service drops its last handle
+    executor.serve(&mut idb);
+    let named = service.join().expect("service panicked")?;
+
+    let stats = executor.stats();
+    println!(
+        "\t{named} named; {} jobs in {} batches ({:.1} per batch, peak queue {}), mean queue wait {:?}",
+        stats.completed(),
+        stats.batches(),
+        stats.mean_batch(),
+        stats.peak_queued(),
+        stats.mean_queue_wait()
+    );
+    assert_eq!(stats.completed(), stats.submitted());
+    assert_eq!(stats.panicked(), 1);
+
+    Ok(())
+}
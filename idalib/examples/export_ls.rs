@@ -0,0 +1,52 @@
+use std::fs::File;
+use std::io::BufWriter;
+
+use idalib::export::{ExportOptions, ExportTable};
+use idalib::idb::IDB;
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database
+    let idb = IDB::open("./tests/ls")?;
+
+    let dir = std::env::temp_dir().join("idalib-export-ls");
+    std::fs::create_dir_all(&dir)?;
+
+    println!("Testing export_table():");
+    let mut options = ExportOptions::new();
+    options.batch_rows(4096);
+
+    for table in ExportTable::ALL {
+        let path = dir.join(format!("{}.arrows", table.name()));
+        let out = BufWriter::new(File::create(&path)?);
+
+        let stats = idb.export_table(table, &options, out)?;
+        assert_eq!(stats.bytes(), std::fs::metadata(&path)?.len());
+
+        println!(
+            "\t{}\t{} rows in {} batches, {} bytes",
+            table.name(),
+            stats.rows(),
+            stats.batches(),
+            stats.bytes()
+        );
+    }
+
+    println!("Testing column selection:");
+    options.columns(["address", "name"]);
+
+    let mut out = Vec::new();
+    let stats = idb.export_table(ExportTable::Functions, &options, &mut out)?;
+    assert_eq!(stats.rows(), idb.function_count() as u64);
+    assert_eq!(stats.bytes(), out.len() as u64);
+    println!("\tfunctions(address, name)\t{} bytes", out.len());
+
+    options.columns(["address", "missing"]);
+    assert!(
+        idb.export_table(ExportTable::Functions, &options, Vec::new())
+            .is_err()
+    );
+
+    Ok(())
+}
@@ -0,0 +1,65 @@
+use idalib::features::{Feature, FeatureOptions};
+use idalib::func::FunctionCFGFlags;
+use idalib::idb::IDB;
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database
+    let idb = IDB::open("./tests/ls")?;
+
+    let options = FeatureOptions::new();
+    let features = idb.function_features(&options);
+
+    assert_eq!(features.len(), idb.function_count());
+    assert_eq!(features.dimensions(), options.dimensions());
+    assert_eq!(
+        features.vectors().len(),
+        features.len() * features.dimensions()
+    );
+
+    println!("Testing function_features():");
+    for (row, start) in features.addresses().iter().take(16).enumerate() {
+        let f = idb.function_at(*start).unwrap();
+        let blocks = f.cfg_with(FunctionCFGFlags::NOEXT)?.blocks_count();
+
+        assert_eq!(
+            features.feature(row, Feature::BasicBlocks),
+            Some(blocks as f32)
+        );
+        let similarity = if features.token_count(row) > Some(0) {
+            1.0
+        } else {
+            0.0
+        };
+        assert_eq!(features.minhash_similarity(row, row), Some(similarity));
+
+        println!(
+            "\t{start:#x}\t{} instructions, {} blocks, {} calls, simhash {:016x}",
+            features.feature(row, Feature::Instructions).unwrap(),
+            blocks,
+            features.feature(row, Feature::Calls).unwrap(),
+            features.simhash(row).unwrap(),
+        );
+    }
+
+    println!("Testing function_features_of():");
+    let subset = features
+        .addresses()
+        .iter()
+        .rev()
+        .take(4)
+        .copied()
+        .collect::<Vec<_>>();
+    let some = idb.function_features_of(&subset, &options);
+
+    assert_eq!(some.addresses(), subset.as_slice());
+    for (row, start) in subset.iter().enumerate() {
+        let all = features.position(*start).unwrap();
+        assert_eq!(some.vector(row), features.vector(all));
+        assert_eq!(some.minhash(row), features.minhash(all));
+        assert_eq!(some.token_count(row), features.token_count(all));
+    }
+
+    Ok(())
+}
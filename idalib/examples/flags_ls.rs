@@ -0,0 +1,44 @@
+use idalib::flags::{ByteClass, SpanKind};
+use idalib::idb::IDB;
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database
+    let idb = IDB::open("./tests/ls")?;
+
+    println!("Testing segment_flags_maps():");
+    let maps = idb.segment_flags_maps(true);
+
+    for map in &maps {
+        println!(
+            "\t{:#x}-{:#x}: {} code, {} data, {} heads, {} unexplored bytes; {} spans",
+            map.start_address(),
+            map.end_address(),
+            map.count(ByteClass::Code),
+            map.count(ByteClass::Data),
+            map.count(ByteClass::Head),
+            map.count(ByteClass::Unknown),
+            map.span_count()
+        );
+
+        // Check the bitmaps agree with per-address flags
+        for ea in (map.start_address()..map.end_address()).step_by(97) {
+            let flags = idb.flags_at(ea);
+            assert_eq!(map.contains(ByteClass::Code, ea), flags.is_code());
+            assert_eq!(map.contains(ByteClass::Data, ea), flags.is_data());
+        }
+
+        // Every byte is either part of an item or unexplored
+        let mut covered = map.bitmap(ByteClass::Head);
+        covered
+            .or(&map.bitmap(ByteClass::Tail))
+            .or(&map.bitmap(ByteClass::Unknown));
+        assert_eq!(covered.count_ones(), map.len());
+
+        let code_spans = map.spans().filter(|s| s.kind == SpanKind::Code).count();
+        assert!(code_spans as u64 <= map.count(ByteClass::Head));
+    }
+
+    Ok(())
+}
@@ -1,8 +1,14 @@
+use idalib::license::{license_state, refresh_license};
 use idalib::{is_valid_license, license_id};
 
 fn main() -> anyhow::Result<()> {
     if !is_valid_license() {
-        println!("invalid license!");
+        let state = license_state();
+        println!(
+            "invalid license! (borrow result: {:?}, error: {:?})",
+            state.borrow_result(),
+            state.error()
+        );
         return Ok(());
     }
 
@@ -10,5 +16,18 @@ fn main() -> anyhow::Result<()> {
 
     println!("license: {id}");
 
+    // Later checks reuse the cached state until it expires
+    let state = license_state();
+    println!(
+        "cached: {:?} (borrowed: {}, expires: {:?})",
+        state.id(),
+        state.was_borrowed(),
+        state.expires_at().map(|at| at - state.checked_at())
+    );
+    assert_eq!(state.id(), Some(id));
+
+    let state = refresh_license();
+    println!("refreshed: {:?}", state.id());
+
     Ok(())
 }
@@ -0,0 +1,55 @@
+use idalib::idb::{DatabasePacking, IDBOpenOptions};
+use idalib::memory::MemoryUsage;
+
+fn report(when: &str, usage: &MemoryUsage) {
+    let mib = |bytes: Option<u64>| bytes.map(|b| b as f64 / (1 << 20) as f64);
+    println!(
+        "\t{when:<16} rss {:?} MiB, peak {:?} MiB, database {:.2} MiB in {} files (in memory: {}), total {:?} MiB",
+        mib(usage.resident),
+        mib(usage.peak_resident),
+        usage.database_size() as f64 / (1 << 20) as f64,
+        usage.database_files.len(),
+        usage.database_in_memory,
+        mib(usage.total())
+    );
+}
+
+fn main() -> anyhow::Result<()> {
+    // Unpack the database somewhere disposable; on Linux, /dev/shm keeps
+    // it in memory
+    let work_dir = std::env::temp_dir().join(format!("idalib-memory-{}", std::process::id()));
+    std::fs::create_dir_all(&work_dir)?;
+
+    println!("Trying to open IDA database in {}...", work_dir.display());
+
+    let idb = IDBOpenOptions::new()
+        .work_dir(&work_dir)
+        .packing(DatabasePacking::Compressed)
+        .page_size(8192)
+        .auto_analyse(false)
+        .open("./tests/ls")?;
+
+    let database = idb.database_path();
+    println!("Database path: {database:?}");
+    assert!(database.is_some_and(|path| path.starts_with(&work_dir)));
+
+    println!("Testing memory_usage():");
+    report("opened", &idb.memory_usage());
+
+    let mut idb = idb;
+    idb.auto_wait();
+
+    let usage = idb.memory_usage();
+    report("analysed", &usage);
+    assert!(
+        usage
+            .database_files
+            .iter()
+            .all(|(path, _)| path.starts_with(&work_dir))
+    );
+
+    drop(idb);
+    std::fs::remove_dir_all(&work_dir)?;
+
+    Ok(())
+}
@@ -0,0 +1,64 @@
+use idalib::idb::IDB;
+use idalib::microcode::{MOperandKind, Maturity};
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database
+    let idb = IDB::open("./tests/ls")?;
+
+    if !idb.decompiler_available() {
+        println!("decompiler not available; skipping");
+        return Ok(());
+    }
+
+    println!("Testing microcode():");
+    for (_, f) in idb.functions().take(16) {
+        let mc = match idb.microcode(&f, Maturity::LocalOpt) {
+            Ok(mc) => mc,
+            Err(e) => {
+                println!("\t{:#x}: {e}", f.start_address());
+                continue;
+            }
+        };
+
+        println!(
+            "\t{:#x}: {:?}, {} blocks, {} insns, {} operands",
+            f.start_address(),
+            mc.maturity(),
+            mc.block_count(),
+            mc.insn_count(),
+            mc.operand_count()
+        );
+
+        // Blocks partition the instructions, and edges point both ways
+        let mut next = 0;
+        for block in mc.blocks() {
+            let range = block.insn_range();
+            assert_eq!(range.start, next);
+            next = range.end;
+
+            for insn in range.map(|id| mc.insn(id).unwrap()) {
+                assert_eq!(insn.block(), block.id());
+            }
+
+            for succ in block.succs() {
+                let succ = mc.block(*succ as usize).unwrap();
+                assert!(succ.preds().contains(&(block.id() as u32)));
+            }
+        }
+        assert_eq!(next, mc.insn_count());
+
+        // Operands refer back to their instruction, and nested instructions
+        // to the instruction holding them
+        for op in mc.operands() {
+            assert!(op.insn() < mc.insn_count());
+            if let Some(sub) = op.sub_insn() {
+                assert_eq!(op.kind(), MOperandKind::Insn);
+                assert_eq!(sub.parent(), Some(op.insn()));
+            }
+        }
+    }
+
+    Ok(())
+}
@@ -35,5 +35,22 @@ fn main() -> anyhow::Result<()> {
         );
     }
 
+    println!("\nTesting snapshot():");
+    let snapshot = idb.names().snapshot();
+    assert_eq!(snapshot.len(), idb.names().iter().count());
+    for name in idb.names().iter() {
+        let entry = snapshot.get_by_address(name.address()).unwrap();
+        assert_eq!(entry.name(), name.name());
+        assert_eq!(entry.is_public(), name.is_public());
+
+        let closest = idb
+            .names()
+            .get_closest_by_address(name.address() + 1)
+            .unwrap();
+        let (entry, offset) = snapshot.symbolize(name.address() + 1).unwrap();
+        assert_eq!(entry.address(), closest.address());
+        println!("\t{:#x}\t{}+{offset:#x}", name.address() + 1, entry.name());
+    }
+
     Ok(())
 }
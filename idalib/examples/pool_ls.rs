@@ -0,0 +1,42 @@
+use idalib::pool::{self, Job, WorkerPool};
+
+fn main() -> anyhow::Result<()> {
+    if pool::is_worker() {
+        // Each job reports the number of functions in its database
+        pool::run_worker(|idb, _query| Ok((idb.function_count() as u64).to_le_bytes().to_vec()))?;
+        return Ok(());
+    }
+
+    println!("Starting worker pool...");
+    let mut pool = WorkerPool::spawn(2)?;
+
+    let jobs = (0..4).map(|_| Job::new("./tests/ls", Vec::new()));
+
+    println!("Testing WorkerPool::run():");
+    for result in pool.run(jobs) {
+        match result.result {
+            Ok(out) => {
+                let count = u64::from_le_bytes(out[..8].try_into()?);
+                println!(
+                    "\tjob {} on worker {}: {count} functions in {:?}",
+                    result.job, result.worker, result.elapsed
+                );
+            }
+            Err(e) => println!("\tjob {} on worker {}: {e}", result.job, result.worker),
+        }
+    }
+
+    println!("Worker statistics:");
+    for (i, stats) in pool.stats().iter().enumerate() {
+        println!(
+            "\tworker {i}: {} jobs, {} failures, {} restarts, busy {:?}, {:.2} jobs/s",
+            stats.jobs(),
+            stats.failures(),
+            stats.restarts(),
+            stats.busy(),
+            stats.throughput()
+        );
+    }
+
+    Ok(())
+}
@@ -0,0 +1,34 @@
+use idalib::IDBOpenOptions;
+use idalib::template::IDBTemplateCache;
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    println!("Testing open_profiled():");
+    let (idb, profile) = IDBOpenOptions::new().open_profiled("./tests/ls")?;
+    println!("\tlibrary init:  {:?}", profile.library_init);
+    println!("\tloader:        {:?}", profile.loader);
+    println!("\tinit database: {:?}", profile.init_database);
+    for stage in &profile.auto_analysis {
+        println!(
+            "\t{:?}: {:?} ({} steps)",
+            stage.queue, stage.elapsed, stage.steps
+        );
+    }
+    println!("\ttotal:         {:?}", profile.total);
+    drop(idb);
+
+    println!("Testing IDBTemplateCache::open():");
+    let cache = IDBTemplateCache::new(std::env::temp_dir().join("idalib-templates"))?;
+    for _ in 0..2 {
+        let (idb, profile) = cache.open("./tests/ls", &IDBOpenOptions::new())?;
+        println!(
+            "\t{:?}: {} functions in {:?}",
+            profile.template,
+            idb.function_count(),
+            profile.total
+        );
+    }
+
+    Ok(())
+}
@@ -0,0 +1,26 @@
+use idalib::idb::IDB;
+use idalib::scan::{BytePattern, PatternSet};
+
+fn main() -> anyhow::Result<()> {
+    println!("Trying to open IDA database...");
+
+    // Open IDA database
+    let idb = IDB::open("./tests/ls")?;
+
+    let mut set = PatternSet::new();
+    // endbr64
+    set.add(BytePattern::parse("f3 0f 1e fa")?);
+    // push rbp; mov rbp, rsp
+    set.add(BytePattern::parse("55 48 89 e5")?);
+    // lea reg, [rip+disp32]
+    set.add(BytePattern::parse("48 8d ?5 ?? ?? ?? ??")?);
+
+    println!("Testing scan_patterns():");
+    let hits = idb.scan_patterns(&set)?;
+    for i in 0..set.len() {
+        let count = hits.iter().filter(|hit| hit.pattern == i).count();
+        println!("\t{:?}\t{count} hits", set.get(i).unwrap().bytes());
+    }
+
+    Ok(())
+}
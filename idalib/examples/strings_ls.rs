@@ -41,5 +41,18 @@ fn main() -> anyhow::Result<()> {
         */
     }
 
+    println!("\nTesting snapshot:");
+    let snapshot = idb.strings().snapshot()?;
+    for entry in snapshot.iter() {
+        assert_eq!(
+            Some(entry.address()),
+            idb.strings().get_address_by_index(entry.index())
+        );
+        assert_eq!(
+            Some(entry.to_string_lossy().into_owned()),
+            idb.strings().get_by_index(entry.index())
+        );
+    }
+
     Ok(())
 }
@@ -35,6 +35,21 @@ fn main() -> anyhow::Result<()> {
         }
     }
 
+    // Test type list snapshot
+    println!("\nTesting type snapshot (first 5):");
+    let snapshot = types.snapshot_with(true, true);
+    assert_eq!(snapshot.len(), types.iter().count());
+    for entry in snapshot.iter().take(5) {
+        println!(
+            "  Snapshot type ordinal {}: {} ({:?}, {:?} bytes, {} type bytes)",
+            entry.ordinal(),
+            entry.name(),
+            entry.kind(),
+            entry.size(),
+            entry.type_string().map(<[u8]>::len).unwrap_or_default()
+        );
+    }
+
     // Test type assignment functionality
     println!("\nTesting type assignment...");
 
@@ -0,0 +1,242 @@
+use crate::ffi::annotations::{annotation_op_t, idalib_apply_annotations};
+
+use crate::Address;
+use crate::bookmarks::{BOOKMARKS_BAD_INDEX, BookmarkIndex};
+use crate::func::NameFlags;
+use crate::types::{Type, TypeFlags, TypeIndex};
+
+const KIND_NAME: u8 = 0;
+const KIND_COMMENT: u8 = 1;
+const KIND_APPEND_COMMENT: u8 = 2;
+const KIND_FUNC_COMMENT: u8 = 3;
+const KIND_TYPE_DECL: u8 = 4;
+const KIND_TYPE_ORDINAL: u8 = 5;
+const KIND_BOOKMARK: u8 = 6;
+// Never applied; marks operations whose text cannot be passed to IDA
+const KIND_INVALID: u8 = u8::MAX;
+
+/// A batch of renames, comments, type applications and bookmarks, applied
+/// together by `IDB::apply_annotations`.
+///
+/// Operations are only staged here: all strings are packed into a single
+/// buffer and the whole batch crosses the FFI in one call.
+#[derive(Debug, Clone, Default)]
+pub struct Annotations {
+    ops: Vec<annotation_op_t>,
+    text: Vec<u8>,
+}
+
+impl Annotations {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn with_capacity(ops: usize) -> Self {
+        Self {
+            ops: Vec::with_capacity(ops),
+            text: Vec::with_capacity(ops * 16),
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.ops.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.ops.is_empty()
+    }
+
+    pub fn clear(&mut self) {
+        self.ops.clear();
+        self.text.clear();
+    }
+
+    pub fn set_name(&mut self, ea: Address, name: impl AsRef<str>, flags: NameFlags) -> &mut Self {
+        self.push(KIND_NAME, ea, flags.bits(), 0, name.as_ref())
+    }
+
+    pub fn set_comment(
+        &mut self,
+        ea: Address,
+        comment: impl AsRef<str>,
+        repeatable: bool,
+    ) -> &mut Self {
+        self.push(KIND_COMMENT, ea, repeatable as i32, 0, comment.as_ref())
+    }
+
+    pub fn append_comment(
+        &mut self,
+        ea: Address,
+        comment: impl AsRef<str>,
+        repeatable: bool,
+    ) -> &mut Self {
+        self.push(
+            KIND_APPEND_COMMENT,
+            ea,
+            repeatable as i32,
+            0,
+            comment.as_ref(),
+        )
+    }
+
+    /// Set the comment of the function containing `ea`.
+    pub fn set_function_comment(
+        &mut self,
+        ea: Address,
+        comment: impl AsRef<str>,
+        repeatable: bool,
+    ) -> &mut Self {
+        self.push(
+            KIND_FUNC_COMMENT,
+            ea,
+            repeatable as i32,
+            0,
+            comment.as_ref(),
+        )
+    }
+
+    /// Parse the C declaration `decl` and apply it at `ea`.
+    pub fn apply_type_decl(
+        &mut self,
+        ea: Address,
+        decl: impl AsRef<str>,
+        flags: TypeFlags,
+    ) -> &mut Self {
+        self.push(KIND_TYPE_DECL, ea, flags as i32, 0, decl.as_ref())
+    }
+
+    pub fn apply_type(&mut self, ea: Address, ty: &Type, flags: TypeFlags) -> &mut Self {
+        self.apply_type_ordinal(ea, ty.ordinal(), flags)
+    }
+
+    pub fn apply_type_ordinal(
+        &mut self,
+        ea: Address,
+        ordinal: TypeIndex,
+        flags: TypeFlags,
+    ) -> &mut Self {
+        self.push(KIND_TYPE_ORDINAL, ea, flags as i32, ordinal, "")
+    }
+
+    /// Add a bookmark at `ea` in the next free slot.
+    pub fn bookmark(&mut self, ea: Address, desc: impl AsRef<str>) -> &mut Self {
+        self.bookmark_with(ea, BOOKMARKS_BAD_INDEX, desc)
+    }
+
+    pub fn bookmark_with(
+        &mut self,
+        ea: Address,
+        idx: BookmarkIndex,
+        desc: impl AsRef<str>,
+    ) -> &mut Self {
+        self.push(KIND_BOOKMARK, ea, 0, idx, desc.as_ref())
+    }
+
+    pub(crate) fn raw(&self) -> (&[annotation_op_t], &[u8]) {
+        (&self.ops, &self.text)
+    }
+
+    fn push(&mut self, kind: u8, ea: Address, flags: i32, value: u32, text: &str) -> &mut Self {
+        // NOTE: strings are passed NUL-terminated, so ones with interior NULs
+        // are reported as invalid rather than silently truncated
+        let kind = if text.contains('\0') {
+            KIND_INVALID
+        } else {
+            kind
+        };
+
+        self.ops.push(annotation_op_t {
+            ea,
+            kind,
+            flags,
+            value,
+            text: self.text.len() as u32,
+        });
+
+        self.text.extend_from_slice(text.as_bytes());
+        self.text.push(0);
+
+        self
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum AnnotationStatus {
+    Applied,
+    /// IDA rejected the operation (e.g., a name already in use, a
+    /// declaration that does not parse, or no function at the address).
+    Failed,
+    /// The operation could not be passed to IDA (e.g., its text contains a
+    /// NUL byte).
+    Invalid,
+}
+
+impl AnnotationStatus {
+    fn from_raw(raw: u8) -> Self {
+        match raw {
+            0 => Self::Applied,
+            1 => Self::Failed,
+            _ => Self::Invalid,
+        }
+    }
+}
+
+/// The outcome of each operation of an `Annotations` batch, in the order
+/// the operations were added.
+#[derive(Debug, Clone)]
+pub struct AnnotationReport {
+    statuses: Vec<u8>,
+    addresses: Vec<Address>,
+    applied: usize,
+}
+
+impl AnnotationReport {
+    pub(crate) fn apply(batch: &Annotations) -> Self {
+        let (ops, text) = batch.raw();
+
+        let mut statuses = Vec::with_capacity(ops.len());
+        let applied = unsafe { idalib_apply_annotations(ops, text, &mut statuses) };
+
+        Self {
+            statuses,
+            addresses: ops.iter().map(|op| op.ea).collect(),
+            applied,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.statuses.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.statuses.is_empty()
+    }
+
+    pub fn applied(&self) -> usize {
+        self.applied
+    }
+
+    pub fn failed(&self) -> usize {
+        self.len() - self.applied
+    }
+
+    pub fn is_success(&self) -> bool {
+        self.applied == self.len()
+    }
+
+    pub fn status(&self, index: usize) -> Option<AnnotationStatus> {
+        self.statuses
+            .get(index)
+            .map(|raw| AnnotationStatus::from_raw(*raw))
+    }
+
+    /// The index, address and status of every operation that was not
+    /// applied.
+    pub fn failures(&self) -> impl Iterator<Item = (usize, Address, AnnotationStatus)> + '_ {
+        self.statuses
+            .iter()
+            .enumerate()
+            .map(|(i, raw)| (i, self.addresses[i], AnnotationStatus::from_raw(*raw)))
+            .filter(|(_, _, status)| *status != AnnotationStatus::Applied)
+    }
+}
@@ -0,0 +1,235 @@
+use std::sync::Arc;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::time::Duration;
+
+use crate::Address;
+use crate::ffi::BADADDR;
+use crate::ffi::ida::{auto_queue_depth_t, auto_stage_time_t, auto_step_t};
+
+/// An auto-analysis queue (`atype_t`), in the order the kernel drains them.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum AutoQueue {
+    /// Convert to unexplored
+    Unknown,
+    /// Convert to instruction
+    Code,
+    /// Convert to instruction (IDA decision)
+    Weak,
+    /// Convert to procedure start
+    Proc,
+    /// Add a procedure tail
+    Tail,
+    /// Find function chunks
+    FunctionChunks,
+    /// Reanalyse
+    Used,
+    /// Reanalyse (second pass)
+    Used2,
+    /// Apply type information
+    Type,
+    /// Apply signature to address
+    LibraryFunction,
+    /// Apply signature (second pass)
+    LibraryFunction2,
+    /// Apply signature (third pass)
+    LibraryFunction3,
+    /// Check for library functions
+    CheckLibrary,
+    /// Final pass
+    Final,
+    Other(i32),
+}
+
+impl AutoQueue {
+    pub(crate) fn from_raw(queue: i32) -> Self {
+        match queue {
+            10 => Self::Unknown,
+            20 => Self::Code,
+            25 => Self::Weak,
+            30 => Self::Proc,
+            35 => Self::Tail,
+            38 => Self::FunctionChunks,
+            40 => Self::Used,
+            45 => Self::Used2,
+            50 => Self::Type,
+            60 => Self::LibraryFunction,
+            70 => Self::LibraryFunction2,
+            80 => Self::LibraryFunction3,
+            90 => Self::CheckLibrary,
+            200 => Self::Final,
+            other => Self::Other(other),
+        }
+    }
+
+    pub fn as_raw(&self) -> i32 {
+        match self {
+            Self::Unknown => 10,
+            Self::Code => 20,
+            Self::Weak => 25,
+            Self::Proc => 30,
+            Self::Tail => 35,
+            Self::FunctionChunks => 38,
+            Self::Used => 40,
+            Self::Used2 => 45,
+            Self::Type => 50,
+            Self::LibraryFunction => 60,
+            Self::LibraryFunction2 => 70,
+            Self::LibraryFunction3 => 80,
+            Self::CheckLibrary => 90,
+            Self::Final => 200,
+            Self::Other(other) => *other,
+        }
+    }
+}
+
+/// Time spent processing one auto-analysis queue.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct AutoStageTime {
+    pub queue: AutoQueue,
+    pub elapsed: Duration,
+    /// Number of queue entries processed; the final drain after the queues
+    /// are empty is not counted.
+    pub steps: u64,
+}
+
+impl AutoStageTime {
+    pub(crate) fn from_raw(stage: &auto_stage_time_t) -> Self {
+        Self {
+            queue: AutoQueue::from_raw(stage.queue),
+            elapsed: Duration::from_nanos(stage.nanos),
+            steps: stage.steps,
+        }
+    }
+}
+
+/// Limits for one call to `IDB::auto_step`; the default is unlimited, i.e.,
+/// run analysis to completion.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct AutoBudget {
+    steps: Option<u64>,
+    time: Option<Duration>,
+}
+
+impl AutoBudget {
+    pub fn unlimited() -> Self {
+        Self::default()
+    }
+
+    /// Stop after processing `steps` queue entries.
+    pub fn steps(steps: u64) -> Self {
+        Self::default().with_steps(steps)
+    }
+
+    /// Stop once `time` has elapsed (checked after each step).
+    pub fn time(time: Duration) -> Self {
+        Self::default().with_time(time)
+    }
+
+    pub fn with_steps(mut self, steps: u64) -> Self {
+        self.steps = Some(steps.max(1));
+        self
+    }
+
+    pub fn with_time(mut self, time: Duration) -> Self {
+        self.time = Some(time.max(Duration::from_nanos(1)));
+        self
+    }
+
+    pub fn max_steps(&self) -> Option<u64> {
+        self.steps
+    }
+
+    pub fn max_time(&self) -> Option<Duration> {
+        self.time
+    }
+
+    pub(crate) fn raw_steps(&self) -> u64 {
+        self.steps.unwrap_or(0)
+    }
+
+    pub(crate) fn raw_nanos(&self) -> u64 {
+        self.time
+            .map(|time| time.as_nanos().min(u64::MAX as u128) as u64)
+            .unwrap_or(0)
+    }
+}
+
+/// Progress of auto-analysis, as reported by `IDB::auto_step` and
+/// `IDB::auto_run`.
+#[derive(Debug, Clone, Default)]
+pub struct AutoProgress {
+    /// Queue entries processed.
+    pub steps: u64,
+    pub elapsed: Duration,
+    /// Queue and address of the last entry processed.
+    pub queue: Option<AutoQueue>,
+    pub address: Option<Address>,
+    /// Time spent by queue.
+    pub stages: Vec<AutoStageTime>,
+    /// All queues are empty and analysis has finished.
+    pub done: bool,
+    /// Analysis was stopped early by an `AutoCancel` or the progress
+    /// callback; it can be resumed by stepping again.
+    pub cancelled: bool,
+}
+
+impl AutoProgress {
+    pub(crate) fn update(&mut self, step: &auto_step_t, stages: &[auto_stage_time_t]) {
+        self.steps += step.steps;
+        self.elapsed += Duration::from_nanos(step.nanos);
+        self.done = step.done;
+
+        if step.steps != 0 {
+            self.queue = Some(AutoQueue::from_raw(step.queue));
+            self.address = (step.ea != u64::from(BADADDR)).then_some(step.ea);
+        }
+
+        self.stages = stages.iter().map(AutoStageTime::from_raw).collect();
+    }
+}
+
+/// Number of pending entries in a queue.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct AutoQueueDepth {
+    pub queue: AutoQueue,
+    /// Pending entries, up to the limit passed to `IDB::auto_queue_depths`.
+    pub pending: u64,
+    /// True if counting stopped at the limit.
+    pub saturated: bool,
+    /// Lowest pending address.
+    pub next: Address,
+}
+
+impl AutoQueueDepth {
+    pub(crate) fn from_raw(depth: &auto_queue_depth_t, limit: u64) -> Self {
+        Self {
+            queue: AutoQueue::from_raw(depth.queue),
+            pending: depth.pending,
+            saturated: depth.pending >= limit,
+            next: depth.next,
+        }
+    }
+}
+
+/// A flag that stops `IDB::auto_run` at its next check; it can be set from
+/// any thread.
+#[derive(Debug, Clone, Default)]
+pub struct AutoCancel(Arc<AtomicBool>);
+
+impl AutoCancel {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn cancel(&self) {
+        self.0.store(true, Ordering::Relaxed);
+    }
+
+    pub fn is_cancelled(&self) -> bool {
+        self.0.load(Ordering::Relaxed)
+    }
+
+    pub fn reset(&self) {
+        self.0.store(false, Ordering::Relaxed);
+    }
+}
@@ -12,7 +12,7 @@ use crate::{Address, IDAError};
 
 pub type BookmarkIndex = u32;
 
-const BOOKMARKS_BAD_INDEX: BookmarkIndex = 0xffffffff; // (uint32(-1))
+pub(crate) const BOOKMARKS_BAD_INDEX: BookmarkIndex = 0xffffffff; // (uint32(-1))
 
 pub struct Bookmarks<'a> {
     _marker: PhantomData<&'a IDB>,
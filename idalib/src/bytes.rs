@@ -0,0 +1,359 @@
+use std::marker::PhantomData;
+
+use crate::ffi::bytes::{
+    idalib_get_bytes_into, idalib_patch_ranges, patch_range_t, patch_result_t,
+};
+
+use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
+use crate::{Address, IDAError};
+
+/// Reads `buf.len()` bytes at `ea` into `buf`, returning the number of bytes
+/// read; see `IDB::get_bytes_into`.
+pub(crate) fn read_into(ea: Address, buf: &mut [u8]) -> usize {
+    let _ffi = instrument::scope(Subsystem::Bytes, "read_into");
+    unsafe { idalib_get_bytes_into(ea.into(), buf, &mut []) }.unwrap_or(0)
+}
+
+/// Reads `buf.len()` bytes at `ea` into `buf`, filling `mask` with one bit
+/// per byte (least significant bit first) that is set when the byte has a
+/// value; see `IDB::get_bytes_with_mask`.
+pub(crate) fn read_with_mask(
+    ea: Address,
+    buf: &mut [u8],
+    mask: &mut [u8],
+) -> Result<usize, IDAError> {
+    let _ffi = instrument::scope(Subsystem::Bytes, "read_with_mask");
+    if buf.is_empty() {
+        return Ok(0);
+    }
+
+    if mask.len() < ByteMask::len_for(buf.len()) {
+        return Err(IDAError::ffi_with(format!(
+            "mask of {} bytes is too small for a {} byte buffer",
+            mask.len(),
+            buf.len()
+        )));
+    }
+
+    unsafe { idalib_get_bytes_into(ea.into(), buf, mask) }.map_err(IDAError::ffi)
+}
+
+/// Validity bitmap for a range of bytes, as filled by `get_bytes`.
+#[derive(Debug, Clone, Copy)]
+pub struct ByteMask<'a> {
+    bits: &'a [u8],
+    len: usize,
+}
+
+impl<'a> ByteMask<'a> {
+    /// Number of mask bytes needed to cover `len` data bytes.
+    pub const fn len_for(len: usize) -> usize {
+        len.div_ceil(8)
+    }
+
+    pub fn new(bits: &'a [u8], len: usize) -> Self {
+        debug_assert!(bits.len() >= Self::len_for(len));
+        Self { bits, len }
+    }
+
+    pub fn is_loaded(&self, offset: usize) -> bool {
+        offset < self.len && self.bits[offset / 8] & (1 << (offset % 8)) != 0
+    }
+
+    pub fn all_loaded(&self) -> bool {
+        let full = self.len / 8;
+        let rest = self.len % 8;
+
+        self.bits[..full].iter().all(|b| *b == 0xff)
+            && (rest == 0 || self.bits[full] & ((1 << rest) - 1) == (1 << rest) - 1)
+    }
+
+    pub fn bits(&self) -> &'a [u8] {
+        &self.bits[..Self::len_for(self.len)]
+    }
+
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+}
+
+/// A window of bytes produced by `ByteChunks`.
+#[derive(Debug, Clone, Copy)]
+pub struct ByteChunk<'c> {
+    address: Address,
+    bytes: &'c [u8],
+    mask: ByteMask<'c>,
+}
+
+impl<'c> ByteChunk<'c> {
+    pub fn address(&self) -> Address {
+        self.address
+    }
+
+    pub fn end_address(&self) -> Address {
+        self.address + self.bytes.len() as Address
+    }
+
+    pub fn bytes(&self) -> &'c [u8] {
+        self.bytes
+    }
+
+    pub fn mask(&self) -> ByteMask<'c> {
+        self.mask
+    }
+
+    pub fn len(&self) -> usize {
+        self.bytes.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.bytes.is_empty()
+    }
+}
+
+/// Streams the range `[start, end)` in fixed-size chunks, reusing one data
+/// buffer and one mask buffer for every chunk.
+///
+/// Each chunk borrows from the reader, so this is driven with `next_chunk`
+/// rather than `Iterator`:
+///
+/// ```ignore
+/// let mut chunks = idb.byte_chunks(start, end, 1 << 20);
+/// while let Some(chunk) = chunks.next_chunk()? {
+///     scan(chunk.address(), chunk.bytes(), chunk.mask());
+/// }
+/// ```
+pub struct ByteChunks<'a> {
+    current: Address,
+    end: Address,
+    buf: Vec<u8>,
+    mask: Vec<u8>,
+    _marker: PhantomData<&'a IDB>,
+}
+
+impl<'a> ByteChunks<'a> {
+    pub(crate) fn new(start: Address, end: Address, chunk_size: usize) -> Self {
+        let chunk_size = chunk_size.max(1);
+
+        Self {
+            current: start,
+            end: end.max(start),
+            buf: vec![0u8; chunk_size],
+            mask: vec![0u8; ByteMask::len_for(chunk_size)],
+            _marker: PhantomData,
+        }
+    }
+
+    pub fn chunk_size(&self) -> usize {
+        self.buf.len()
+    }
+
+    /// Address of the next chunk to be read.
+    pub fn position(&self) -> Address {
+        self.current
+    }
+
+    /// Bytes left to read in the range.
+    pub fn remaining(&self) -> u64 {
+        self.end - self.current
+    }
+
+    /// Seek to `ea`, clamped to the end of the range.
+    pub fn seek(&mut self, ea: Address) {
+        self.current = ea.min(self.end);
+    }
+
+    pub fn next_chunk(&mut self) -> Result<Option<ByteChunk<'_>>, IDAError> {
+        if self.current >= self.end {
+            return Ok(None);
+        }
+
+        let size = self.remaining().min(self.buf.len() as u64) as usize;
+        let address = self.current;
+
+        let buf = &mut self.buf[..size];
+        let mask = &mut self.mask[..ByteMask::len_for(size)];
+
+        // NOTE: `get_bytes` may read fewer bytes than requested; anything it
+        // leaves untouched is reported as not loaded.
+        mask.fill(0);
+
+        let read = read_with_mask(address, buf, mask)?;
+        if read < size {
+            buf[read..].fill(0xff);
+        }
+
+        self.current += size as u64;
+
+        Ok(Some(ByteChunk {
+            address,
+            bytes: &self.buf[..size],
+            mask: ByteMask::new(&self.mask, size),
+        }))
+    }
+}
+
+/// How `IDB::apply_patches` writes bytes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default)]
+pub enum PatchMode {
+    /// `patch_bytes`: the original bytes are kept and the change is listed
+    /// in the database's patches.
+    #[default]
+    Patch,
+    /// `put_bytes`: the bytes are overwritten in place.
+    Put,
+}
+
+/// A batch of byte patches, applied together by `IDB::apply_patches`.
+///
+/// The bytes of every patch are packed into one contiguous buffer, so the
+/// whole batch crosses the FFI in a single call.
+#[derive(Debug, Clone)]
+pub struct Patches {
+    ranges: Vec<patch_range_t>,
+    data: Vec<u8>,
+    mode: PatchMode,
+    reanalyze: bool,
+}
+
+impl Default for Patches {
+    fn default() -> Self {
+        Self {
+            ranges: Vec::new(),
+            data: Vec::new(),
+            mode: PatchMode::default(),
+            reanalyze: true,
+        }
+    }
+}
+
+impl Patches {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn with_capacity(ranges: usize, bytes: usize) -> Self {
+        Self {
+            ranges: Vec::with_capacity(ranges),
+            data: Vec::with_capacity(bytes),
+            ..Default::default()
+        }
+    }
+
+    pub fn mode(&mut self, mode: PatchMode) -> &mut Self {
+        self.mode = mode;
+        self
+    }
+
+    /// Queue the patched ranges for reanalysis once the batch has been
+    /// written (default: `true`).
+    pub fn reanalyze(&mut self, value: bool) -> &mut Self {
+        self.reanalyze = value;
+        self
+    }
+
+    pub fn len(&self) -> usize {
+        self.ranges.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.ranges.is_empty()
+    }
+
+    /// Total number of bytes to be written.
+    pub fn size(&self) -> usize {
+        self.data.len()
+    }
+
+    pub fn clear(&mut self) {
+        self.ranges.clear();
+        self.data.clear();
+    }
+
+    /// Write `bytes` at `ea`. Patches are written in the order they are
+    /// added, so where two overlap, the later one wins.
+    pub fn add(&mut self, ea: Address, bytes: &[u8]) -> &mut Self {
+        self.ranges.push(patch_range_t {
+            ea,
+            offset: self.data.len() as u64,
+            size: bytes.len() as u64,
+        });
+        self.data.extend_from_slice(bytes);
+        self
+    }
+
+    pub(crate) fn apply(&self) -> PatchReport {
+        let _ffi = instrument::scope(Subsystem::Bytes, "apply_patches");
+        let mut out = patch_result_t::default();
+
+        unsafe {
+            idalib_patch_ranges(
+                &self.ranges,
+                &self.data,
+                self.mode == PatchMode::Patch,
+                self.reanalyze,
+                &mut out,
+            )
+        };
+
+        PatchReport {
+            written: out.written,
+            applied: out.applied,
+            planned: out.planned,
+            heads: out.heads,
+            functions: out.functions,
+        }
+    }
+}
+
+/// The outcome of `IDB::apply_patches`: which patches were written and
+/// which parts of the database they invalidated.
+#[derive(Debug, Clone)]
+pub struct PatchReport {
+    written: u64,
+    applied: Vec<u8>,
+    planned: Vec<u64>,
+    heads: Vec<u64>,
+    functions: Vec<u64>,
+}
+
+impl PatchReport {
+    /// Number of bytes written.
+    pub fn written(&self) -> u64 {
+        self.written
+    }
+
+    /// Whether the patch at `index` (in the order they were added) was
+    /// written; patches that are empty or not entirely within a segment are
+    /// skipped.
+    pub fn is_applied(&self, index: usize) -> bool {
+        self.applied.get(index).is_some_and(|a| *a != 0)
+    }
+
+    pub fn skipped(&self) -> usize {
+        self.applied.iter().filter(|a| **a == 0).count()
+    }
+
+    /// The written ranges, widened to the items they overlap and merged, as
+    /// `[start, end)` pairs in address order; when reanalysis is enabled,
+    /// each of these is queued once.
+    pub fn ranges(&self) -> impl ExactSizeIterator<Item = (Address, Address)> + '_ {
+        self.planned.chunks_exact(2).map(|r| (r[0], r[1]))
+    }
+
+    /// Item heads within `ranges`, in address order.
+    pub fn heads(&self) -> &[Address] {
+        &self.heads
+    }
+
+    /// Start addresses of the functions owning any of `heads`, in address
+    /// order.
+    pub fn functions(&self) -> &[Address] {
+        &self.functions
+    }
+}
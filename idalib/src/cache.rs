@@ -0,0 +1,77 @@
+use std::collections::HashMap;
+use std::hash::Hash;
+
+/// A small least-recently-used cache.
+///
+/// Eviction scans for the oldest entry, which is cheap for the capacities we
+/// use (tens to a few thousand entries) and keeps lookups to a single hash
+/// probe.
+#[derive(Debug)]
+pub(crate) struct LruCache<K, V> {
+    capacity: usize,
+    tick: u64,
+    entries: HashMap<K, (u64, V)>,
+}
+
+impl<K, V> LruCache<K, V>
+where
+    K: Eq + Hash + Clone,
+{
+    pub(crate) fn new(capacity: usize) -> Self {
+        Self {
+            capacity,
+            tick: 0,
+            entries: HashMap::new(),
+        }
+    }
+
+    pub(crate) fn capacity(&self) -> usize {
+        self.capacity
+    }
+
+    pub(crate) fn set_capacity(&mut self, capacity: usize) {
+        self.capacity = capacity;
+        while self.entries.len() > self.capacity {
+            self.evict();
+        }
+    }
+
+    pub(crate) fn get(&mut self, key: &K) -> Option<&V> {
+        self.tick += 1;
+
+        let (used, value) = self.entries.get_mut(key)?;
+        *used = self.tick;
+
+        Some(value)
+    }
+
+    pub(crate) fn insert(&mut self, key: K, value: V) {
+        if self.capacity == 0 {
+            return;
+        }
+
+        self.tick += 1;
+
+        if !self.entries.contains_key(&key) && self.entries.len() >= self.capacity {
+            self.evict();
+        }
+
+        self.entries.insert(key, (self.tick, value));
+    }
+
+    pub(crate) fn clear(&mut self) {
+        self.entries.clear();
+    }
+
+    fn evict(&mut self) {
+        let oldest = self
+            .entries
+            .iter()
+            .min_by_key(|(_, (used, _))| *used)
+            .map(|(key, _)| key.clone());
+
+        if let Some(key) = oldest {
+            self.entries.remove(&key);
+        }
+    }
+}
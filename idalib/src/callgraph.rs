@@ -0,0 +1,200 @@
+use std::collections::HashSet;
+
+use crate::ffi::func::{call_graph_t, idalib_func_call_graph};
+
+use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
+use crate::Address;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct CallEdge {
+    pub caller: Address,
+    pub callee: Address,
+    pub site: Address,
+}
+
+/// Caller to callee edges for the whole database, one per call site.
+///
+/// Edges are kept sorted by caller, with a secondary index
+/// sorted by callee, so both directions are answered by binary search.
+#[derive(Debug, Clone, Default)]
+pub struct CallGraph {
+    edges: Vec<CallEdge>,
+    by_callee: Vec<u32>,
+    change_count: u32,
+}
+
+impl CallGraph {
+    pub(crate) fn new(idb: &IDB) -> Self {
+        let mut graph = Self {
+            edges: collect_edges(&[]),
+            by_callee: Vec::new(),
+            change_count: idb.meta().database_change_count(),
+        };
+        graph.reindex();
+        graph
+    }
+
+    /// Builds a graph containing only the calls made by `functions`.
+    pub(crate) fn of_functions(idb: &IDB, functions: &[Address]) -> Self {
+        let mut graph = Self {
+            edges: if functions.is_empty() {
+                Vec::new()
+            } else {
+                collect_edges(functions)
+            },
+            by_callee: Vec::new(),
+            change_count: idb.meta().database_change_count(),
+        };
+        graph.reindex();
+        graph
+    }
+
+    /// Orders `functions` so that, where possible, every function comes after
+    /// the functions it calls; cycles are broken at the first function of the
+    /// cycle seen in `functions`.
+    pub fn callees_first(&self, functions: &[Address]) -> Vec<Address> {
+        let wanted = functions.iter().copied().collect::<HashSet<_>>();
+
+        let mut seen = HashSet::with_capacity(functions.len());
+        let mut order = Vec::with_capacity(functions.len());
+        let mut stack = Vec::new();
+
+        for root in functions {
+            if !seen.insert(*root) {
+                continue;
+            }
+
+            stack.push((*root, 0));
+
+            while let Some((node, next)) = stack.last().copied() {
+                let calls = self.calls_from(node);
+
+                if next < calls.len() {
+                    stack.last_mut().expect("non-empty stack").1 += 1;
+
+                    let callee = calls[next].callee;
+                    if wanted.contains(&callee) && seen.insert(callee) {
+                        stack.push((callee, 0));
+                    }
+                } else {
+                    order.push(node);
+                    stack.pop();
+                }
+            }
+        }
+
+        order
+    }
+
+    /// Recomputes the edges of the functions starting at `functions`; use
+    /// this after changing those functions instead of rebuilding the graph.
+    pub fn refresh(&mut self, idb: &IDB, functions: &[Address]) {
+        if functions.is_empty() {
+            return;
+        }
+
+        let stale = functions.iter().copied().collect::<HashSet<_>>();
+
+        self.edges.retain(|edge| !stale.contains(&edge.caller));
+        self.edges.extend(collect_edges(functions));
+        self.change_count = idb.meta().database_change_count();
+        self.reindex();
+    }
+
+    /// Rebuilds the graph from scratch.
+    pub fn rebuild(&mut self, idb: &IDB) {
+        *self = Self::new(idb);
+    }
+
+    /// True if the database has changed since the graph was last built or
+    /// refreshed.
+    pub fn is_stale(&self, idb: &IDB) -> bool {
+        self.change_count != idb.meta().database_change_count()
+    }
+
+    pub fn edges(&self) -> &[CallEdge] {
+        &self.edges
+    }
+
+    pub fn len(&self) -> usize {
+        self.edges.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.edges.is_empty()
+    }
+
+    /// Outgoing call edges of the function starting at `caller`.
+    pub fn calls_from(&self, caller: Address) -> &[CallEdge] {
+        let start = self.edges.partition_point(|edge| edge.caller < caller);
+        let end = self.edges.partition_point(|edge| edge.caller <= caller);
+        &self.edges[start..end]
+    }
+
+    /// Incoming call edges of the function starting at `callee`.
+    pub fn calls_to(&self, callee: Address) -> impl ExactSizeIterator<Item = &CallEdge> + '_ {
+        let start = self
+            .by_callee
+            .partition_point(|i| self.edges[*i as usize].callee < callee);
+        let end = self
+            .by_callee
+            .partition_point(|i| self.edges[*i as usize].callee <= callee);
+
+        self.by_callee[start..end]
+            .iter()
+            .map(|i| &self.edges[*i as usize])
+    }
+
+    /// Distinct callees of `caller`, in address order.
+    pub fn callees(&self, caller: Address) -> Vec<Address> {
+        let mut callees = self
+            .calls_from(caller)
+            .iter()
+            .map(|edge| edge.callee)
+            .collect::<Vec<_>>();
+        callees.sort_unstable();
+        callees.dedup();
+        callees
+    }
+
+    /// Distinct callers of `callee`, in address order.
+    pub fn callers(&self, callee: Address) -> Vec<Address> {
+        let mut callers = self
+            .calls_to(callee)
+            .map(|edge| edge.caller)
+            .collect::<Vec<_>>();
+        callers.dedup();
+        callers
+    }
+
+    fn reindex(&mut self) {
+        self.edges.sort_unstable();
+        self.edges.dedup();
+
+        let mut by_callee = (0..self.edges.len() as u32).collect::<Vec<_>>();
+        by_callee.sort_by_key(|i| {
+            let edge = &self.edges[*i as usize];
+            (edge.callee, edge.caller, edge.site)
+        });
+        self.by_callee = by_callee;
+    }
+}
+
+fn collect_edges(functions: &[Address]) -> Vec<CallEdge> {
+    let _ffi = instrument::scope(Subsystem::Funcs, "call_graph");
+    let mut graph = call_graph_t::default();
+    unsafe { idalib_func_call_graph(functions, &mut graph) };
+
+    graph
+        .callers
+        .iter()
+        .zip(graph.callees.iter())
+        .zip(graph.sites.iter())
+        .map(|((caller, callee), site)| CallEdge {
+            caller: *caller,
+            callee: *callee,
+            site: *site,
+        })
+        .collect()
+}
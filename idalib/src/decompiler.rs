@@ -1,11 +1,22 @@
+use std::cmp::Reverse;
+use std::collections::HashMap;
 use std::marker::PhantomData;
+use std::ops::Range;
+use std::time::{Duration, Instant};
 
+use crate::Address;
+use crate::callgraph::CallGraph;
 use crate::ffi::hexrays::{
-    cblock_iter, cblock_t, cfunc_t, cfuncptr_t, cinsn_t, idalib_hexrays_cblock_iter,
-    idalib_hexrays_cblock_iter_next, idalib_hexrays_cblock_len, idalib_hexrays_cfunc_pseudocode,
-    idalib_hexrays_cfuncptr_inner,
+    cblock_iter, cblock_t, cfunc_t, cfuncptr_t, cinsn_t, ctree_export_t, ctree_node_t,
+    decompile_func_with, idalib_hexrays_cblock_iter, idalib_hexrays_cblock_iter_next,
+    idalib_hexrays_cblock_len, idalib_hexrays_cfunc_export_ctree,
+    idalib_hexrays_cfunc_pseudocode_size, idalib_hexrays_cfunc_render,
+    idalib_hexrays_cfuncptr_inner, idalib_hexrays_ctype_name, idalib_hexrays_has_cached_cfunc,
+    pseudocode_span_t,
 };
+use crate::ffi::{BADADDR, IDAError};
 use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
 
 pub use crate::ffi::hexrays::{HexRaysError, HexRaysErrorCode};
 
@@ -64,7 +75,97 @@ impl<'a> CFunction<'a> {
     }
 
     pub fn pseudocode(&self) -> String {
-        unsafe { idalib_hexrays_cfunc_pseudocode(self.ptr) }
+        let mut out = String::new();
+        self.pseudocode_into(&mut out);
+        out
+    }
+
+    /// Appends the tag-stripped pseudocode to `out`, returning the number of
+    /// bytes written; reusing `out` across functions avoids reallocating.
+    pub fn pseudocode_into(&self, out: &mut String) -> usize {
+        self.render_raw(out, None, None)
+    }
+
+    /// Flattens the ctree into arrays in a single call; see `CTree`.
+    pub fn ctree(&self) -> CTree {
+        let _ffi = instrument::scope(Subsystem::HexRays, "ctree");
+        let mut out = ctree_export_t::default();
+        unsafe { idalib_hexrays_cfunc_export_ctree(self.ptr, &mut out) };
+
+        CTree {
+            nodes: out.nodes,
+            child_offsets: out.child_offsets,
+            children: out.children,
+        }
+    }
+
+    /// Renders the pseudocode with line boundaries and color spans.
+    pub fn render(&self) -> Pseudocode {
+        let mut pseudocode = Pseudocode::default();
+        self.render_into(&mut pseudocode);
+        pseudocode
+    }
+
+    /// Like `render`, reusing the buffers of `pseudocode`.
+    pub fn render_into(&self, pseudocode: &mut Pseudocode) {
+        pseudocode.clear();
+        self.render_raw(
+            &mut pseudocode.text,
+            Some(&mut pseudocode.line_ends),
+            Some(&mut pseudocode.spans),
+        );
+    }
+
+    fn render_raw(
+        &self,
+        out: &mut String,
+        line_ends: Option<&mut Vec<u32>>,
+        mut spans: Option<&mut Vec<pseudocode_span_t>>,
+    ) -> usize {
+        let _ffi = instrument::scope(Subsystem::HexRays, "render_raw");
+        let start = out.len();
+        let size = unsafe { idalib_hexrays_cfunc_pseudocode_size(self.ptr) };
+
+        let mut no_lines = Vec::new();
+        let mut no_spans = Vec::new();
+
+        let with_lines = line_ends.is_some();
+        let with_spans = spans.is_some();
+
+        // SAFETY: the buffer is truncated to what was written and checked
+        // for UTF-8 before `out` is used as a `String` again
+        let buf = unsafe { out.as_mut_vec() };
+        buf.resize(start + size, 0);
+
+        let written = unsafe {
+            idalib_hexrays_cfunc_render(
+                self.ptr,
+                &mut buf[start..],
+                with_lines,
+                line_ends.unwrap_or(&mut no_lines),
+                with_spans,
+                spans.as_deref_mut().unwrap_or(&mut no_spans),
+            )
+        };
+        buf.truncate(start + written);
+
+        // NOTE: line ends and spans are byte offsets into what was written,
+        // so invalid UTF-8 is replaced byte for byte rather than with U+FFFD
+        let mut from = start;
+        while let Err(e) = std::str::from_utf8(&buf[from..]) {
+            let bad = from + e.valid_up_to();
+            let len = e.error_len().unwrap_or(buf.len() - bad);
+            buf[bad..bad + len].fill(b'?');
+            from = bad + len;
+        }
+
+        // Spans are produced as they close; order them by start, enclosing
+        // spans first
+        if let Some(spans) = spans {
+            spans.sort_by_key(|span| (span.start, Reverse(span.end)));
+        }
+
+        out.len() - start
     }
 
     fn as_cfunc(&self) -> &cfunc_t {
@@ -98,3 +199,426 @@ impl<'a> CBlock<'a> {
         self.len() == 0
     }
 }
+
+pub type CNodeId = usize;
+
+/// A decompiled function's ctree as a flat array of nodes.
+///
+/// Nodes are in pre-order starting from the function body, so the subtree of
+/// a node is a contiguous range of ids; children are also available directly
+/// through a compressed sparse row index.
+#[derive(Debug, Clone, Default)]
+pub struct CTree {
+    nodes: Vec<ctree_node_t>,
+    child_offsets: Vec<u32>,
+    children: Vec<u32>,
+}
+
+impl CTree {
+    pub fn len(&self) -> usize {
+        self.nodes.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.nodes.is_empty()
+    }
+
+    pub fn root(&self) -> Option<CNode> {
+        self.node(0)
+    }
+
+    pub fn node(&self, id: CNodeId) -> Option<CNode> {
+        self.nodes.get(id).map(|node| CNode::new(id, node))
+    }
+
+    pub fn nodes(&self) -> impl ExactSizeIterator<Item = CNode> + '_ {
+        self.nodes
+            .iter()
+            .enumerate()
+            .map(|(id, node)| CNode::new(id, node))
+    }
+
+    pub fn children(&self, id: CNodeId) -> &[u32] {
+        let (start, end) = (self.child_offsets[id], self.child_offsets[id + 1]);
+        &self.children[start as usize..end as usize]
+    }
+
+    /// Ids of `id` and all of its descendants.
+    pub fn subtree(&self, id: CNodeId) -> Range<CNodeId> {
+        id..self.nodes[id].subtree_end as usize
+    }
+
+    /// Ancestors of `id`, nearest first.
+    pub fn ancestors(&self, id: CNodeId) -> impl Iterator<Item = CNodeId> + '_ {
+        let mut current = self.nodes.get(id).and_then(|node| parent_of(node));
+        std::iter::from_fn(move || {
+            let id = current?;
+            current = parent_of(&self.nodes[id]);
+            Some(id)
+        })
+    }
+}
+
+fn parent_of(node: &ctree_node_t) -> Option<CNodeId> {
+    (node.parent >= 0).then_some(node.parent as _)
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct CNode {
+    id: CNodeId,
+    op: u16,
+    is_expr: bool,
+    parent: Option<CNodeId>,
+    address: Option<Address>,
+    value: Option<u64>,
+}
+
+impl CNode {
+    fn new(id: CNodeId, node: &ctree_node_t) -> Self {
+        Self {
+            id,
+            op: node.op,
+            is_expr: node.is_expr,
+            parent: parent_of(node),
+            address: (node.ea != u64::from(BADADDR)).then_some(node.ea),
+            value: node.has_value.then_some(node.value),
+        }
+    }
+
+    pub fn id(&self) -> CNodeId {
+        self.id
+    }
+
+    /// The node's `ctype_t` operator (`cot_*` or `cit_*`).
+    pub fn op(&self) -> u16 {
+        self.op
+    }
+
+    pub fn op_name(&self) -> String {
+        unsafe { idalib_hexrays_ctype_name(self.op) }
+    }
+
+    pub fn is_expr(&self) -> bool {
+        self.is_expr
+    }
+
+    pub fn is_insn(&self) -> bool {
+        !self.is_expr
+    }
+
+    pub fn parent(&self) -> Option<CNodeId> {
+        self.parent
+    }
+
+    pub fn address(&self) -> Option<Address> {
+        self.address
+    }
+
+    /// Operator-specific value: the object address for `cot_obj`, the
+    /// constant for `cot_num`, the local variable index for `cot_var`, and
+    /// the member offset for `cot_memref`/`cot_memptr`.
+    pub fn value(&self) -> Option<u64> {
+        self.value
+    }
+}
+
+/// Rendered pseudocode with line boundaries and color spans; see
+/// `CFunction::render`.
+#[derive(Debug, Default)]
+pub struct Pseudocode {
+    text: String,
+    line_ends: Vec<u32>,
+    spans: Vec<pseudocode_span_t>,
+}
+
+/// Color tag value used for address anchors (`COLOR_ADDR`).
+pub const COLOR_ADDR: u8 = 0x28;
+
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ColorSpan {
+    /// Byte range within `Pseudocode::text`
+    pub range: Range<usize>,
+    /// One of the `COLOR_*` tag values
+    pub color: u8,
+    /// Address encoded by an anchor (`COLOR_ADDR`) span, which is empty
+    pub address: Option<Address>,
+}
+
+impl Pseudocode {
+    pub fn text(&self) -> &str {
+        &self.text
+    }
+
+    pub fn into_text(self) -> String {
+        self.text
+    }
+
+    pub fn lines_count(&self) -> usize {
+        self.line_ends.len()
+    }
+
+    /// The `n`th line, without its trailing newline.
+    pub fn line(&self, n: usize) -> Option<&str> {
+        let end = *self.line_ends.get(n)? as usize;
+        let start = if n == 0 {
+            0
+        } else {
+            self.line_ends[n - 1] as usize
+        };
+
+        self.text.get(start..end).map(|l| l.trim_end_matches('\n'))
+    }
+
+    pub fn lines(&self) -> impl ExactSizeIterator<Item = &str> + '_ {
+        (0..self.lines_count()).map(|n| self.line(n).unwrap_or_default())
+    }
+
+    /// Byte offset just past each line's newline.
+    pub fn line_ends(&self) -> &[u32] {
+        &self.line_ends
+    }
+
+    /// Color spans and address anchors, ordered by start offset; spans
+    /// starting together come outermost first.
+    pub fn spans(&self) -> impl ExactSizeIterator<Item = ColorSpan> + '_ {
+        self.spans.iter().map(|span| ColorSpan {
+            range: span.start as usize..span.end as usize,
+            color: span.color,
+            address: (span.color == COLOR_ADDR).then_some(span.addr),
+        })
+    }
+
+    pub fn clear(&mut self) {
+        self.text.clear();
+        self.line_ends.clear();
+        self.spans.clear();
+    }
+}
+
+#[derive(Debug, Clone)]
+pub struct DecompileBatchOptions {
+    all_blocks: bool,
+    use_cache: bool,
+    callees_first: bool,
+}
+
+impl Default for DecompileBatchOptions {
+    fn default() -> Self {
+        Self {
+            all_blocks: false,
+            use_cache: true,
+            callees_first: true,
+        }
+    }
+}
+
+impl DecompileBatchOptions {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn all_blocks(&mut self, all_blocks: bool) -> &mut Self {
+        self.all_blocks = all_blocks;
+        self
+    }
+
+    /// Let Hex-Rays return its cached result for functions that have not
+    /// been marked dirty since they were last decompiled (default: true).
+    pub fn use_cache(&mut self, use_cache: bool) -> &mut Self {
+        self.use_cache = use_cache;
+        self
+    }
+
+    /// Decompile callees before their callers, so that callers see the
+    /// types recovered for their callees (default: true).
+    pub fn callees_first(&mut self, callees_first: bool) -> &mut Self {
+        self.callees_first = callees_first;
+        self
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct DecompileRecord {
+    pub address: Address,
+    pub elapsed: Duration,
+    pub cached: bool,
+    pub error: Option<HexRaysErrorCode>,
+}
+
+#[derive(Debug, Clone, Default)]
+pub struct DecompileStats {
+    records: Vec<DecompileRecord>,
+    succeeded: usize,
+    cached: usize,
+    total_time: Duration,
+    failures: HashMap<HexRaysErrorCode, usize>,
+}
+
+impl DecompileStats {
+    fn record(&mut self, record: DecompileRecord) {
+        match record.error {
+            None => self.succeeded += 1,
+            Some(code) => *self.failures.entry(code).or_default() += 1,
+        }
+
+        if record.cached {
+            self.cached += 1;
+        }
+
+        self.total_time += record.elapsed;
+        self.records.push(record);
+    }
+
+    /// Per-function records, in the order functions were decompiled.
+    pub fn records(&self) -> &[DecompileRecord] {
+        &self.records
+    }
+
+    pub fn attempted(&self) -> usize {
+        self.records.len()
+    }
+
+    pub fn succeeded(&self) -> usize {
+        self.succeeded
+    }
+
+    pub fn failed(&self) -> usize {
+        self.records.len() - self.succeeded
+    }
+
+    /// Number of functions Hex-Rays already had cached.
+    pub fn cached(&self) -> usize {
+        self.cached
+    }
+
+    pub fn total_time(&self) -> Duration {
+        self.total_time
+    }
+
+    /// Failure counts by error code; functions that failed for a reason
+    /// other than a decompilation error are counted as `Unknown`.
+    pub fn failures(&self) -> &HashMap<HexRaysErrorCode, usize> {
+        &self.failures
+    }
+
+    pub fn slowest(&self, n: usize) -> Vec<DecompileRecord> {
+        let mut records = self.records.clone();
+        records.sort_by(|a, b| b.elapsed.cmp(&a.elapsed));
+        records.truncate(n);
+        records
+    }
+}
+
+pub struct DecompileResult<'a> {
+    pub address: Address,
+    pub result: Result<CFunction<'a>, IDAError>,
+    pub elapsed: Duration,
+    pub cached: bool,
+}
+
+/// Decompiles a list of functions one at a time, yielding each result as
+/// soon as it is available; see `IDB::decompile_batch`.
+pub struct DecompileBatch<'a> {
+    idb: &'a IDB,
+    order: Vec<Address>,
+    next: usize,
+    options: DecompileBatchOptions,
+    stats: DecompileStats,
+}
+
+impl<'a> DecompileBatch<'a> {
+    pub(crate) fn new(
+        idb: &'a IDB,
+        functions: Vec<Address>,
+        options: &DecompileBatchOptions,
+    ) -> Self {
+        let order = if options.callees_first {
+            CallGraph::of_functions(idb, &functions).callees_first(&functions)
+        } else {
+            functions
+        };
+
+        Self {
+            idb,
+            order,
+            next: 0,
+            options: options.clone(),
+            stats: DecompileStats::default(),
+        }
+    }
+
+    /// Functions in the order they will be decompiled.
+    pub fn order(&self) -> &[Address] {
+        &self.order
+    }
+
+    pub fn remaining(&self) -> usize {
+        self.order.len() - self.next
+    }
+
+    pub fn stats(&self) -> &DecompileStats {
+        &self.stats
+    }
+
+    pub fn into_stats(self) -> DecompileStats {
+        self.stats
+    }
+
+    fn decompile(&self, address: Address) -> Result<CFunction<'a>, IDAError> {
+        let f = self
+            .idb
+            .function_at(address)
+            .ok_or_else(|| IDAError::ffi_with(format!("no function at {address:#x}")))?;
+
+        // NOTE: opened after `function_at`, which counts itself under Funcs
+        let _ffi = instrument::scope(Subsystem::HexRays, "decompile_batch");
+        let cf = unsafe {
+            decompile_func_with(f.as_ptr(), self.options.all_blocks, self.options.use_cache)?
+        };
+
+        CFunction::new(cf).ok_or_else(|| IDAError::ffi_with("null decompilation result"))
+    }
+}
+
+impl<'a> Iterator for DecompileBatch<'a> {
+    type Item = DecompileResult<'a>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        let address = *self.order.get(self.next)?;
+        self.next += 1;
+
+        let cached = self.options.use_cache && {
+            let _ffi = instrument::scope(Subsystem::HexRays, "has_cached_cfunc");
+            unsafe { idalib_hexrays_has_cached_cfunc(address.into()) }
+        };
+
+        let start = Instant::now();
+        let result = self.decompile(address);
+        let elapsed = start.elapsed();
+
+        let error = result.as_ref().err().map(|e| match e {
+            IDAError::HexRays(e) => e.code(),
+            _ => HexRaysErrorCode::Unknown,
+        });
+
+        self.stats.record(DecompileRecord {
+            address,
+            elapsed,
+            cached,
+            error,
+        });
+
+        Some(DecompileResult {
+            address,
+            result,
+            elapsed,
+            cached,
+        })
+    }
+
+    fn size_hint(&self) -> (usize, Option<usize>) {
+        (self.remaining(), Some(self.remaining()))
+    }
+}
+
+impl<'a> ExactSizeIterator for DecompileBatch<'a> {}
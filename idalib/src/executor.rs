@@ -0,0 +1,610 @@
+//! Serving database queries from other threads and async tasks.
+//!
+//! Kernel access is serialised by the blocking lock behind
+//! `prepare_library` and must happen on the process's main thread, and calls
+//! such as `auto_wait` or decompilation can hold it for seconds; making them
+//! from an async runtime's worker threads stalls every other task scheduled
+//! there. Instead, the main thread opens the database and serves an
+//! `Executor`, running queued jobs one at a time, while the rest of the
+//! program submits closures through `ExecutorHandle`s. Each submission
+//! returns a `JobHandle`, which is a `Future` and can also be waited on
+//! directly.
+//!
+//! ```ignore
+//! fn main() -> anyhow::Result<()> {
+//!     let mut idb = IDB::open("./tests/ls")?;
+//!
+//!     let executor = Executor::new(&ExecutorOptions::default());
+//!     let handle = executor.handle();
+//!
+//!     let service = std::thread::spawn(move || {
+//!         // From async code, `handle.run(|idb| ...).await` instead
+//!         let count = handle.submit(|idb| idb.function_count())?.wait()?;
+//!         // ...
+//!     });
+//!
+//!     // Returns once every handle has been dropped
+//!     executor.serve(&mut idb);
+//!     Ok(())
+//! }
+//! ```
+//!
+//! The queue is bounded: `submit` blocks and `submit_async` waits while it is
+//! full, and `try_submit` fails instead. The executor takes every queued job
+//! (up to `ExecutorOptions::max_batch`) in a single pass, so bursts of small
+//! requests from concurrent clients are served without a wake-up per job.
+//! `Executor::stats` reports queue depth, time spent queued and batch sizes.
+
+use std::collections::VecDeque;
+use std::future::Future;
+use std::mem;
+use std::panic::{self, AssertUnwindSafe};
+use std::pin::Pin;
+use std::sync::{Arc, Condvar, Mutex, MutexGuard};
+use std::task::{Context, Poll, Waker};
+use std::time::{Duration, Instant};
+
+use crate::IDAError;
+use crate::idb::IDB;
+
+type Task = Box<dyn FnOnce(&mut IDB) + Send>;
+
+#[derive(Debug, Clone)]
+pub struct ExecutorOptions {
+    capacity: usize,
+    max_batch: usize,
+}
+
+impl Default for ExecutorOptions {
+    fn default() -> Self {
+        Self {
+            capacity: 1024,
+            max_batch: 64,
+        }
+    }
+}
+
+impl ExecutorOptions {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Maximum number of queued jobs before submitters are held back
+    /// (default: 1024).
+    pub fn capacity(&mut self, capacity: usize) -> &mut Self {
+        self.capacity = capacity.max(1);
+        self
+    }
+
+    /// Maximum number of jobs taken from the queue in one pass (default: 64).
+    pub fn max_batch(&mut self, max_batch: usize) -> &mut Self {
+        self.max_batch = max_batch.max(1);
+        self
+    }
+}
+
+#[derive(Debug, Clone, Copy, Default)]
+pub struct ExecutorStats {
+    submitted: u64,
+    completed: u64,
+    panicked: u64,
+    rejected: u64,
+    batches: u64,
+    largest_batch: usize,
+    queued: usize,
+    peak_queued: usize,
+    queue_wait: Duration,
+    max_queue_wait: Duration,
+    busy: Duration,
+}
+
+impl ExecutorStats {
+    pub fn submitted(&self) -> u64 {
+        self.submitted
+    }
+
+    /// Number of jobs run, including those that panicked.
+    pub fn completed(&self) -> u64 {
+        self.completed
+    }
+
+    pub fn panicked(&self) -> u64 {
+        self.panicked
+    }
+
+    /// Number of `try_submit` calls turned away because the queue was full.
+    pub fn rejected(&self) -> u64 {
+        self.rejected
+    }
+
+    /// Number of passes over the queue.
+    pub fn batches(&self) -> u64 {
+        self.batches
+    }
+
+    pub fn largest_batch(&self) -> usize {
+        self.largest_batch
+    }
+
+    pub fn mean_batch(&self) -> f64 {
+        if self.batches == 0 {
+            0.0
+        } else {
+            self.completed as f64 / self.batches as f64
+        }
+    }
+
+    /// Number of jobs currently waiting to run.
+    pub fn queued(&self) -> usize {
+        self.queued
+    }
+
+    pub fn peak_queued(&self) -> usize {
+        self.peak_queued
+    }
+
+    /// Total time jobs spent queued before the executor picked them up.
+    pub fn queue_wait(&self) -> Duration {
+        self.queue_wait
+    }
+
+    pub fn max_queue_wait(&self) -> Duration {
+        self.max_queue_wait
+    }
+
+    pub fn mean_queue_wait(&self) -> Duration {
+        if self.completed == 0 {
+            Duration::ZERO
+        } else {
+            self.queue_wait.div_f64(self.completed as f64)
+        }
+    }
+
+    /// Total time spent running jobs.
+    pub fn busy(&self) -> Duration {
+        self.busy
+    }
+}
+
+struct Queued {
+    task: Task,
+    queued: Instant,
+}
+
+struct State {
+    queue: VecDeque<Queued>,
+    closed: bool,
+    handles: usize,
+    // Tasks waiting in `submit_async` for the queue to have room
+    waiting: Vec<Waker>,
+    stats: ExecutorStats,
+}
+
+struct Shared {
+    state: Mutex<State>,
+    work: Condvar,
+    space: Condvar,
+    capacity: usize,
+    max_batch: usize,
+}
+
+impl Shared {
+    // NOTE: jobs run outside the lock and panics are caught, so a poisoned
+    // lock can only come from a panic in this module's own bookkeeping
+    fn lock(&self) -> MutexGuard<'_, State> {
+        self.state.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    fn close(&self) {
+        let waiting = {
+            let mut state = self.lock();
+            state.closed = true;
+            mem::take(&mut state.waiting)
+        };
+
+        self.work.notify_all();
+        self.space.notify_all();
+        for waker in waiting {
+            waker.wake();
+        }
+    }
+
+    fn push(&self, state: &mut State, task: Task) {
+        state.queue.push_back(Queued {
+            task,
+            queued: Instant::now(),
+        });
+
+        state.stats.submitted += 1;
+        state.stats.queued = state.queue.len();
+        state.stats.peak_queued = state.stats.peak_queued.max(state.queue.len());
+
+        self.work.notify_one();
+    }
+
+    fn serve(&self, idb: &mut IDB) {
+        let mut batch = Vec::with_capacity(self.max_batch);
+
+        loop {
+            let waiting = {
+                let mut state = self.lock();
+
+                while state.queue.is_empty() && !state.closed && state.handles > 0 {
+                    state = self.work.wait(state).unwrap_or_else(|e| e.into_inner());
+                }
+
+                // Closed (or never handed out) and drained
+                if state.queue.is_empty() {
+                    return;
+                }
+
+                let state = &mut *state;
+                let now = Instant::now();
+                let n = state.queue.len().min(self.max_batch);
+
+                for queued in state.queue.drain(..n) {
+                    let wait = now.saturating_duration_since(queued.queued);
+                    state.stats.queue_wait += wait;
+                    state.stats.max_queue_wait = state.stats.max_queue_wait.max(wait);
+                    batch.push(queued.task);
+                }
+
+                state.stats.batches += 1;
+                state.stats.largest_batch = state.stats.largest_batch.max(n);
+                state.stats.queued = state.queue.len();
+
+                mem::take(&mut state.waiting)
+            };
+
+            self.space.notify_all();
+            for waker in waiting {
+                waker.wake();
+            }
+
+            let start = Instant::now();
+            let count = batch.len() as u64;
+            let mut panicked = 0;
+
+            for task in batch.drain(..) {
+                if panic::catch_unwind(AssertUnwindSafe(|| task(idb))).is_err() {
+                    panicked += 1;
+                }
+            }
+
+            let mut state = self.lock();
+            state.stats.completed += count;
+            state.stats.panicked += panicked;
+            state.stats.busy += start.elapsed();
+        }
+    }
+}
+
+/// The serving side of an executor; see the module documentation.
+///
+/// Create it on the thread that opened the database, hand out
+/// `ExecutorHandle`s to the threads or tasks that submit work, then call
+/// `serve`.
+pub struct Executor {
+    shared: Arc<Shared>,
+}
+
+impl Executor {
+    pub fn new(options: &ExecutorOptions) -> Self {
+        Self {
+            shared: Arc::new(Shared {
+                state: Mutex::new(State {
+                    queue: VecDeque::new(),
+                    closed: false,
+                    handles: 0,
+                    waiting: Vec::new(),
+                    stats: ExecutorStats::default(),
+                }),
+                work: Condvar::new(),
+                space: Condvar::new(),
+                capacity: options.capacity,
+                max_batch: options.max_batch,
+            }),
+        }
+    }
+
+    pub fn handle(&self) -> ExecutorHandle {
+        ExecutorHandle::new(self.shared.clone())
+    }
+
+    /// Runs queued jobs against `idb` on the calling thread until every
+    /// handle has been dropped or one of them called `close`; jobs queued
+    /// by then are run before returning.
+    pub fn serve(&self, idb: &mut IDB) {
+        self.shared.serve(idb)
+    }
+
+    pub fn stats(&self) -> ExecutorStats {
+        self.shared.lock().stats
+    }
+}
+
+impl Drop for Executor {
+    fn drop(&mut self) {
+        self.shared.close();
+
+        // Fail jobs that will never be served rather than leave their
+        // callers waiting
+        let queued = mem::take(&mut self.shared.lock().queue);
+        drop(queued);
+    }
+}
+
+/// Submits jobs to an `Executor` from any thread or async task.
+///
+/// Handles are cheap to clone; the executor stops serving once the last
+/// one is dropped.
+pub struct ExecutorHandle {
+    shared: Arc<Shared>,
+}
+
+impl ExecutorHandle {
+    fn new(shared: Arc<Shared>) -> Self {
+        shared.lock().handles += 1;
+        Self { shared }
+    }
+
+    /// Queues `f`, blocking while the queue is full.
+    ///
+    /// Do not wait on the returned handle from inside another job: the
+    /// executor runs one job at a time, so it would never complete.
+    pub fn submit<F, T>(&self, f: F) -> Result<JobHandle<T>, IDAError>
+    where
+        F: FnOnce(&mut IDB) -> T + Send + 'static,
+        T: Send + 'static,
+    {
+        let (task, handle) = job(f);
+        let mut state = self.shared.lock();
+
+        loop {
+            if state.closed {
+                return Err(closed());
+            }
+            if state.queue.len() < self.shared.capacity {
+                break;
+            }
+            state = self
+                .shared
+                .space
+                .wait(state)
+                .unwrap_or_else(|e| e.into_inner());
+        }
+
+        self.shared.push(&mut state, task);
+        Ok(handle)
+    }
+
+    /// Queues `f`, failing immediately if the queue is full.
+    pub fn try_submit<F, T>(&self, f: F) -> Result<JobHandle<T>, IDAError>
+    where
+        F: FnOnce(&mut IDB) -> T + Send + 'static,
+        T: Send + 'static,
+    {
+        let mut state = self.shared.lock();
+
+        if state.closed {
+            return Err(closed());
+        }
+        if state.queue.len() >= self.shared.capacity {
+            state.stats.rejected += 1;
+            return Err(IDAError::ffi_with("executor queue is full"));
+        }
+
+        let (task, handle) = job(f);
+        self.shared.push(&mut state, task);
+        Ok(handle)
+    }
+
+    /// Queues `f` once the queue has room, without blocking the calling
+    /// thread; the future resolves to the job's handle.
+    pub fn submit_async<F, T>(&self, f: F) -> Submit<T>
+    where
+        F: FnOnce(&mut IDB) -> T + Send + 'static,
+        T: Send + 'static,
+    {
+        let (task, handle) = job(f);
+        Submit {
+            shared: self.shared.clone(),
+            task: Some(task),
+            handle: Some(handle),
+        }
+    }
+
+    /// Queues `f` as `submit_async` and waits for its result.
+    pub async fn run<F, T>(&self, f: F) -> Result<T, IDAError>
+    where
+        F: FnOnce(&mut IDB) -> T + Send + 'static,
+        T: Send + 'static,
+    {
+        self.submit_async(f).await?.await
+    }
+
+    pub fn stats(&self) -> ExecutorStats {
+        self.shared.lock().stats
+    }
+
+    /// Stops accepting jobs; `Executor::serve` returns once those already
+    /// queued have run.
+    pub fn close(&self) {
+        self.shared.close();
+    }
+}
+
+impl Clone for ExecutorHandle {
+    fn clone(&self) -> Self {
+        Self::new(self.shared.clone())
+    }
+}
+
+impl Drop for ExecutorHandle {
+    fn drop(&mut self) {
+        let last = {
+            let mut state = self.shared.lock();
+            state.handles -= 1;
+            state.handles == 0
+        };
+
+        if last {
+            self.shared.close();
+        }
+    }
+}
+
+fn closed() -> IDAError {
+    IDAError::ffi_with("executor is shut down")
+}
+
+/// A future that queues a job once the executor's queue has room; see
+/// `Executor::submit_async`.
+pub struct Submit<T> {
+    shared: Arc<Shared>,
+    task: Option<Task>,
+    handle: Option<JobHandle<T>>,
+}
+
+impl<T> Future for Submit<T> {
+    type Output = Result<JobHandle<T>, IDAError>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let this = self.get_mut();
+        let mut state = this.shared.lock();
+
+        if state.closed {
+            return Poll::Ready(Err(closed()));
+        }
+
+        if state.queue.len() >= this.shared.capacity {
+            if !state.waiting.iter().any(|w| w.will_wake(cx.waker())) {
+                state.waiting.push(cx.waker().clone());
+            }
+            return Poll::Pending;
+        }
+
+        let task = this.task.take().expect("Submit polled after completion");
+        this.shared.push(&mut state, task);
+
+        Poll::Ready(Ok(this.handle.take().expect("handle taken with task")))
+    }
+}
+
+struct Slot<T> {
+    state: Mutex<SlotState<T>>,
+    done: Condvar,
+}
+
+struct SlotState<T> {
+    result: Option<Result<T, IDAError>>,
+    waker: Option<Waker>,
+}
+
+impl<T> Slot<T> {
+    fn lock(&self) -> MutexGuard<'_, SlotState<T>> {
+        self.state.lock().unwrap_or_else(|e| e.into_inner())
+    }
+}
+
+// Completes the slot when dropped, so a job that panics or is never run
+// still wakes its handle
+struct Completion<T> {
+    slot: Arc<Slot<T>>,
+    result: Option<Result<T, IDAError>>,
+    started: bool,
+}
+
+impl<T> Drop for Completion<T> {
+    fn drop(&mut self) {
+        let result = self.result.take().unwrap_or_else(|| {
+            Err(IDAError::ffi_with(if self.started {
+                "job panicked"
+            } else {
+                "executor stopped before running the job"
+            }))
+        });
+
+        let waker = {
+            let mut state = self.slot.lock();
+            state.result = Some(result);
+            state.waker.take()
+        };
+
+        self.slot.done.notify_all();
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+}
+
+fn job<F, T>(f: F) -> (Task, JobHandle<T>)
+where
+    F: FnOnce(&mut IDB) -> T + Send + 'static,
+    T: Send + 'static,
+{
+    let slot = Arc::new(Slot {
+        state: Mutex::new(SlotState {
+            result: None,
+            waker: None,
+        }),
+        done: Condvar::new(),
+    });
+
+    let mut completion = Completion {
+        slot: slot.clone(),
+        result: None,
+        started: false,
+    };
+
+    let task = Box::new(move |idb: &mut IDB| {
+        completion.started = true;
+        completion.result = Some(Ok(f(idb)));
+    });
+
+    (task, JobHandle { slot })
+}
+
+/// The pending result of a job queued on an `Executor`.
+///
+/// Await it from async code, or call `wait` to block the current thread.
+/// The result is an error if the job panicked or the executor stopped
+/// before running it.
+pub struct JobHandle<T> {
+    slot: Arc<Slot<T>>,
+}
+
+impl<T> JobHandle<T> {
+    pub fn is_finished(&self) -> bool {
+        self.slot.lock().result.is_some()
+    }
+
+    pub fn wait(self) -> Result<T, IDAError> {
+        let mut state = self.slot.lock();
+        loop {
+            if let Some(result) = state.result.take() {
+                return result;
+            }
+            state = self
+                .slot
+                .done
+                .wait(state)
+                .unwrap_or_else(|e| e.into_inner());
+        }
+    }
+}
+
+impl<T> Future for JobHandle<T> {
+    type Output = Result<T, IDAError>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let mut state = self.slot.lock();
+
+        if let Some(result) = state.result.take() {
+            return Poll::Ready(result);
+        }
+
+        state.waker = Some(cx.waker().clone());
+        Poll::Pending
+    }
+}
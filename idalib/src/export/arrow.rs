@@ -0,0 +1,611 @@
+//! A minimal writer for the Arrow IPC streaming format.
+//!
+//! Only what the exporters need is supported: flat schemas of non-nullable
+//! booleans, integers and UTF-8 strings, written as a schema message
+//! followed by any number of uncompressed record batches. The output can be
+//! read by any Arrow implementation (e.g., `pyarrow.ipc.open_stream`).
+//!
+//! Message metadata is encoded as FlatBuffers by a small forward builder: each
+//! object is written before the objects it refers to, so every offset points
+//! forwards as the format requires.
+
+use std::cmp::Reverse;
+use std::io::{self, Write};
+use std::mem;
+
+const CONTINUATION: u32 = 0xffff_ffff;
+pub(crate) const END_OF_STREAM_LEN: u64 = 8;
+const METADATA_V5: i16 = 4;
+
+const HEADER_SCHEMA: u8 = 1;
+const HEADER_RECORD_BATCH: u8 = 3;
+
+const TYPE_INT: u8 = 2;
+const TYPE_UTF8: u8 = 5;
+const TYPE_BOOL: u8 = 6;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum ColumnType {
+    Boolean,
+    UInt8,
+    UInt32,
+    Int32,
+    UInt64,
+    Utf8,
+}
+
+/// The values of one column of a record batch.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum Column {
+    Boolean(Vec<bool>),
+    UInt8(Vec<u8>),
+    UInt32(Vec<u32>),
+    Int32(Vec<i32>),
+    UInt64(Vec<u64>),
+    Utf8 { offsets: Vec<i32>, data: Vec<u8> },
+}
+
+impl Column {
+    pub fn new(kind: ColumnType) -> Self {
+        match kind {
+            ColumnType::Boolean => Self::Boolean(Vec::new()),
+            ColumnType::UInt8 => Self::UInt8(Vec::new()),
+            ColumnType::UInt32 => Self::UInt32(Vec::new()),
+            ColumnType::Int32 => Self::Int32(Vec::new()),
+            ColumnType::UInt64 => Self::UInt64(Vec::new()),
+            ColumnType::Utf8 => Self::Utf8 {
+                offsets: vec![0],
+                data: Vec::new(),
+            },
+        }
+    }
+
+    pub fn kind(&self) -> ColumnType {
+        match self {
+            Self::Boolean(_) => ColumnType::Boolean,
+            Self::UInt8(_) => ColumnType::UInt8,
+            Self::UInt32(_) => ColumnType::UInt32,
+            Self::Int32(_) => ColumnType::Int32,
+            Self::UInt64(_) => ColumnType::UInt64,
+            Self::Utf8 { .. } => ColumnType::Utf8,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        match self {
+            Self::Boolean(values) => values.len(),
+            Self::UInt8(values) => values.len(),
+            Self::UInt32(values) => values.len(),
+            Self::Int32(values) => values.len(),
+            Self::UInt64(values) => values.len(),
+            Self::Utf8 { offsets, .. } => offsets.len().saturating_sub(1),
+        }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Appends `value` to a `Utf8` column; does nothing for other columns.
+    pub fn push_str(&mut self, value: &str) {
+        if let Self::Utf8 { offsets, data } = self {
+            data.extend_from_slice(value.as_bytes());
+            offsets.push(data.len() as i32);
+        }
+    }
+
+    /// Removes all values, keeping the allocated capacity.
+    pub fn clear(&mut self) {
+        match self {
+            Self::Boolean(values) => values.clear(),
+            Self::UInt8(values) => values.clear(),
+            Self::UInt32(values) => values.clear(),
+            Self::Int32(values) => values.clear(),
+            Self::UInt64(values) => values.clear(),
+            Self::Utf8 { offsets, data } => {
+                offsets.clear();
+                offsets.push(0);
+                data.clear();
+            }
+        }
+    }
+}
+
+/// Writes a schema and then record batches as an Arrow IPC stream.
+pub struct ArrowStreamWriter<W: Write> {
+    out: W,
+    kinds: Vec<ColumnType>,
+    body: Vec<u8>,
+    written: u64,
+}
+
+impl<W: Write> ArrowStreamWriter<W> {
+    /// Starts a stream with the given column names and types.
+    pub fn new(out: W, fields: &[(&str, ColumnType)]) -> io::Result<Self> {
+        let mut writer = Self {
+            out,
+            kinds: fields.iter().map(|(_, kind)| *kind).collect(),
+            body: Vec::new(),
+            written: 0,
+        };
+
+        let metadata = schema_message(fields);
+        writer.write_message(&metadata)?;
+
+        Ok(writer)
+    }
+
+    /// Writes one record batch; `columns` must match the schema and have the
+    /// same length.
+    pub fn write_batch(&mut self, columns: &[Column]) -> io::Result<()> {
+        if columns.len() != self.kinds.len()
+            || columns.iter().zip(&self.kinds).any(|(c, k)| c.kind() != *k)
+        {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                "record batch columns do not match the schema",
+            ));
+        }
+
+        let rows = columns.first().map(Column::len).unwrap_or_default();
+        if columns.iter().any(|column| column.len() != rows) {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                "record batch columns have different lengths",
+            ));
+        }
+
+        self.body.clear();
+
+        let mut buffers = Vec::with_capacity(columns.len() * 3);
+        for column in columns {
+            // No column is nullable, so every validity bitmap is empty
+            buffers.push((self.body.len(), 0));
+
+            match column {
+                Column::Boolean(values) => {
+                    let start = self.body.len();
+                    self.body.resize(start + values.len().div_ceil(8), 0);
+                    for (i, value) in values.iter().enumerate() {
+                        self.body[start + i / 8] |= (*value as u8) << (i % 8);
+                    }
+                    self.push_buffer(&mut buffers, start);
+                }
+                Column::UInt8(values) => {
+                    let start = self.body.len();
+                    self.body.extend_from_slice(values);
+                    self.push_buffer(&mut buffers, start);
+                }
+                Column::UInt32(values) => {
+                    let start = self.body.len();
+                    values
+                        .iter()
+                        .for_each(|v| self.body.extend_from_slice(&v.to_le_bytes()));
+                    self.push_buffer(&mut buffers, start);
+                }
+                Column::Int32(values) => {
+                    let start = self.body.len();
+                    values
+                        .iter()
+                        .for_each(|v| self.body.extend_from_slice(&v.to_le_bytes()));
+                    self.push_buffer(&mut buffers, start);
+                }
+                Column::UInt64(values) => {
+                    let start = self.body.len();
+                    values
+                        .iter()
+                        .for_each(|v| self.body.extend_from_slice(&v.to_le_bytes()));
+                    self.push_buffer(&mut buffers, start);
+                }
+                Column::Utf8 { offsets, data } => {
+                    if data.len() > i32::MAX as usize {
+                        return Err(io::Error::new(
+                            io::ErrorKind::InvalidInput,
+                            "string column exceeds 2 GiB in one batch",
+                        ));
+                    }
+
+                    let start = self.body.len();
+                    offsets
+                        .iter()
+                        .for_each(|v| self.body.extend_from_slice(&v.to_le_bytes()));
+                    self.push_buffer(&mut buffers, start);
+
+                    let start = self.body.len();
+                    self.body.extend_from_slice(data);
+                    self.push_buffer(&mut buffers, start);
+                }
+            }
+        }
+
+        let metadata = record_batch_message(rows, columns, &buffers, self.body.len());
+        let body = mem::take(&mut self.body);
+
+        let result = self
+            .write_message(&metadata)
+            .and_then(|_| self.out.write_all(&body));
+        if result.is_ok() {
+            self.written += body.len() as u64;
+        }
+        self.body = body;
+
+        result
+    }
+
+    /// Number of bytes written so far.
+    pub fn bytes_written(&self) -> u64 {
+        self.written
+    }
+
+    /// Writes the end-of-stream marker and returns the underlying writer.
+    pub fn finish(mut self) -> io::Result<W> {
+        self.out.write_all(&CONTINUATION.to_le_bytes())?;
+        self.out.write_all(&0u32.to_le_bytes())?;
+        self.out.flush()?;
+        Ok(self.out)
+    }
+
+    // Records the buffer written since `start` and pads the body to 8 bytes.
+    fn push_buffer(&mut self, buffers: &mut Vec<(usize, usize)>, start: usize) {
+        buffers.push((start, self.body.len() - start));
+        self.body.resize(self.body.len().next_multiple_of(8), 0);
+    }
+
+    // Writes the encapsulated message metadata; the body, if any, follows.
+    fn write_message(&mut self, metadata: &[u8]) -> io::Result<()> {
+        debug_assert_eq!(metadata.len() % 8, 0);
+
+        self.out.write_all(&CONTINUATION.to_le_bytes())?;
+        self.out.write_all(&(metadata.len() as i32).to_le_bytes())?;
+        self.out.write_all(metadata)?;
+        self.written += 8 + metadata.len() as u64;
+
+        Ok(())
+    }
+}
+
+fn schema_message(fields: &[(&str, ColumnType)]) -> Vec<u8> {
+    let mut fb = FlatBuilder::new();
+
+    let (message, slots) = fb.table(&[
+        (0, Value::I16(METADATA_V5)),
+        (1, Value::U8(HEADER_SCHEMA)),
+        (2, Value::Offset),
+        (3, Value::I64(0)),
+    ]);
+
+    // Schema { fields: [Field] }; endianness defaults to little-endian
+    let (schema, schema_slots) = fb.table(&[(1, Value::Offset)]);
+    fb.set_offset(slots[0], schema);
+
+    let (vector, field_slots) = fb.offset_vector(fields.len());
+    fb.set_offset(schema_slots[0], vector);
+
+    for ((name, kind), slot) in fields.iter().zip(field_slots) {
+        let type_id = match kind {
+            ColumnType::Boolean => TYPE_BOOL,
+            ColumnType::Utf8 => TYPE_UTF8,
+            _ => TYPE_INT,
+        };
+
+        // Field { name, nullable, type_type, type, children }
+        let (field, slots) = fb.table(&[
+            (0, Value::Offset),
+            (1, Value::Bool(false)),
+            (2, Value::U8(type_id)),
+            (3, Value::Offset),
+            (5, Value::Offset),
+        ]);
+        fb.set_offset(slot, field);
+
+        let name = fb.string(name);
+        fb.set_offset(slots[0], name);
+
+        // Int { bitWidth, is_signed }; Bool and Utf8 have no fields
+        let (type_, _) = match kind {
+            ColumnType::UInt8 => fb.table(&[(0, Value::I32(8)), (1, Value::Bool(false))]),
+            ColumnType::UInt32 => fb.table(&[(0, Value::I32(32)), (1, Value::Bool(false))]),
+            ColumnType::Int32 => fb.table(&[(0, Value::I32(32)), (1, Value::Bool(true))]),
+            ColumnType::UInt64 => fb.table(&[(0, Value::I32(64)), (1, Value::Bool(false))]),
+            ColumnType::Boolean | ColumnType::Utf8 => fb.table(&[]),
+        };
+        fb.set_offset(slots[1], type_);
+
+        let (children, _) = fb.offset_vector(0);
+        fb.set_offset(slots[2], children);
+    }
+
+    fb.finish(message)
+}
+
+fn record_batch_message(
+    rows: usize,
+    columns: &[Column],
+    buffers: &[(usize, usize)],
+    body_len: usize,
+) -> Vec<u8> {
+    let mut fb = FlatBuilder::new();
+
+    let (message, slots) = fb.table(&[
+        (0, Value::I16(METADATA_V5)),
+        (1, Value::U8(HEADER_RECORD_BATCH)),
+        (2, Value::Offset),
+        (3, Value::I64(body_len as i64)),
+    ]);
+
+    // RecordBatch { length, nodes: [FieldNode], buffers: [Buffer] }
+    let (batch, batch_slots) = fb.table(&[
+        (0, Value::I64(rows as i64)),
+        (1, Value::Offset),
+        (2, Value::Offset),
+    ]);
+    fb.set_offset(slots[0], batch);
+
+    // FieldNode { length, null_count }
+    let nodes = columns
+        .iter()
+        .flat_map(|column| [column.len() as i64, 0])
+        .flat_map(i64::to_le_bytes)
+        .collect::<Vec<_>>();
+    let nodes = fb.struct_vector(&nodes, columns.len());
+    fb.set_offset(batch_slots[0], nodes);
+
+    // Buffer { offset, length }
+    let buffer_data = buffers
+        .iter()
+        .flat_map(|(offset, length)| [*offset as i64, *length as i64])
+        .flat_map(i64::to_le_bytes)
+        .collect::<Vec<_>>();
+    let buffer_data = fb.struct_vector(&buffer_data, buffers.len());
+    fb.set_offset(batch_slots[1], buffer_data);
+
+    fb.finish(message)
+}
+
+#[derive(Debug, Clone, Copy)]
+enum Value {
+    Bool(bool),
+    U8(u8),
+    I16(i16),
+    I32(i32),
+    I64(i64),
+    Offset,
+}
+
+impl Value {
+    fn size(&self) -> usize {
+        match self {
+            Self::Bool(_) | Self::U8(_) => 1,
+            Self::I16(_) => 2,
+            Self::I32(_) | Self::Offset => 4,
+            Self::I64(_) => 8,
+        }
+    }
+}
+
+/// Builds a FlatBuffer front to back; offsets are written as placeholders
+/// and patched with `set_offset` once their targets have been written.
+struct FlatBuilder {
+    buf: Vec<u8>,
+}
+
+impl FlatBuilder {
+    fn new() -> Self {
+        // Room for the offset to the root table
+        Self { buf: vec![0; 4] }
+    }
+
+    fn pad_to(&mut self, align: usize, rem: usize) {
+        while self.buf.len() % align != rem {
+            self.buf.push(0);
+        }
+    }
+
+    fn set_offset(&mut self, slot: usize, target: usize) {
+        debug_assert!(target > slot);
+
+        let offset = (target - slot) as u32;
+        self.buf[slot..slot + 4].copy_from_slice(&offset.to_le_bytes());
+    }
+
+    /// Writes a vtable and a table holding `fields` (field id, value),
+    /// returning the table position and the positions of its `Offset`
+    /// fields in the order given.
+    fn table(&mut self, fields: &[(u16, Value)]) -> (usize, Vec<usize>) {
+        let entries = fields
+            .iter()
+            .map(|(id, _)| *id as usize + 1)
+            .max()
+            .unwrap_or_default();
+
+        // Lay fields out largest first after the vtable offset; the table
+        // starts at 4 (mod 8) so that 8-byte fields end up aligned
+        let mut order = (0..fields.len()).collect::<Vec<_>>();
+        order.sort_by_key(|i| Reverse(fields[*i].1.size()));
+
+        let mut at = vec![0; fields.len()];
+        let mut size = 4;
+        for i in &order {
+            at[*i] = size;
+            size += fields[*i].1.size();
+        }
+
+        let mut vtable = vec![0u16; entries];
+        for (i, (id, _)) in fields.iter().enumerate() {
+            vtable[*id as usize] = at[i] as u16;
+        }
+
+        self.pad_to(2, 0);
+        let vtable_pos = self.buf.len();
+
+        self.buf
+            .extend_from_slice(&((4 + 2 * entries) as u16).to_le_bytes());
+        self.buf.extend_from_slice(&(size as u16).to_le_bytes());
+        vtable
+            .iter()
+            .for_each(|entry| self.buf.extend_from_slice(&entry.to_le_bytes()));
+
+        self.pad_to(8, 4);
+        let table = self.buf.len();
+
+        self.buf
+            .extend_from_slice(&((table - vtable_pos) as i32).to_le_bytes());
+
+        let mut slots = vec![0; fields.len()];
+        for i in order {
+            match fields[i].1 {
+                Value::Bool(v) => self.buf.push(v as u8),
+                Value::U8(v) => self.buf.push(v),
+                Value::I16(v) => self.buf.extend_from_slice(&v.to_le_bytes()),
+                Value::I32(v) => self.buf.extend_from_slice(&v.to_le_bytes()),
+                Value::I64(v) => self.buf.extend_from_slice(&v.to_le_bytes()),
+                Value::Offset => {
+                    slots[i] = self.buf.len();
+                    self.buf.extend_from_slice(&[0; 4]);
+                }
+            }
+        }
+
+        let offsets = fields
+            .iter()
+            .zip(slots)
+            .filter(|((_, value), _)| matches!(value, Value::Offset))
+            .map(|(_, slot)| slot)
+            .collect();
+
+        (table, offsets)
+    }
+
+    /// Writes a vector of `len` offsets, returning its position and the
+    /// positions of its elements.
+    fn offset_vector(&mut self, len: usize) -> (usize, Vec<usize>) {
+        self.pad_to(4, 0);
+        let vector = self.buf.len();
+
+        self.buf.extend_from_slice(&(len as u32).to_le_bytes());
+
+        let slots = (0..len).map(|i| vector + 4 + 4 * i).collect();
+        self.buf.resize(vector + 4 + 4 * len, 0);
+
+        (vector, slots)
+    }
+
+    /// Writes a vector of `len` 8-byte aligned structs.
+    fn struct_vector(&mut self, data: &[u8], len: usize) -> usize {
+        self.pad_to(8, 4);
+        let vector = self.buf.len();
+
+        self.buf.extend_from_slice(&(len as u32).to_le_bytes());
+        self.buf.extend_from_slice(data);
+
+        vector
+    }
+
+    fn string(&mut self, value: &str) -> usize {
+        self.pad_to(4, 0);
+        let string = self.buf.len();
+
+        self.buf
+            .extend_from_slice(&(value.len() as u32).to_le_bytes());
+        self.buf.extend_from_slice(value.as_bytes());
+        self.buf.push(0);
+
+        string
+    }
+
+    fn finish(mut self, root: usize) -> Vec<u8> {
+        self.set_offset(0, root);
+        self.pad_to(8, 0);
+        self.buf
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use arrow_array::cast::AsArray;
+    use arrow_array::types::{Int32Type, UInt8Type, UInt32Type, UInt64Type};
+    use arrow_ipc::reader::StreamReader;
+    use arrow_schema::DataType;
+
+    use super::*;
+
+    const FIELDS: &[(&str, ColumnType)] = &[
+        ("flag", ColumnType::Boolean),
+        ("kind", ColumnType::UInt8),
+        ("ordinal", ColumnType::UInt32),
+        ("type", ColumnType::Int32),
+        ("address", ColumnType::UInt64),
+        ("name", ColumnType::Utf8),
+    ];
+
+    fn batch(rows: usize) -> Vec<Column> {
+        let mut names = Column::new(ColumnType::Utf8);
+        for i in 0..rows {
+            names.push_str(&"x".repeat(i % 3));
+        }
+
+        vec![
+            Column::Boolean((0..rows).map(|i| i % 3 == 0).collect()),
+            Column::UInt8((0..rows).map(|i| i as u8).collect()),
+            Column::UInt32((0..rows).map(|i| i as u32 * 7).collect()),
+            Column::Int32((0..rows).map(|i| -(i as i32)).collect()),
+            Column::UInt64((0..rows).map(|i| u64::MAX - i as u64).collect()),
+            names,
+        ]
+    }
+
+    #[test]
+    fn stream_decodes_with_arrow_ipc() {
+        // Row counts chosen to cover an empty batch and partial bitmap bytes
+        let batches = [11, 0, 1];
+
+        let mut writer = ArrowStreamWriter::new(Vec::new(), FIELDS).unwrap();
+        for rows in batches {
+            writer.write_batch(&batch(rows)).unwrap();
+        }
+        let written = writer.bytes_written();
+        let stream = writer.finish().unwrap();
+        assert_eq!(stream.len() as u64, written + END_OF_STREAM_LEN);
+
+        let reader = StreamReader::try_new(stream.as_slice(), None).unwrap();
+
+        let schema = reader.schema();
+        let expected = [
+            DataType::Boolean,
+            DataType::UInt8,
+            DataType::UInt32,
+            DataType::Int32,
+            DataType::UInt64,
+            DataType::Utf8,
+        ];
+        assert_eq!(schema.fields().len(), FIELDS.len());
+        for ((field, (name, _)), data_type) in schema.fields().iter().zip(FIELDS).zip(&expected) {
+            assert_eq!(field.name(), name);
+            assert_eq!(field.data_type(), data_type);
+            assert!(!field.is_nullable());
+        }
+
+        let decoded = reader.collect::<Result<Vec<_>, _>>().unwrap();
+        assert_eq!(decoded.len(), batches.len());
+
+        for (record, rows) in decoded.iter().zip(batches) {
+            assert_eq!(record.num_rows(), rows);
+
+            let flags = record.column(0).as_boolean();
+            let kinds = record.column(1).as_primitive::<UInt8Type>();
+            let ordinals = record.column(2).as_primitive::<UInt32Type>();
+            let types = record.column(3).as_primitive::<Int32Type>();
+            let addresses = record.column(4).as_primitive::<UInt64Type>();
+            let names = record.column(5).as_string::<i32>();
+
+            for i in 0..rows {
+                assert_eq!(flags.value(i), i % 3 == 0);
+                assert_eq!(kinds.value(i), i as u8);
+                assert_eq!(ordinals.value(i), i as u32 * 7);
+                assert_eq!(types.value(i), -(i as i32));
+                assert_eq!(addresses.value(i), u64::MAX - i as u64);
+                assert_eq!(names.value(i), "x".repeat(i % 3));
+            }
+        }
+    }
+}
@@ -0,0 +1,454 @@
+//! Streaming export of database tables as Arrow IPC streams.
+//!
+//! Each table is written as a single stream (a schema followed by record
+//! batches of at most `ExportOptions::batch_rows` rows). Columns that are not
+//! selected are never read from the database.
+//!
+//! For the function, segment and xref tables, memory use is bounded by the
+//! batch size rather than by the size of the table. The name, string and type
+//! tables are not: each is first copied out in one call as a snapshot (see
+//! `NameList::snapshot`, `StringList::snapshot` and `TypeList::snapshot`),
+//! which is held, in full, until the table has been written.
+
+pub mod arrow;
+
+use std::io::Write;
+
+use crate::idb::IDB;
+use crate::xref::{XRefBuffer, XRefKinds, XRefQuery};
+use crate::{Address, IDAError};
+
+use arrow::{ArrowStreamWriter, Column, ColumnType};
+
+/// Number of addresses covered by each batched xref query.
+const XREF_WINDOW: Address = 0x10000;
+
+const FUNCTION_COLUMNS: &[(&str, ColumnType)] = &[
+    ("address", ColumnType::UInt64),
+    ("end", ColumnType::UInt64),
+    ("name", ColumnType::Utf8),
+    ("flags", ColumnType::UInt64),
+];
+
+const SEGMENT_COLUMNS: &[(&str, ColumnType)] = &[
+    ("address", ColumnType::UInt64),
+    ("end", ColumnType::UInt64),
+    ("name", ColumnType::Utf8),
+    ("type", ColumnType::UInt8),
+    ("permissions", ColumnType::UInt8),
+    ("alignment", ColumnType::UInt8),
+    ("bitness", ColumnType::UInt8),
+];
+
+const NAME_COLUMNS: &[(&str, ColumnType)] = &[
+    ("address", ColumnType::UInt64),
+    ("name", ColumnType::Utf8),
+    ("public", ColumnType::Boolean),
+    ("weak", ColumnType::Boolean),
+];
+
+const STRING_COLUMNS: &[(&str, ColumnType)] = &[
+    ("address", ColumnType::UInt64),
+    ("type", ColumnType::Int32),
+    ("length", ColumnType::UInt32),
+    ("value", ColumnType::Utf8),
+];
+
+const XREF_COLUMNS: &[(&str, ColumnType)] = &[
+    ("from", ColumnType::UInt64),
+    ("to", ColumnType::UInt64),
+    ("code", ColumnType::Boolean),
+    ("type", ColumnType::UInt8),
+    ("user", ColumnType::Boolean),
+];
+
+const TYPE_COLUMNS: &[(&str, ColumnType)] = &[
+    ("ordinal", ColumnType::UInt32),
+    ("name", ColumnType::Utf8),
+    ("kind", ColumnType::UInt8),
+    // u64::MAX if unknown
+    ("size", ColumnType::UInt64),
+];
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum ExportTable {
+    Functions,
+    Segments,
+    /// Held in memory in full while exporting.
+    Names,
+    /// Held in memory in full, contents included, while exporting.
+    Strings,
+    /// Code and data references from every item head, excluding ordinary
+    /// flow.
+    XRefs,
+    /// Held in memory in full while exporting.
+    Types,
+}
+
+impl ExportTable {
+    pub const ALL: [ExportTable; 6] = [
+        Self::Functions,
+        Self::Segments,
+        Self::Names,
+        Self::Strings,
+        Self::XRefs,
+        Self::Types,
+    ];
+
+    pub fn name(&self) -> &'static str {
+        match self {
+            Self::Functions => "functions",
+            Self::Segments => "segments",
+            Self::Names => "names",
+            Self::Strings => "strings",
+            Self::XRefs => "xrefs",
+            Self::Types => "types",
+        }
+    }
+
+    /// All columns of the table, with their types, in their default order.
+    pub fn columns(&self) -> &'static [(&'static str, ColumnType)] {
+        match self {
+            Self::Functions => FUNCTION_COLUMNS,
+            Self::Segments => SEGMENT_COLUMNS,
+            Self::Names => NAME_COLUMNS,
+            Self::Strings => STRING_COLUMNS,
+            Self::XRefs => XREF_COLUMNS,
+            Self::Types => TYPE_COLUMNS,
+        }
+    }
+}
+
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ExportOptions {
+    batch_rows: usize,
+    columns: Option<Vec<String>>,
+}
+
+impl Default for ExportOptions {
+    fn default() -> Self {
+        Self {
+            batch_rows: 64 * 1024,
+            columns: None,
+        }
+    }
+}
+
+impl ExportOptions {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Maximum number of rows per record batch.
+    pub fn batch_rows(&mut self, rows: usize) -> &mut Self {
+        self.batch_rows = rows.max(1);
+        self
+    }
+
+    /// Only export the named columns, in the given order.
+    pub fn columns<I, S>(&mut self, columns: I) -> &mut Self
+    where
+        I: IntoIterator<Item = S>,
+        S: AsRef<str>,
+    {
+        self.columns = Some(
+            columns
+                .into_iter()
+                .map(|column| column.as_ref().to_owned())
+                .collect(),
+        );
+        self
+    }
+
+    /// Export every column of the table (the default).
+    pub fn all_columns(&mut self) -> &mut Self {
+        self.columns = None;
+        self
+    }
+}
+
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ExportStats {
+    rows: u64,
+    batches: u64,
+    bytes: u64,
+}
+
+impl ExportStats {
+    pub fn rows(&self) -> u64 {
+        self.rows
+    }
+
+    pub fn batches(&self) -> u64 {
+        self.batches
+    }
+
+    /// Size of the stream written, in bytes.
+    pub fn bytes(&self) -> u64 {
+        self.bytes
+    }
+}
+
+pub(crate) fn export_table<W: Write>(
+    idb: &IDB,
+    table: ExportTable,
+    options: &ExportOptions,
+    out: W,
+) -> Result<ExportStats, IDAError> {
+    let mut batch = Batch::new(table, options, out)?;
+
+    match table {
+        ExportTable::Functions => export_functions(idb, &mut batch)?,
+        ExportTable::Segments => export_segments(idb, &mut batch)?,
+        ExportTable::Names => export_names(idb, &mut batch)?,
+        ExportTable::Strings => export_strings(idb, &mut batch)?,
+        ExportTable::XRefs => export_xrefs(idb, &mut batch)?,
+        ExportTable::Types => export_types(idb, &mut batch)?,
+    }
+
+    batch.finish()
+}
+
+// Column indices below refer to the table's entry in `ExportTable::columns`.
+
+fn export_functions<W: Write>(idb: &IDB, out: &mut Batch<W>) -> Result<(), IDAError> {
+    for (_, f) in idb.functions() {
+        out.push_u64(0, f.start_address());
+        out.push_u64(1, f.end_address());
+        if out.wants(2) {
+            out.push_str(2, f.name().as_deref().unwrap_or_default());
+        }
+        out.push_u64(3, f.flags().bits());
+        out.end_row()?;
+    }
+    Ok(())
+}
+
+fn export_segments<W: Write>(idb: &IDB, out: &mut Batch<W>) -> Result<(), IDAError> {
+    for (_, seg) in idb.segments() {
+        out.push_u64(0, seg.start_address());
+        out.push_u64(1, seg.end_address());
+        if out.wants(2) {
+            out.push_str(2, seg.name().as_deref().unwrap_or_default());
+        }
+        out.push_u8(3, seg.r#type() as u8);
+        out.push_u8(4, seg.permissions().bits());
+        out.push_u8(5, seg.alignment() as u8);
+        out.push_u8(6, seg.bitness() as u8);
+        out.end_row()?;
+    }
+    Ok(())
+}
+
+fn export_names<W: Write>(idb: &IDB, out: &mut Batch<W>) -> Result<(), IDAError> {
+    let names = idb.names().snapshot();
+
+    for name in names.iter() {
+        out.push_u64(0, name.address());
+        out.push_str(1, name.name());
+        out.push_bool(2, name.is_public());
+        out.push_bool(3, name.is_weak());
+        out.end_row()?;
+    }
+    Ok(())
+}
+
+fn export_strings<W: Write>(idb: &IDB, out: &mut Batch<W>) -> Result<(), IDAError> {
+    let strings = idb.strings().snapshot()?;
+
+    for string in strings.iter() {
+        out.push_u64(0, string.address());
+        out.push_i32(1, string.strtype());
+        out.push_u32(2, string.len() as u32);
+        if out.wants(3) {
+            out.push_str(3, &string.to_string_lossy());
+        }
+        out.end_row()?;
+    }
+    Ok(())
+}
+
+fn export_xrefs<W: Write>(idb: &IDB, out: &mut Batch<W>) -> Result<(), IDAError> {
+    let mut buf = XRefBuffer::new();
+
+    for (_, seg) in idb.segments() {
+        let end = seg.end_address();
+        let mut start = seg.start_address();
+
+        while start < end {
+            let stop = start.saturating_add(XREF_WINDOW).min(end);
+
+            buf.clear();
+            idb.xrefs_from_range_into(start, stop, XRefQuery::FAR, XRefKinds::All, &mut buf);
+
+            for xref in buf.iter() {
+                out.push_u64(0, xref.from());
+                out.push_u64(1, xref.to());
+                out.push_bool(2, xref.is_code());
+                out.push_u8(3, xref.raw_type());
+                out.push_bool(4, xref.is_user_defined());
+                out.end_row()?;
+            }
+
+            start = stop;
+        }
+    }
+    Ok(())
+}
+
+fn export_types<W: Write>(idb: &IDB, out: &mut Batch<W>) -> Result<(), IDAError> {
+    let types = idb.types().snapshot_with(out.wants(3), false);
+
+    for ty in types.iter() {
+        out.push_u32(0, ty.ordinal());
+        out.push_str(1, ty.name());
+        out.push_u8(2, ty.kind() as u8);
+        out.push_u64(3, ty.size().unwrap_or(u64::MAX));
+        out.end_row()?;
+    }
+    Ok(())
+}
+
+/// Accumulates the selected columns of a table and writes them out every
+/// `batch_rows` rows.
+struct Batch<W: Write> {
+    writer: ArrowStreamWriter<W>,
+    // Table column index to position in `columns`, if selected
+    selected: Vec<Option<usize>>,
+    columns: Vec<Column>,
+    rows: usize,
+    batch_rows: usize,
+    stats: ExportStats,
+}
+
+impl<W: Write> Batch<W> {
+    fn new(table: ExportTable, options: &ExportOptions, out: W) -> Result<Self, IDAError> {
+        let all = table.columns();
+        let mut selected = vec![None; all.len()];
+        let mut fields = Vec::with_capacity(all.len());
+
+        match &options.columns {
+            None => {
+                for (i, field) in all.iter().enumerate() {
+                    selected[i] = Some(i);
+                    fields.push(*field);
+                }
+            }
+            Some(names) => {
+                for name in names {
+                    let Some(i) = all.iter().position(|(column, _)| column == name) else {
+                        return Err(IDAError::ffi_with(format!(
+                            "table `{}` has no column `{name}`",
+                            table.name()
+                        )));
+                    };
+
+                    if selected[i].is_none() {
+                        selected[i] = Some(fields.len());
+                        fields.push(all[i]);
+                    }
+                }
+            }
+        }
+
+        if fields.is_empty() {
+            return Err(IDAError::ffi_with(format!(
+                "no columns selected for table `{}`",
+                table.name()
+            )));
+        }
+
+        let columns = fields.iter().map(|(_, kind)| Column::new(*kind)).collect();
+        let writer = ArrowStreamWriter::new(out, &fields).map_err(IDAError::ffi)?;
+
+        Ok(Self {
+            writer,
+            selected,
+            columns,
+            rows: 0,
+            batch_rows: options.batch_rows,
+            stats: ExportStats::default(),
+        })
+    }
+
+    fn wants(&self, column: usize) -> bool {
+        self.selected[column].is_some()
+    }
+
+    fn column(&mut self, column: usize) -> Option<&mut Column> {
+        self.selected[column].map(|i| &mut self.columns[i])
+    }
+
+    fn push_bool(&mut self, column: usize, value: bool) {
+        if let Some(Column::Boolean(values)) = self.column(column) {
+            values.push(value);
+        }
+    }
+
+    fn push_u8(&mut self, column: usize, value: u8) {
+        if let Some(Column::UInt8(values)) = self.column(column) {
+            values.push(value);
+        }
+    }
+
+    fn push_u32(&mut self, column: usize, value: u32) {
+        if let Some(Column::UInt32(values)) = self.column(column) {
+            values.push(value);
+        }
+    }
+
+    fn push_i32(&mut self, column: usize, value: i32) {
+        if let Some(Column::Int32(values)) = self.column(column) {
+            values.push(value);
+        }
+    }
+
+    fn push_u64(&mut self, column: usize, value: u64) {
+        if let Some(Column::UInt64(values)) = self.column(column) {
+            values.push(value);
+        }
+    }
+
+    fn push_str(&mut self, column: usize, value: &str) {
+        if let Some(values) = self.column(column) {
+            values.push_str(value);
+        }
+    }
+
+    fn end_row(&mut self) -> Result<(), IDAError> {
+        self.rows += 1;
+        if self.rows >= self.batch_rows {
+            self.flush()?;
+        }
+        Ok(())
+    }
+
+    fn flush(&mut self) -> Result<(), IDAError> {
+        if self.rows == 0 {
+            return Ok(());
+        }
+
+        self.writer
+            .write_batch(&self.columns)
+            .map_err(IDAError::ffi)?;
+
+        self.columns.iter_mut().for_each(Column::clear);
+
+        self.stats.rows += self.rows as u64;
+        self.stats.batches += 1;
+        self.rows = 0;
+
+        Ok(())
+    }
+
+    fn finish(mut self) -> Result<ExportStats, IDAError> {
+        self.flush()?;
+
+        let mut stats = self.stats;
+        stats.bytes = self.writer.bytes_written() + arrow::END_OF_STREAM_LEN;
+
+        self.writer.finish().map_err(IDAError::ffi)?;
+
+        Ok(stats)
+    }
+}
@@ -0,0 +1,237 @@
+use crate::ffi::func::{func_features_t, idalib_func_features};
+
+use crate::Address;
+use crate::instrument::{self, Subsystem};
+
+/// The fixed columns of a function feature vector; the mnemonic histogram
+/// follows in the remaining columns.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+#[repr(u32)]
+pub enum Feature {
+    Instructions,
+    Bytes,
+    BasicBlocks,
+    Edges,
+    ExitBlocks,
+    Calls,
+    Callers,
+    Constants,
+    MemoryOperands,
+    Chunks,
+}
+
+impl Feature {
+    /// Number of fixed columns; the first mnemonic histogram bucket is at
+    /// this index.
+    pub const COUNT: usize = 10;
+
+    pub const ALL: [Feature; Self::COUNT] = [
+        Self::Instructions,
+        Self::Bytes,
+        Self::BasicBlocks,
+        Self::Edges,
+        Self::ExitBlocks,
+        Self::Calls,
+        Self::Callers,
+        Self::Constants,
+        Self::MemoryOperands,
+        Self::Chunks,
+    ];
+
+    pub fn index(self) -> usize {
+        self as usize
+    }
+}
+
+/// Controls the shape of the vectors and sketches built by
+/// [`IDB::function_features`](crate::idb::IDB::function_features).
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct FeatureOptions {
+    mnemonic_buckets: u32,
+    minhash_size: u32,
+    shingle: u32,
+}
+
+impl Default for FeatureOptions {
+    fn default() -> Self {
+        Self {
+            mnemonic_buckets: 32,
+            minhash_size: 64,
+            shingle: 3,
+        }
+    }
+}
+
+impl FeatureOptions {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Number of columns the mnemonic histogram is hashed into; 0 leaves
+    /// only the fixed features.
+    pub fn mnemonic_buckets(&mut self, buckets: u32) -> &mut Self {
+        self.mnemonic_buckets = buckets;
+        self
+    }
+
+    /// Number of MinHash values kept per function.
+    pub fn minhash_size(&mut self, size: u32) -> &mut Self {
+        self.minhash_size = size;
+        self
+    }
+
+    /// Number of consecutive mnemonics hashed into each sketch token.
+    pub fn shingle(&mut self, length: u32) -> &mut Self {
+        self.shingle = length.max(1);
+        self
+    }
+
+    pub fn dimensions(&self) -> usize {
+        Feature::COUNT + self.mnemonic_buckets as usize
+    }
+}
+
+/// Feature vectors and MinHash/SimHash sketches of a set of functions,
+/// computed in a single native pass.
+///
+/// Vectors are stored row-major as one contiguous `f32` buffer and MinHash
+/// signatures likewise as one `u64` buffer, so either can be handed to an
+/// approximate nearest neighbour index without copying.
+#[derive(Debug, Clone, Default)]
+pub struct FunctionFeatures {
+    dims: usize,
+    minhash_size: usize,
+    starts: Vec<Address>,
+    vectors: Vec<f32>,
+    minhash: Vec<u64>,
+    simhash: Vec<u64>,
+    tokens: Vec<u32>,
+}
+
+impl FunctionFeatures {
+    /// Computes features of the functions starting at `functions`, or of
+    /// every function if `functions` is empty.
+    pub(crate) fn new(functions: &[Address], options: &FeatureOptions) -> Self {
+        let _ffi = instrument::scope(Subsystem::Funcs, "function_features");
+        let mut out = func_features_t::default();
+
+        unsafe {
+            idalib_func_features(
+                functions,
+                options.mnemonic_buckets,
+                options.minhash_size,
+                options.shingle,
+                &mut out,
+            )
+        };
+
+        Self {
+            dims: out.dims as usize,
+            minhash_size: out.minhash_size as usize,
+            starts: out.starts,
+            vectors: out.vectors,
+            minhash: out.minhash,
+            simhash: out.simhash,
+            tokens: out.tokens,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.starts.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.starts.is_empty()
+    }
+
+    /// Number of columns of each feature vector.
+    pub fn dimensions(&self) -> usize {
+        self.dims
+    }
+
+    pub fn minhash_size(&self) -> usize {
+        self.minhash_size
+    }
+
+    /// Start addresses of the functions, in row order.
+    pub fn addresses(&self) -> &[Address] {
+        &self.starts
+    }
+
+    /// Row of the function starting at `start`.
+    pub fn position(&self, start: Address) -> Option<usize> {
+        self.starts.iter().position(|ea| *ea == start)
+    }
+
+    /// All feature vectors, `dimensions()` values per function.
+    pub fn vectors(&self) -> &[f32] {
+        &self.vectors
+    }
+
+    pub fn vector(&self, row: usize) -> Option<&[f32]> {
+        let start = row.checked_mul(self.dims)?;
+        self.vectors.get(start..start + self.dims)
+    }
+
+    pub fn feature(&self, row: usize, feature: Feature) -> Option<f32> {
+        self.vector(row)?.get(feature.index()).copied()
+    }
+
+    /// The values of a single column across all functions.
+    pub fn column(&self, column: usize) -> impl ExactSizeIterator<Item = f32> + '_ {
+        let count = if column < self.dims { self.len() } else { 0 };
+        (0..count).map(move |row| self.vectors[row * self.dims + column])
+    }
+
+    /// The mnemonic histogram part of the vector at `row`.
+    pub fn mnemonic_histogram(&self, row: usize) -> Option<&[f32]> {
+        Some(&self.vector(row)?[Feature::COUNT..])
+    }
+
+    /// All MinHash signatures, `minhash_size()` values per function.
+    pub fn minhashes(&self) -> &[u64] {
+        &self.minhash
+    }
+
+    pub fn minhash(&self, row: usize) -> Option<&[u64]> {
+        let start = row.checked_mul(self.minhash_size)?;
+        self.minhash.get(start..start + self.minhash_size)
+    }
+
+    /// Number of distinct sketch tokens (mnemonic shingles and constants)
+    /// of the function at `row`; the MinHash signature of a function
+    /// without any carries no information.
+    pub fn token_count(&self, row: usize) -> Option<usize> {
+        self.tokens.get(row).map(|count| *count as usize)
+    }
+
+    /// All 64-bit SimHash sketches, one per function.
+    pub fn simhashes(&self) -> &[u64] {
+        &self.simhash
+    }
+
+    pub fn simhash(&self, row: usize) -> Option<u64> {
+        self.simhash.get(row).copied()
+    }
+
+    /// Estimated Jaccard similarity of the sketch tokens of two functions:
+    /// the fraction of MinHash values they share, or 0 if either function
+    /// has no tokens.
+    pub fn minhash_similarity(&self, a: usize, b: usize) -> Option<f64> {
+        let tokens = (self.token_count(a)?, self.token_count(b)?);
+        let (a, b) = (self.minhash(a)?, self.minhash(b)?);
+
+        if a.is_empty() || tokens.0 == 0 || tokens.1 == 0 {
+            return Some(0.0);
+        }
+
+        let same = a.iter().zip(b).filter(|(x, y)| x == y).count();
+        Some(same as f64 / a.len() as f64)
+    }
+
+    /// Number of differing bits between the SimHash sketches of two
+    /// functions.
+    pub fn simhash_distance(&self, a: usize, b: usize) -> Option<u32> {
+        Some((self.simhash(a)? ^ self.simhash(b)?).count_ones())
+    }
+}
@@ -0,0 +1,291 @@
+use std::ops::Range;
+
+use crate::Address;
+use crate::ffi::bytes::{flags_map_t, idalib_get_flags_map};
+use crate::instrument::{self, Subsystem};
+
+/// A per-byte classification, each held as its own plane of a `FlagsMap`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum ByteClass {
+    /// Part of an instruction
+    Code,
+    /// Part of a data item
+    Data,
+    /// The first byte of an item
+    Head,
+    /// Any byte of an item but the first
+    Tail,
+    /// Unexplored
+    Unknown,
+}
+
+impl ByteClass {
+    pub const COUNT: usize = 5;
+
+    pub const ALL: [Self; Self::COUNT] = [
+        Self::Code,
+        Self::Data,
+        Self::Head,
+        Self::Tail,
+        Self::Unknown,
+    ];
+
+    pub fn index(&self) -> usize {
+        *self as usize
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum SpanKind {
+    Code,
+    Data,
+    /// An item that is neither code nor data
+    Other,
+    /// A run of unexplored bytes
+    Unknown,
+}
+
+impl SpanKind {
+    fn from_raw(raw: u8) -> Self {
+        match raw {
+            0 => Self::Code,
+            1 => Self::Data,
+            2 => Self::Other,
+            _ => Self::Unknown,
+        }
+    }
+}
+
+/// An item, or a run of unexplored bytes, within a `FlagsMap`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct ItemSpan {
+    pub start: Address,
+    pub end: Address,
+    pub kind: SpanKind,
+}
+
+impl ItemSpan {
+    pub fn len(&self) -> u64 {
+        self.end - self.start
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.start == self.end
+    }
+}
+
+/// Classification of every byte of a range, as one bitmap per `ByteClass`,
+/// built in a single native pass over the range's items.
+///
+/// Each bitmap is a plane of 64-bit words (bit `i` of the range is bit
+/// `i % 64` of word `i / 64`), so planes can be combined a word at a time;
+/// see `Bitmap`.
+#[derive(Debug, Clone)]
+pub struct FlagsMap {
+    raw: flags_map_t,
+}
+
+impl FlagsMap {
+    pub(crate) fn new(start: Address, end: Address, spans: bool) -> Self {
+        let _ffi = instrument::scope(Subsystem::Bytes, "flags_map");
+
+        let mut raw = flags_map_t::default();
+        unsafe { idalib_get_flags_map(start.into(), end.into(), spans, &mut raw) };
+
+        Self { raw }
+    }
+
+    pub fn start_address(&self) -> Address {
+        self.raw.start
+    }
+
+    pub fn end_address(&self) -> Address {
+        self.raw.end
+    }
+
+    pub fn len(&self) -> u64 {
+        self.raw.end - self.raw.start
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.raw.start == self.raw.end
+    }
+
+    /// The words of the bitmap for `class`.
+    pub fn plane(&self, class: ByteClass) -> &[u64] {
+        let words = self.raw.words as usize;
+        &self.raw.bits[class.index() * words..][..words]
+    }
+
+    /// A copy of the bitmap for `class`, to combine with others.
+    pub fn bitmap(&self, class: ByteClass) -> Bitmap {
+        Bitmap {
+            start: self.raw.start,
+            len: self.len(),
+            words: self.plane(class).to_vec(),
+        }
+    }
+
+    pub fn contains(&self, class: ByteClass, ea: Address) -> bool {
+        if ea < self.raw.start || ea >= self.raw.end {
+            return false;
+        }
+        let i = ea - self.raw.start;
+        self.plane(class)[(i / 64) as usize] & (1 << (i % 64)) != 0
+    }
+
+    /// Number of bytes of `class`.
+    pub fn count(&self, class: ByteClass) -> u64 {
+        self.plane(class)
+            .iter()
+            .map(|w| w.count_ones() as u64)
+            .sum()
+    }
+
+    pub fn span_count(&self) -> usize {
+        self.raw.span_starts.len()
+    }
+
+    /// The items and runs of unexplored bytes covering the range, in order;
+    /// empty unless the map was built with spans.
+    pub fn spans(&self) -> impl ExactSizeIterator<Item = ItemSpan> + '_ {
+        let starts = &self.raw.span_starts;
+        (0..starts.len()).map(move |i| ItemSpan {
+            start: starts[i],
+            end: starts.get(i + 1).copied().unwrap_or(self.raw.end),
+            kind: SpanKind::from_raw(self.raw.span_kinds[i]),
+        })
+    }
+}
+
+/// A bitmap over a range of addresses, one bit per byte.
+///
+/// The combining operations work a word at a time over plain slices, which
+/// the compiler vectorises.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Bitmap {
+    start: Address,
+    len: u64,
+    words: Vec<u64>,
+}
+
+impl Bitmap {
+    /// An empty bitmap over `range`.
+    pub fn new(range: Range<Address>) -> Self {
+        let len = range.end.saturating_sub(range.start);
+        Self {
+            start: range.start,
+            len,
+            words: vec![0; len.div_ceil(64) as usize],
+        }
+    }
+
+    pub fn start_address(&self) -> Address {
+        self.start
+    }
+
+    pub fn end_address(&self) -> Address {
+        self.start + self.len
+    }
+
+    pub fn len(&self) -> u64 {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    pub fn words(&self) -> &[u64] {
+        &self.words
+    }
+
+    pub fn contains(&self, ea: Address) -> bool {
+        if ea < self.start || ea >= self.end_address() {
+            return false;
+        }
+        let i = ea - self.start;
+        self.words[(i / 64) as usize] & (1 << (i % 64)) != 0
+    }
+
+    pub fn count_ones(&self) -> u64 {
+        self.words.iter().map(|w| w.count_ones() as u64).sum()
+    }
+
+    /// Keep only the bits also set in `other`, which must cover the same
+    /// range.
+    pub fn and(&mut self, other: &Bitmap) -> &mut Self {
+        self.combine(other, |a, b| a & b)
+    }
+
+    pub fn or(&mut self, other: &Bitmap) -> &mut Self {
+        self.combine(other, |a, b| a | b)
+    }
+
+    /// Clear the bits set in `other`.
+    pub fn and_not(&mut self, other: &Bitmap) -> &mut Self {
+        self.combine(other, |a, b| a & !b)
+    }
+
+    pub fn invert(&mut self) -> &mut Self {
+        for w in &mut self.words {
+            *w = !*w;
+        }
+        self.clear_trailing();
+        self
+    }
+
+    /// The runs of set bits, as `[start, end)` address ranges in order.
+    pub fn runs(&self) -> impl Iterator<Item = Range<Address>> + '_ {
+        let mut i = 0u64;
+        std::iter::from_fn(move || {
+            let from = self.next_bit(i, true)?;
+            let to = self.next_bit(from, false).unwrap_or(self.len);
+            i = to;
+            Some(self.start + from..self.start + to)
+        })
+    }
+
+    // The index of the first bit at or after `from` that is `set`.
+    fn next_bit(&self, from: u64, set: bool) -> Option<u64> {
+        let mut w = (from / 64) as usize;
+        if w >= self.words.len() {
+            return None;
+        }
+
+        let flip = |word: u64| if set { word } else { !word };
+        let mut word = flip(self.words[w]) & (!0u64 << (from % 64));
+
+        loop {
+            if word != 0 {
+                let i = w as u64 * 64 + word.trailing_zeros() as u64;
+                return (i < self.len).then_some(i);
+            }
+            w += 1;
+            if w >= self.words.len() {
+                return None;
+            }
+            word = flip(self.words[w]);
+        }
+    }
+
+    fn combine(&mut self, other: &Bitmap, op: impl Fn(u64, u64) -> u64) -> &mut Self {
+        assert!(
+            self.start == other.start && self.len == other.len,
+            "bitmaps cover different ranges"
+        );
+        for (a, b) in self.words.iter_mut().zip(&other.words) {
+            *a = op(*a, *b);
+        }
+        self
+    }
+
+    fn clear_trailing(&mut self) {
+        let rest = self.len % 64;
+        if rest != 0 {
+            if let Some(last) = self.words.last_mut() {
+                *last &= (1u64 << rest) - 1;
+            }
+        }
+    }
+}
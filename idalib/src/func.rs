@@ -10,12 +10,15 @@ use bitflags::bitflags;
 use cxx::UniquePtr;
 
 use crate::ffi::func::*;
+use crate::ffi::insn::idalib_decode_func;
 use crate::ffi::xref::has_external_refs;
 use crate::ffi::{range_t, IDAError, BADADDR};
 use crate::ffi::types::{
     idalib_get_type_ordinal_at_address,
 };
 use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
+use crate::insn::InsnBatch;
 use crate::types::{Type, TypeFlags};
 use crate::Address;
 
@@ -234,6 +237,7 @@ impl<'a> Function<'a> {
     }
 
     pub fn name(&self) -> Option<String> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "function_name");
         let name = unsafe { idalib_func_name(self.ptr) }.ok()?;
 
         if name.is_empty() {
@@ -244,6 +248,7 @@ impl<'a> Function<'a> {
     }
 
     pub fn set_name(&mut self, name: impl AsRef<str>) -> Result<(), IDAError> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "set_function_name");
         let c_name = CString::new(name.as_ref()).map_err(IDAError::ffi)?;
         let success = unsafe { idalib_func_set_name(self.ptr, c_name.as_ptr(), c_int(0)) };
         if success {
@@ -257,6 +262,7 @@ impl<'a> Function<'a> {
     }
 
     pub fn set_name_with_flags(&mut self, name: impl AsRef<str>, flags: NameFlags) -> Result<(), IDAError> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "set_function_name");
         let c_name = CString::new(name.as_ref()).map_err(IDAError::ffi)?;
         let success = unsafe { idalib_func_set_name(self.ptr, c_name.as_ptr(), c_int(flags.bits())) };
         if success {
@@ -270,6 +276,7 @@ impl<'a> Function<'a> {
     }
 
     pub fn flags(&self) -> FunctionFlags {
+        let _ffi = instrument::scope(Subsystem::Funcs, "function_flags");
         let bits = unsafe { idalib_func_flags(self.ptr) };
         FunctionFlags::from_bits_retain(bits)
     }
@@ -283,6 +290,7 @@ impl<'a> Function<'a> {
     }
 
     pub fn set_noret(&mut self, noret: bool) {
+        let _ffi = instrument::scope(Subsystem::Funcs, "set_noret");
         unsafe { idalib_func_set_noret(self.ptr, noret) };
     }
 
@@ -295,10 +303,12 @@ impl<'a> Function<'a> {
     }
 
     pub fn has_external_refs(&self, ea: Address) -> bool {
+        let _ffi = instrument::scope(Subsystem::XRefs, "has_external_refs");
         unsafe { has_external_refs(self.ptr, ea.into()) }
     }
 
     pub fn calc_thunk_target(&self) -> Option<Address> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "calc_thunk_target");
         let addr = unsafe { calc_thunk_func_target(self.ptr, ptr::null_mut()) };
 
         if addr == BADADDR {
@@ -313,6 +323,7 @@ impl<'a> Function<'a> {
     }
 
     pub fn cfg_with(&self, flags: FunctionCFGFlags) -> Result<FunctionCFG, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "cfg_with");
         let ptr = unsafe { idalib_func_flow_chart(self.ptr, flags.bits().into()) };
 
         Ok(FunctionCFG {
@@ -321,8 +332,30 @@ impl<'a> Function<'a> {
         })
     }
 
+    /// Build the flow chart and copy it out in one call; see `FlatCFG` and
+    /// `IDB::flat_cfg` for a cached variant.
+    pub fn flat_cfg_with(&self, flags: FunctionCFGFlags) -> Result<FlatCFG, IDAError> {
+        FlatCFG::new(self, flags)
+    }
+
+    /// Decodes every instruction of the function, including its tail chunks,
+    /// in one call.
+    pub fn decode(&self) -> Result<InsnBatch, IDAError> {
+        let mut batch = InsnBatch::new();
+        self.decode_into(&mut batch)?;
+        Ok(batch)
+    }
+
+    /// As `decode`, appending to `batch`; returns the number of instructions
+    /// appended.
+    pub fn decode_into(&self, batch: &mut InsnBatch) -> Result<usize, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "decode_func");
+        unsafe { idalib_decode_func(self.ptr, batch.raw_mut()) }.map_err(IDAError::ffi)
+    }
+
     /// Get the type assigned to this function, if any
     pub fn get_type(&self) -> Option<Type> {
+        let _ffi = instrument::scope(Subsystem::Types, "function_type");
         let ordinal = unsafe { idalib_get_type_ordinal_at_address(self.start_address().into()) };
         if ordinal == 0 {
             None
@@ -398,3 +431,136 @@ impl<'a> FunctionCFG<'a> {
         (0..self.blocks_count()).map(|id| self.block_by_id(id).expect("valid block"))
     }
 }
+
+/// A function's flow chart flattened into plain arrays.
+///
+/// Blocks are indexed by `BasicBlockId`; successors and predecessors are
+/// stored in compressed sparse row form, so the edges of every block are
+/// available without further calls into IDA. This does not borrow the
+/// database and can be shared across threads.
+#[derive(Debug, Clone, Default)]
+pub struct FlatCFG {
+    starts: Vec<Address>,
+    ends: Vec<Address>,
+    kinds: Vec<i32>,
+    succ_offsets: Vec<u32>,
+    succs: Vec<u32>,
+    pred_offsets: Vec<u32>,
+    preds: Vec<u32>,
+    entry: Option<BasicBlockId>,
+    exit: Option<BasicBlockId>,
+}
+
+impl FlatCFG {
+    pub(crate) fn new(f: &Function, flags: FunctionCFGFlags) -> Result<Self, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "flat_cfg");
+        let mut cfg = func_cfg_t::default();
+
+        unsafe { idalib_func_flow_chart_flat(f.as_ptr(), flags.bits().into(), &mut cfg) }
+            .map_err(IDAError::ffi)?;
+
+        Ok(Self {
+            starts: cfg.starts,
+            ends: cfg.ends,
+            kinds: cfg.kinds,
+            succ_offsets: cfg.succ_offsets,
+            succs: cfg.succs,
+            pred_offsets: cfg.pred_offsets,
+            preds: cfg.preds,
+            entry: (cfg.entry >= 0).then_some(cfg.entry as _),
+            exit: (cfg.exit >= 0).then_some(cfg.exit as _),
+        })
+    }
+
+    pub fn blocks_count(&self) -> usize {
+        self.starts.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.starts.is_empty()
+    }
+
+    pub fn entry(&self) -> Option<BasicBlockId> {
+        self.entry
+    }
+
+    pub fn exit(&self) -> Option<BasicBlockId> {
+        self.exit
+    }
+
+    pub fn start_address(&self, id: BasicBlockId) -> Address {
+        self.starts[id]
+    }
+
+    pub fn end_address(&self, id: BasicBlockId) -> Address {
+        self.ends[id]
+    }
+
+    /// Finds the block containing `addr`, if any.
+    pub fn block_containing(&self, addr: Address) -> Option<BasicBlockId> {
+        (0..self.blocks_count()).find(|id| self.starts[*id] <= addr && addr < self.ends[*id])
+    }
+
+    pub fn succs(&self, id: BasicBlockId) -> &[u32] {
+        let (start, end) = (self.succ_offsets[id], self.succ_offsets[id + 1]);
+        &self.succs[start as usize..end as usize]
+    }
+
+    /// Empty for every block if the flow chart was built with
+    /// `FunctionCFGFlags::NOPREDS`.
+    pub fn preds(&self, id: BasicBlockId) -> &[u32] {
+        let (start, end) = (self.pred_offsets[id], self.pred_offsets[id + 1]);
+        &self.preds[start as usize..end as usize]
+    }
+
+    pub fn is_normal(&self, id: BasicBlockId) -> bool {
+        self.kinds[id] == fc_block_type_t::fcb_normal as i32
+    }
+
+    pub fn is_indjump(&self, id: BasicBlockId) -> bool {
+        self.kinds[id] == fc_block_type_t::fcb_indjump as i32
+    }
+
+    pub fn is_ret(&self, id: BasicBlockId) -> bool {
+        self.kinds[id] == fc_block_type_t::fcb_ret as i32
+    }
+
+    pub fn is_cndret(&self, id: BasicBlockId) -> bool {
+        self.kinds[id] == fc_block_type_t::fcb_cndret as i32
+    }
+
+    pub fn is_noret(&self, id: BasicBlockId) -> bool {
+        self.kinds[id] == fc_block_type_t::fcb_noret as i32
+    }
+
+    pub fn is_enoret(&self, id: BasicBlockId) -> bool {
+        self.kinds[id] == fc_block_type_t::fcb_enoret as i32
+    }
+
+    pub fn is_extern(&self, id: BasicBlockId) -> bool {
+        self.kinds[id] == fc_block_type_t::fcb_extern as i32
+    }
+
+    pub fn is_error(&self, id: BasicBlockId) -> bool {
+        self.kinds[id] == fc_block_type_t::fcb_error as i32
+    }
+
+    /// Raw CSR arrays: `(offsets, targets)`, where the successors of block
+    /// `i` are `targets[offsets[i]..offsets[i + 1]]`.
+    pub fn succs_csr(&self) -> (&[u32], &[u32]) {
+        (&self.succ_offsets, &self.succs)
+    }
+
+    /// Raw CSR arrays for predecessors; see `succs_csr`.
+    pub fn preds_csr(&self) -> (&[u32], &[u32]) {
+        (&self.pred_offsets, &self.preds)
+    }
+
+    pub fn start_addresses(&self) -> &[Address] {
+        &self.starts
+    }
+
+    pub fn end_addresses(&self) -> &[Address] {
+        &self.ends
+    }
+}
@@ -1,7 +1,13 @@
+use std::cell::RefCell;
 use std::ffi::CString;
+use std::io::Write;
 use std::marker::PhantomData;
 use std::mem::MaybeUninit;
+use std::num::NonZeroUsize;
+use std::ops::ControlFlow;
 use std::path::{Path, PathBuf};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
 
 use autocxx::c_int;
 
@@ -11,12 +17,16 @@ use crate::ffi::comments::{append_cmt, idalib_get_cmt, set_cmt};
 use crate::ffi::conversions::idalib_ea2str;
 use crate::ffi::entry::{get_entry, get_entry_ordinal, get_entry_qty};
 use crate::ffi::func::{get_func, get_fchunk, get_func_qty, getn_func};
-use crate::ffi::hexrays::{decompile_func, init_hexrays_plugin, term_hexrays_plugin};
+use crate::ffi::hexrays::{
+    decompile_func, idalib_hexrays_mark_cfunc_dirty, init_hexrays_plugin, term_hexrays_plugin,
+};
 use crate::ffi::ida::{
-    auto_wait, close_database_with, make_signatures, open_database_quiet, set_screen_ea,
+    auto_step, auto_wait, auto_wait_profiled, close_database_with, idalib_auto_is_done,
+    idalib_auto_pending_in, idalib_auto_queue_depths, make_signatures, open_database_profiled,
+    open_database_quiet, open_profile_t, save_database_copy, set_screen_ea,
 };
 use crate::ffi::insn::decode;
-use crate::ffi::loader::find_plugin;
+use crate::ffi::loader::{find_plugin, idalib_get_database_path};
 use crate::ffi::name::idalib_set_name;
 use crate::ffi::processor::get_ph;
 use crate::ffi::search::{idalib_find_defined, idalib_find_imm, idalib_find_text};
@@ -28,31 +38,65 @@ use crate::ffi::types::{
 use crate::ffi::util::{is_align_insn, next_head, prev_head, str2reg};
 use crate::ffi::xref::{xrefblk_t, xrefblk_t_first_from, xrefblk_t_first_to};
 
+use crate::annotations::{AnnotationReport, Annotations};
+use crate::auto::{AutoBudget, AutoCancel, AutoProgress, AutoQueueDepth, AutoStageTime};
 use crate::bookmarks::Bookmarks;
-use crate::decompiler::CFunction;
-use crate::func::{Function, FunctionId, NameFlags};
-use crate::insn::{Insn, Register};
-use crate::meta::{Metadata, MetadataMut};
+use crate::bytes::{self, ByteChunks, PatchReport, Patches};
+use crate::cache::LruCache;
+use crate::callgraph::CallGraph;
+use crate::decompiler::{CFunction, DecompileBatch, DecompileBatchOptions};
+use crate::export::{self, ExportOptions, ExportStats, ExportTable};
+use crate::features::{FeatureOptions, FunctionFeatures};
+use crate::flags::FlagsMap;
+use crate::func::{FlatCFG, Function, FunctionCFGFlags, FunctionId, NameFlags};
+use crate::insn::{self, DecodeMode, Insn, InsnBatch, Register};
+use crate::instrument::{self, Subsystem};
+use crate::memory::MemoryUsage;
+use crate::meta::{Metadata, MetadataMut, MetadataSnapshot};
+use crate::microcode::{Maturity, Microcode};
 use crate::name::NameList;
 use crate::plugin::Plugin;
 use crate::processor::Processor;
+use crate::scan::{ByteImage, PatternSet, ScanHit, scan_images};
 use crate::segment::{Segment, SegmentId};
 use crate::strings::StringList;
+use crate::template::TemplateUse;
 use crate::types::{Type, TypeList};
-use crate::xref::{XRef, XRefQuery};
-use crate::{Address, AddressFlags, IDAError, IDARuntimeHandle, prepare_library};
+use crate::xref::{XRef, XRefBuffer, XRefKinds, XRefQuery};
+use crate::{Address, AddressFlags, IDAError, IDARuntimeHandle, init_library, prepare_library};
+
+/// Number of flattened flow charts kept by `IDB::flat_cfg` by default.
+pub const DEFAULT_CFG_CACHE_CAPACITY: usize = 256;
+
+/// Longest stretch `IDB::auto_run` analyses between progress reports.
+const AUTO_RUN_SLICE: Duration = Duration::from_millis(10);
 
 pub struct IDB {
     path: PathBuf,
     save: bool,
     decompiler: bool,
+    cfg_cache: RefCell<LruCache<(Address, i32), (u32, Arc<FlatCFG>)>>,
+    remove_on_close: Option<PathBuf>,
     _guard: IDARuntimeHandle,
     _marker: PhantomData<*const ()>,
 }
 
+/// How the database is stored when it is saved on close.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum DatabasePacking {
+    /// Pack the unpacked components into the database and compress it
+    /// (`-P+`)
+    Compressed,
+    /// Pack the unpacked components into the database (`-P`)
+    Packed,
+    /// Leave the components unpacked next to the database (`-P-`)
+    Unpacked,
+}
+
 #[derive(Debug, Clone)]
 pub struct IDBOpenOptions {
     idb: Option<PathBuf>,
+    work_dir: Option<PathBuf>,
 
     #[allow(dead_code)]
     // NOTE: the file type is only supported in IDA 9.2 and later;
@@ -60,15 +104,22 @@ pub struct IDBOpenOptions {
 
     save: bool,
     auto_analyse: bool,
+    packing: Option<DatabasePacking>,
+    page_size: Option<u32>,
+    directives: Vec<String>,
 }
 
 impl Default for IDBOpenOptions {
     fn default() -> Self {
         Self {
             idb: None,
+            work_dir: None,
             ftype: None,
             save: false,
             auto_analyse: true,
+            packing: None,
+            page_size: None,
+            directives: Vec::new(),
         }
     }
 }
@@ -107,7 +158,85 @@ impl IDBOpenOptions {
         self
     }
 
+    /// Create the database, and so the files it is unpacked into while
+    /// open, in `dir` rather than next to the input; e.g., a tmpfs to keep
+    /// the kernel's page cache off disk, at the cost of holding it in
+    /// memory. Ignored if an explicit `idb` path is given.
+    pub fn work_dir(&mut self, dir: impl AsRef<Path>) -> &mut Self {
+        self.work_dir = Some(dir.as_ref().to_owned());
+        self
+    }
+
+    pub(crate) fn work_dir_path(&self) -> Option<&Path> {
+        self.work_dir.as_deref()
+    }
+
+    /// How to store the database when it is saved on close (default: as
+    /// configured in `ida.cfg`).
+    pub fn packing(&mut self, packing: DatabasePacking) -> &mut Self {
+        self.packing = Some(packing);
+        self
+    }
+
+    /// Size of the pages the kernel's B-tree reads and caches
+    /// (`VPAGESIZE`, a power of two); larger pages mean fewer reads and a
+    /// larger cache. Only applies to new databases.
+    pub fn page_size(&mut self, bytes: u32) -> &mut Self {
+        self.page_size = Some(bytes);
+        self
+    }
+
+    /// Set an `ida.cfg` directive for this database, e.g. `VPAGESIZE=8192`
+    /// (`-d`).
+    pub fn directive(&mut self, directive: impl AsRef<str>) -> &mut Self {
+        self.directives.push(directive.as_ref().to_owned());
+        self
+    }
+
     pub fn open(&self, path: impl AsRef<Path>) -> Result<IDB, IDAError> {
+        let path = path.as_ref();
+        let args = self.args(self.output(path).as_deref());
+        IDB::open_full_with(path, self.auto_analyse, self.save, &args, None)
+    }
+
+    /// As `open`, but also report how long each part of opening took.
+    pub fn open_profiled(&self, path: impl AsRef<Path>) -> Result<(IDB, OpenProfile), IDAError> {
+        let path = path.as_ref();
+        let mut profile = OpenProfile::default();
+        let idb = self.open_into(
+            path,
+            self.output(path).as_deref(),
+            self.auto_analyse,
+            &mut profile,
+        )?;
+        Ok((idb, profile))
+    }
+
+    /// The database path to create for `path`: the explicit `idb` path, or
+    /// one in `work_dir`, if either is set.
+    pub(crate) fn output(&self, path: &Path) -> Option<PathBuf> {
+        self.idb.clone().or_else(|| {
+            let dir = self.work_dir.as_ref()?;
+            let mut name = path.file_name()?.to_owned();
+            name.push(".i64");
+            Some(dir.join(name))
+        })
+    }
+
+    /// Open `path` with these options, overriding the output database path
+    /// and whether to auto-analyse it.
+    pub(crate) fn open_into(
+        &self,
+        path: impl AsRef<Path>,
+        idb: Option<&Path>,
+        auto_analyse: bool,
+        profile: &mut OpenProfile,
+    ) -> Result<IDB, IDAError> {
+        let args = self.args(idb);
+        IDB::open_full_with(path, auto_analyse, self.save, &args, Some(profile))
+    }
+
+    fn args(&self, idb: Option<&Path>) -> Vec<String> {
         let mut args = Vec::new();
 
         #[cfg(feature = "ida92")]
@@ -115,12 +244,52 @@ impl IDBOpenOptions {
             args.push(format!("-T{}", ftype));
         }
 
-        if let Some(idb_path) = self.idb.as_ref() {
+        if let Some(idb_path) = idb {
             args.push("-c".to_owned());
             args.push(format!("-o{}", idb_path.display()));
         }
 
-        IDB::open_full_with(path, self.auto_analyse, self.save, &args)
+        match self.packing {
+            Some(DatabasePacking::Compressed) => args.push("-P+".to_owned()),
+            Some(DatabasePacking::Packed) => args.push("-P".to_owned()),
+            Some(DatabasePacking::Unpacked) => args.push("-P-".to_owned()),
+            None => (),
+        }
+
+        if let Some(page_size) = self.page_size {
+            args.push(format!("-dVPAGESIZE={page_size}"));
+        }
+
+        for directive in &self.directives {
+            args.push(format!("-d{directive}"));
+        }
+
+        args
+    }
+}
+
+/// Where the time went while opening a database; see
+/// `IDBOpenOptions::open_profiled`.
+#[derive(Debug, Clone, Default)]
+pub struct OpenProfile {
+    /// Time spent initialising the IDA library; zero if it was already
+    /// initialised by an earlier open.
+    pub library_init: Duration,
+    /// Time until the loader finished; zero when opening an existing
+    /// database.
+    pub loader: Duration,
+    /// The rest of the kernel's database initialisation.
+    pub init_database: Duration,
+    /// Auto-analysis time by queue; empty if auto-analysis was not run.
+    pub auto_analysis: Vec<AutoStageTime>,
+    /// Set when the database was opened through an `IDBTemplateCache`.
+    pub template: Option<TemplateUse>,
+    pub total: Duration,
+}
+
+impl OpenProfile {
+    pub fn auto_analysis_total(&self) -> Duration {
+        self.auto_analysis.iter().map(|stage| stage.elapsed).sum()
     }
 }
 
@@ -134,7 +303,7 @@ impl IDB {
         auto_analyse: bool,
         save: bool,
     ) -> Result<Self, IDAError> {
-        Self::open_full_with(path, auto_analyse, save, &[] as &[&str])
+        Self::open_full_with(path, auto_analyse, save, &[] as &[&str], None)
     }
 
     fn open_full_with(
@@ -142,7 +311,13 @@ impl IDB {
         auto_analyse: bool,
         save: bool,
         args: &[impl AsRef<str>],
+        profile: Option<&mut OpenProfile>,
     ) -> Result<Self, IDAError> {
+        let start = Instant::now();
+
+        init_library();
+        let library_init = start.elapsed();
+
         let _guard = prepare_library();
         let path = path.as_ref();
 
@@ -150,7 +325,18 @@ impl IDB {
             return Err(IDAError::not_found(path));
         }
 
-        open_database_quiet(path, auto_analyse, args)?;
+        if let Some(profile) = profile {
+            let mut raw = open_profile_t::default();
+            open_database_profiled(path, auto_analyse, args, &mut raw)?;
+
+            profile.library_init = library_init;
+            profile.loader = Duration::from_nanos(raw.loader_nanos);
+            profile.init_database = Duration::from_nanos(raw.init_database_nanos);
+            profile.auto_analysis = raw.stages.iter().map(AutoStageTime::from_raw).collect();
+            profile.total = start.elapsed();
+        } else {
+            open_database_quiet(path, auto_analyse, args)?;
+        }
 
         let decompiler = unsafe { init_hexrays_plugin(0.into()) };
 
@@ -158,6 +344,8 @@ impl IDB {
             path: path.to_owned(),
             save,
             decompiler,
+            cfg_cache: RefCell::new(LruCache::new(DEFAULT_CFG_CACHE_CAPACITY)),
+            remove_on_close: None,
             _guard,
             _marker: PhantomData,
         })
@@ -167,6 +355,19 @@ impl IDB {
         &self.path
     }
 
+    /// The path the database is saved to, as opposed to the input file.
+    pub fn database_path(&self) -> Option<PathBuf> {
+        let path = unsafe { idalib_get_database_path(false) };
+        (!path.is_empty()).then(|| PathBuf::from(path))
+    }
+
+    /// The process's memory use and the size of the files the database is
+    /// unpacked into while open.
+    pub fn memory_usage(&self) -> MemoryUsage {
+        let id0 = unsafe { idalib_get_database_path(true) };
+        MemoryUsage::new((!id0.is_empty()).then_some(Path::new(&id0)))
+    }
+
     pub fn save_on_close(&mut self, status: bool) {
         self.save = status;
     }
@@ -175,6 +376,138 @@ impl IDB {
         unsafe { auto_wait() }
     }
 
+    /// As `auto_wait`, but also return the time spent on each auto-analysis
+    /// queue.
+    pub fn auto_wait_profiled(&mut self) -> (bool, Vec<AutoStageTime>) {
+        let mut stages = Vec::new();
+        let done = auto_wait_profiled(&mut stages);
+
+        (done, stages.iter().map(AutoStageTime::from_raw).collect())
+    }
+
+    /// Run auto-analysis until it finishes or `budget` is used up.
+    ///
+    /// Analysis state persists between calls, so this can be called
+    /// repeatedly to interleave analysis with other work on the database,
+    /// e.g., processing `analysed_functions` while the long tail finishes.
+    ///
+    /// If analysis is not done but no step can be made (for instance, only
+    /// the kernel's final pass is left), this returns without progress;
+    /// `auto_wait` finishes the rest, without a budget.
+    pub fn auto_step(&mut self, budget: AutoBudget) -> AutoProgress {
+        let mut raw_stages = Vec::new();
+        let step = auto_step(budget.raw_steps(), budget.raw_nanos(), &mut raw_stages);
+
+        let mut progress = AutoProgress::default();
+        progress.update(&step, &raw_stages);
+        progress
+    }
+
+    /// Run auto-analysis within `budget` in short slices, calling
+    /// `on_progress` after each; analysis stops early if `cancel` is set or
+    /// the callback breaks.
+    pub fn auto_run<F>(
+        &mut self,
+        budget: AutoBudget,
+        cancel: &AutoCancel,
+        mut on_progress: F,
+    ) -> AutoProgress
+    where
+        F: FnMut(&IDB, &AutoProgress) -> ControlFlow<()>,
+    {
+        let mut raw_stages = Vec::new();
+        let mut progress = AutoProgress::default();
+
+        loop {
+            if cancel.is_cancelled() {
+                progress.cancelled = true;
+                break;
+            }
+
+            let mut slice = AUTO_RUN_SLICE;
+            if let Some(time) = budget.max_time() {
+                match time.checked_sub(progress.elapsed) {
+                    Some(left) if !left.is_zero() => slice = slice.min(left),
+                    _ => break,
+                }
+            }
+
+            let mut slice_budget = AutoBudget::time(slice);
+            if let Some(steps) = budget.max_steps() {
+                if progress.steps >= steps {
+                    break;
+                }
+                slice_budget = slice_budget.with_steps(steps - progress.steps);
+            }
+
+            let step = auto_step(
+                slice_budget.raw_steps(),
+                slice_budget.raw_nanos(),
+                &mut raw_stages,
+            );
+            progress.update(&step, &raw_stages);
+
+            if on_progress(self, &progress).is_break() {
+                progress.cancelled = !progress.done;
+                break;
+            }
+
+            // NOTE: a slice that makes no step would make none next time
+            // either; see `auto_step`
+            if progress.done || step.steps == 0 {
+                break;
+            }
+        }
+
+        progress
+    }
+
+    /// Whether auto-analysis has no work left.
+    pub fn auto_is_done(&self) -> bool {
+        unsafe { idalib_auto_is_done() }
+    }
+
+    /// Pending work in each non-empty auto-analysis queue, counting at most
+    /// `limit` entries per queue.
+    pub fn auto_queue_depths(&self, limit: u64) -> Vec<AutoQueueDepth> {
+        let limit = limit.max(1);
+
+        let mut raw = Vec::new();
+        unsafe { idalib_auto_queue_depths(limit, &mut raw) };
+
+        raw.iter()
+            .map(|depth| AutoQueueDepth::from_raw(depth, limit))
+            .collect()
+    }
+
+    /// Whether auto-analysis still has work queued in `[start, end)`.
+    pub fn auto_pending_in(&self, start: Address, end: Address) -> bool {
+        unsafe { idalib_auto_pending_in(start.into(), end.into()) }
+    }
+
+    /// Functions with no auto-analysis work queued within their bounds.
+    pub fn analysed_functions<'a>(&'a self) -> impl Iterator<Item = Function<'a>> + 'a {
+        self.functions()
+            .map(|(_, f)| f)
+            .filter(|f| !self.auto_pending_in(f.start_address(), f.end_address()))
+    }
+
+    /// Write a packed copy of the database to `path`, compressed if
+    /// `compress` is set.
+    ///
+    /// The database is first saved, packed, to its own path and that file
+    /// is then copied, so it stays the target of later saves; on close it is
+    /// still saved (or not) with its own packing, but the packed file left
+    /// by this save remains either way.
+    pub fn save_copy(&self, path: impl AsRef<Path>, compress: bool) -> Result<(), IDAError> {
+        save_database_copy(path, compress)
+    }
+
+    /// Delete `path` once the database has been closed.
+    pub(crate) fn remove_on_close(&mut self, path: PathBuf) {
+        self.remove_on_close = Some(path);
+    }
+
     pub fn set_screen_address(&mut self, ea: Address) {
         set_screen_ea(ea.into());
     }
@@ -191,6 +524,12 @@ impl IDB {
         Metadata::new()
     }
 
+    /// Copy all metadata in a single call; prefer this to `meta` when
+    /// reading more than a few fields.
+    pub fn meta_snapshot(&self) -> MetadataSnapshot {
+        MetadataSnapshot::new()
+    }
+
     pub fn meta_mut(&mut self) -> MetadataMut {
         MetadataMut::new()
     }
@@ -201,6 +540,7 @@ impl IDB {
     }
 
     pub fn entries(&self) -> EntryPointIter {
+        let _ffi = instrument::scope(Subsystem::Funcs, "entries");
         let limit = unsafe { get_entry_qty() };
         EntryPointIter {
             index: 0,
@@ -210,6 +550,7 @@ impl IDB {
     }
 
     pub fn function_at(&self, ea: Address) -> Option<Function> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "function_at");
         let ptr = unsafe { get_func(ea.into()) };
 
         if ptr.is_null() {
@@ -220,6 +561,7 @@ impl IDB {
     }
 
     pub fn function_containing_address(&self, ea: Address) -> Option<Function> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "function_containing_address");
         let ptr = unsafe { get_fchunk(ea.into()) };
 
         if ptr.is_null() {
@@ -234,6 +576,7 @@ impl IDB {
     }
 
     pub fn next_head_with(&self, ea: Address, max_ea: Address) -> Option<Address> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "next_head");
         let next = unsafe { next_head(ea.into(), max_ea.into()) };
         if next == BADADDR {
             None
@@ -247,6 +590,7 @@ impl IDB {
     }
 
     pub fn prev_head_with(&self, ea: Address, min_ea: Address) -> Option<Address> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "prev_head");
         let prev = unsafe { prev_head(ea.into(), min_ea.into()) };
         if prev == BADADDR {
             None
@@ -256,10 +600,45 @@ impl IDB {
     }
 
     pub fn insn_at(&self, ea: Address) -> Option<Insn> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "insn_at");
         let insn = decode(ea.into())?;
         Some(Insn::from_repr(insn))
     }
 
+    /// Decodes every instruction in `[start, end)` in one call.
+    pub fn decode_range(&self, start: Address, end: Address, mode: DecodeMode) -> InsnBatch {
+        let mut batch = InsnBatch::new();
+        self.decode_range_into(start, end, mode, &mut batch);
+        batch
+    }
+
+    /// As `decode_range`, appending to `batch`; returns the number of
+    /// instructions appended.
+    pub fn decode_range_into(
+        &self,
+        start: Address,
+        end: Address,
+        mode: DecodeMode,
+        batch: &mut InsnBatch,
+    ) -> usize {
+        insn::decode_range_into(start, end, mode, batch)
+    }
+
+    /// Decodes each segment into its own batch, in segment order.
+    ///
+    /// Decoding has to happen on the thread that owns the database, but the
+    /// batches are plain data, so they can be handed to worker threads for
+    /// further processing.
+    pub fn decode_segments(&self, mode: DecodeMode) -> Vec<InsnBatch> {
+        self.segments()
+            .map(|(_, segment)| {
+                let mut batch = InsnBatch::new();
+                segment.decode_into(mode, &mut batch);
+                batch
+            })
+            .collect()
+    }
+
     pub fn decompile<'a>(&'a self, f: &Function<'a>) -> Result<CFunction<'a>, IDAError> {
         self.decompile_with(f, false)
     }
@@ -269,6 +648,7 @@ impl IDB {
         f: &Function<'a>,
         all_blocks: bool,
     ) -> Result<CFunction<'a>, IDAError> {
+        let _ffi = instrument::scope(Subsystem::HexRays, "decompile_with");
         if !self.decompiler {
             return Err(IDAError::ffi_with("no decompiler available"));
         }
@@ -279,7 +659,58 @@ impl IDB {
         })
     }
 
+    /// Generates `f`'s microcode up to `maturity` without building a ctree,
+    /// which is much cheaper than a full decompile when only data flow or
+    /// the micro-instructions themselves are needed.
+    pub fn microcode(&self, f: &Function, maturity: Maturity) -> Result<Microcode, IDAError> {
+        self.microcode_with(f, maturity, false)
+    }
+
+    pub fn microcode_with(
+        &self,
+        f: &Function,
+        maturity: Maturity,
+        all_blocks: bool,
+    ) -> Result<Microcode, IDAError> {
+        if !self.decompiler {
+            return Err(IDAError::ffi_with("no decompiler available"));
+        }
+
+        Microcode::new(f, maturity, all_blocks)
+    }
+
+    /// Decompiles the functions starting at `functions` in one batch,
+    /// yielding results as they complete; see `DecompileBatchOptions`.
+    ///
+    /// Hex-Rays is single-threaded, so the batch runs on the calling thread;
+    /// it saves time by ordering work callee-first and by reusing Hex-Rays'
+    /// cache for functions that have not changed.
+    pub fn decompile_batch<'a>(
+        &'a self,
+        functions: impl IntoIterator<Item = Address>,
+        options: &DecompileBatchOptions,
+    ) -> Result<DecompileBatch<'a>, IDAError> {
+        if !self.decompiler {
+            return Err(IDAError::ffi_with("no decompiler available"));
+        }
+
+        Ok(DecompileBatch::new(
+            self,
+            functions.into_iter().collect(),
+            options,
+        ))
+    }
+
+    /// Marks the cached decompilation of the function at `ea` as stale, so
+    /// the next cached decompile redoes it; returns false if nothing was
+    /// cached.
+    pub fn mark_decompilation_dirty(&self, ea: Address) -> bool {
+        let _ffi = instrument::scope(Subsystem::HexRays, "mark_decompilation_dirty");
+        self.decompiler && unsafe { idalib_hexrays_mark_cfunc_dirty(ea.into(), false) }
+    }
+
     pub fn function_by_id(&self, id: FunctionId) -> Option<Function> {
+        let _ffi = instrument::scope(Subsystem::Funcs, "function_by_id");
         let ptr = unsafe { getn_func(id) };
 
         if ptr.is_null() {
@@ -294,10 +725,79 @@ impl IDB {
     }
 
     pub fn function_count(&self) -> usize {
+        let _ffi = instrument::scope(Subsystem::Funcs, "function_count");
         unsafe { get_func_qty() }
     }
 
+    /// Builds the call graph of every function in one pass over their code
+    /// cross-references.
+    pub fn call_graph(&self) -> CallGraph {
+        CallGraph::new(self)
+    }
+
+    /// Computes feature vectors and MinHash/SimHash sketches of every
+    /// function in one native pass.
+    pub fn function_features(&self, options: &FeatureOptions) -> FunctionFeatures {
+        FunctionFeatures::new(&[], options)
+    }
+
+    /// As [`IDB::function_features`], but only for the functions starting at
+    /// `functions`; rows follow the order of `functions`, skipping addresses
+    /// that do not start a function.
+    pub fn function_features_of(
+        &self,
+        functions: &[Address],
+        options: &FeatureOptions,
+    ) -> FunctionFeatures {
+        if functions.is_empty() {
+            return FunctionFeatures::default();
+        }
+        FunctionFeatures::new(functions, options)
+    }
+
+    pub fn flat_cfg(&self, f: &Function) -> Result<Arc<FlatCFG>, IDAError> {
+        self.flat_cfg_with(f, FunctionCFGFlags::empty())
+    }
+
+    /// Returns the flattened flow chart of `f`, reusing a cached copy if the
+    /// database has not changed since it was built.
+    pub fn flat_cfg_with(
+        &self,
+        f: &Function,
+        flags: FunctionCFGFlags,
+    ) -> Result<Arc<FlatCFG>, IDAError> {
+        let key = (f.start_address(), flags.bits());
+        let change_count = self.meta().database_change_count();
+
+        if let Some((count, cfg)) = self.cfg_cache.borrow_mut().get(&key) {
+            if *count == change_count {
+                return Ok(cfg.clone());
+            }
+        }
+
+        let cfg = Arc::new(f.flat_cfg_with(flags)?);
+        self.cfg_cache
+            .borrow_mut()
+            .insert(key, (change_count, cfg.clone()));
+
+        Ok(cfg)
+    }
+
+    pub fn cfg_cache_capacity(&self) -> usize {
+        self.cfg_cache.borrow().capacity()
+    }
+
+    /// Sets how many flattened flow charts are cached; 0 disables caching.
+    pub fn set_cfg_cache_capacity(&self, capacity: usize) {
+        self.cfg_cache.borrow_mut().set_capacity(capacity);
+    }
+
+    pub fn clear_cfg_cache(&self) {
+        self.cfg_cache.borrow_mut().clear();
+    }
+
     pub fn segment_at(&self, ea: Address) -> Option<Segment> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "segment_at");
         let ptr = unsafe { getseg(ea.into()) };
 
         if ptr.is_null() {
@@ -308,6 +808,7 @@ impl IDB {
     }
 
     pub fn segment_by_id(&self, id: SegmentId) -> Option<Segment> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "segment_by_id");
         let ptr = unsafe { getnseg((id as i32).into()) };
 
         if ptr.is_null() {
@@ -318,6 +819,7 @@ impl IDB {
     }
 
     pub fn segment_by_name(&self, name: impl AsRef<str>) -> Option<Segment> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "segment_by_name");
         let s = CString::new(name.as_ref()).ok()?;
         let ptr = unsafe { get_segm_by_name(s.as_ptr()) };
 
@@ -333,6 +835,7 @@ impl IDB {
     }
 
     pub fn segment_count(&self) -> usize {
+        let _ffi = instrument::scope(Subsystem::Bytes, "segment_count");
         unsafe { get_segm_qty().0 as _ }
     }
 
@@ -344,11 +847,13 @@ impl IDB {
     }
 
     pub fn insn_alignment_at(&self, ea: Address) -> Option<usize> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "insn_alignment_at");
         let align = unsafe { is_align_insn(ea.into()).0 };
         if align == 0 { None } else { Some(align as _) }
     }
 
     pub fn first_xref_from(&self, ea: Address, flags: XRefQuery) -> Option<XRef> {
+        let _ffi = instrument::scope(Subsystem::XRefs, "first_xref_from");
         let mut xref = MaybeUninit::<xrefblk_t>::zeroed();
         let found =
             unsafe { xrefblk_t_first_from(xref.as_mut_ptr(), ea.into(), flags.bits().into()) };
@@ -361,6 +866,7 @@ impl IDB {
     }
 
     pub fn first_xref_to(&self, ea: Address, flags: XRefQuery) -> Option<XRef> {
+        let _ffi = instrument::scope(Subsystem::XRefs, "first_xref_to");
         let mut xref = MaybeUninit::<xrefblk_t>::zeroed();
         let found =
             unsafe { xrefblk_t_first_to(xref.as_mut_ptr(), ea.into(), flags.bits().into()) };
@@ -372,6 +878,54 @@ impl IDB {
         }
     }
 
+    /// Appends every xref to `ea` to `buf` in a single call, returning the
+    /// number added.
+    pub fn xrefs_to_into(
+        &self,
+        ea: Address,
+        flags: XRefQuery,
+        kinds: XRefKinds,
+        buf: &mut XRefBuffer,
+    ) -> usize {
+        buf.fill(ea, ea.saturating_add(1), true, flags, kinds)
+    }
+
+    /// Appends every xref from `ea` to `buf` in a single call, returning
+    /// the number added.
+    pub fn xrefs_from_into(
+        &self,
+        ea: Address,
+        flags: XRefQuery,
+        kinds: XRefKinds,
+        buf: &mut XRefBuffer,
+    ) -> usize {
+        buf.fill(ea, ea.saturating_add(1), false, flags, kinds)
+    }
+
+    /// Appends every xref to an address in `[start, end)` to `buf`.
+    pub fn xrefs_to_range_into(
+        &self,
+        start: Address,
+        end: Address,
+        flags: XRefQuery,
+        kinds: XRefKinds,
+        buf: &mut XRefBuffer,
+    ) -> usize {
+        buf.fill(start, end, true, flags, kinds)
+    }
+
+    /// Appends every xref from an item head in `[start, end)` to `buf`.
+    pub fn xrefs_from_range_into(
+        &self,
+        start: Address,
+        end: Address,
+        flags: XRefQuery,
+        kinds: XRefKinds,
+        buf: &mut XRefBuffer,
+    ) -> usize {
+        buf.fill(start, end, false, flags, kinds)
+    }
+
     pub fn get_cmt(&self, ea: Address) -> Option<String> {
         self.get_cmt_with(ea, false)
     }
@@ -437,6 +991,13 @@ impl IDB {
         }
     }
 
+    /// Applies a batch of annotations in a single call. Operations run in
+    /// address order with auto-analysis disabled; analysis is re-enabled (if
+    /// it was enabled) once the whole batch has been applied.
+    pub fn apply_annotations(&mut self, batch: &Annotations) -> AnnotationReport {
+        AnnotationReport::apply(batch)
+    }
+
     pub fn set_name(&mut self, ea: Address, name: impl AsRef<str>) -> Result<(), IDAError> {
         let c_name = CString::new(name.as_ref()).map_err(IDAError::ffi)?;
         let success = unsafe { idalib_set_name(ea.into(), c_name.as_ptr(), c_int(0)) };
@@ -486,6 +1047,7 @@ impl IDB {
     }
 
     pub fn find_text(&self, start_ea: Address, text: impl AsRef<str>) -> Option<Address> {
+        let _ffi = instrument::scope(Subsystem::Search, "find_text");
         let s = CString::new(text.as_ref()).ok()?;
         let addr = unsafe { idalib_find_text(start_ea.into(), s.as_ptr()) };
         if addr == BADADDR {
@@ -508,6 +1070,7 @@ impl IDB {
     }
 
     pub fn find_imm(&self, start_ea: Address, imm: u32) -> Option<Address> {
+        let _ffi = instrument::scope(Subsystem::Search, "find_imm");
         let addr = unsafe { idalib_find_imm(start_ea.into(), imm.into()) };
         if addr == BADADDR {
             None
@@ -524,7 +1087,30 @@ impl IDB {
         })
     }
 
+    /// Copies `[start, end)` out of the database so it can be scanned
+    /// without further kernel calls.
+    pub fn snapshot_bytes(&self, start: Address, end: Address) -> Result<ByteImage, IDAError> {
+        ByteImage::new(self, start, end)
+    }
+
+    /// Matches every pattern in `set` against all segments in one pass.
+    ///
+    /// Segment contents are copied once up front; matching then runs on
+    /// worker threads over the copies, so the kernel is only called from
+    /// this thread.
+    pub fn scan_patterns(&self, set: &PatternSet) -> Result<Vec<ScanHit>, IDAError> {
+        let images = self
+            .segments()
+            .map(|(_, s)| self.snapshot_bytes(s.start_address(), s.end_address()))
+            .collect::<Result<Vec<_>, _>>()?;
+
+        let threads = std::thread::available_parallelism().unwrap_or(NonZeroUsize::MIN);
+
+        Ok(scan_images(set, &images, threads))
+    }
+
     pub fn find_defined(&self, start_ea: Address) -> Option<Address> {
+        let _ffi = instrument::scope(Subsystem::Search, "find_defined");
         let addr = unsafe { idalib_find_defined(start_ea.into()) };
         if addr == BADADDR {
             None
@@ -545,7 +1131,19 @@ impl IDB {
         TypeList::new(self)
     }
 
+    /// Streams `table` to `out` as an Arrow IPC stream, in record batches of
+    /// at most `options.batch_rows` rows.
+    pub fn export_table<W: Write>(
+        &self,
+        table: ExportTable,
+        options: &ExportOptions,
+        out: W,
+    ) -> Result<ExportStats, IDAError> {
+        export::export_table(self, table, options, out)
+    }
+
     pub fn parse_types_from_header<P: AsRef<Path>>(&self, header_path: P) -> Result<i32, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "parse_types_from_header");
         let path_str = header_path.as_ref().to_string_lossy();
         let c_path = CString::new(path_str.as_ref()).map_err(IDAError::ffi)?;
 
@@ -561,6 +1159,7 @@ impl IDB {
 
     /// Get the type at an address, if any
     pub fn get_type_at_address(&self, address: Address) -> Option<Type> {
+        let _ffi = instrument::scope(Subsystem::Types, "get_type_at_address");
         let ordinal = unsafe { idalib_get_type_ordinal_at_address(address.into()) };
         if ordinal == 0 {
             None
@@ -577,26 +1176,47 @@ impl IDB {
     }
 
     pub fn flags_at(&self, ea: Address) -> AddressFlags {
+        let _ffi = instrument::scope(Subsystem::Bytes, "flags_at");
         AddressFlags::new(unsafe { get_flags(ea.into()) })
     }
 
+    /// Classifies every byte of `[start, end)` as code, data, head, tail or
+    /// unexplored in one call; with `spans`, also records each item and run
+    /// of unexplored bytes.
+    pub fn flags_map(&self, start: Address, end: Address, spans: bool) -> FlagsMap {
+        FlagsMap::new(start, end, spans)
+    }
+
+    /// As `flags_map`, for every segment. The maps are plain data, so they
+    /// can be combined and queried from other threads.
+    pub fn segment_flags_maps(&self, spans: bool) -> Vec<FlagsMap> {
+        self.segments()
+            .map(|(_, s)| FlagsMap::new(s.start_address(), s.end_address(), spans))
+            .collect()
+    }
+
     pub fn get_byte(&self, ea: Address) -> u8 {
+        let _ffi = instrument::scope(Subsystem::Bytes, "get_byte");
         unsafe { idalib_get_byte(ea.into()) }
     }
 
     pub fn get_word(&self, ea: Address) -> u16 {
+        let _ffi = instrument::scope(Subsystem::Bytes, "get_word");
         unsafe { idalib_get_word(ea.into()) }
     }
 
     pub fn get_dword(&self, ea: Address) -> u32 {
+        let _ffi = instrument::scope(Subsystem::Bytes, "get_dword");
         unsafe { idalib_get_dword(ea.into()) }
     }
 
     pub fn get_qword(&self, ea: Address) -> u64 {
+        let _ffi = instrument::scope(Subsystem::Bytes, "get_qword");
         unsafe { idalib_get_qword(ea.into()) }
     }
 
     pub fn get_bytes(&self, ea: Address, size: usize) -> Vec<u8> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "get_bytes");
         let mut buf = Vec::with_capacity(size);
 
         let Ok(new_len) = (unsafe { idalib_get_bytes(ea.into(), &mut buf) }) else {
@@ -610,6 +1230,37 @@ impl IDB {
         buf
     }
 
+    /// Reads `buf.len()` bytes at `ea` into `buf` without allocating,
+    /// returning the number of bytes read.
+    pub fn get_bytes_into(&self, ea: Address, buf: &mut [u8]) -> usize {
+        bytes::read_into(ea, buf)
+    }
+
+    /// Like `get_bytes_into`, but also fills `mask` (at least
+    /// `ByteMask::len_for(buf.len())` bytes) with a validity bitmap; bytes
+    /// that have no value are read as `0xff` with their bit cleared.
+    pub fn get_bytes_with_mask(
+        &self,
+        ea: Address,
+        buf: &mut [u8],
+        mask: &mut [u8],
+    ) -> Result<usize, IDAError> {
+        bytes::read_with_mask(ea, buf, mask)
+    }
+
+    /// Streams `[start, end)` in chunks of `chunk_size` bytes, reusing the
+    /// same buffers for every chunk.
+    pub fn byte_chunks(&self, start: Address, end: Address, chunk_size: usize) -> ByteChunks {
+        ByteChunks::new(start, end, chunk_size)
+    }
+
+    /// Writes a batch of patches in a single call with auto-analysis
+    /// disabled, then queues the touched items for reanalysis with one
+    /// `plan_range` per merged range (unless disabled on the batch).
+    pub fn apply_patches(&mut self, patches: &Patches) -> PatchReport {
+        patches.apply()
+    }
+
     pub fn find_plugin(
         &self,
         name: impl AsRef<str>,
@@ -641,6 +1292,10 @@ impl Drop for IDB {
             }
         }
         close_database_with(self.save);
+
+        if let Some(path) = self.remove_on_close.take() {
+            let _ = std::fs::remove_file(path);
+        }
     }
 }
 
@@ -658,6 +1313,7 @@ impl<'a> Iterator for EntryPointIter<'a> {
             return None;
         }
 
+        let _ffi = instrument::scope(Subsystem::Funcs, "entry");
         let ordinal = unsafe { get_entry_ordinal(self.index) };
         let addr = unsafe { get_entry(ordinal) };
 
@@ -2,13 +2,14 @@ use std::mem;
 
 use bitflags::bitflags;
 
-use crate::ffi::insn::insn_t;
 use crate::ffi::insn::op::*;
+use crate::ffi::insn::{idalib_decode_range, insn_batch_t, insn_t};
 use crate::ffi::util::{is_basic_block_end, is_call_insn, is_indirect_jump_insn, is_ret_insn};
 
 pub use crate::ffi::insn::{arm, mips, x86};
 
 use crate::Address;
+use crate::instrument::{self, Subsystem};
 
 pub type Register = u16;
 pub type Phrase = u16;
@@ -130,14 +131,17 @@ impl Insn {
     }
 
     pub fn is_basic_block_end(&self, call_stops_block: bool) -> bool {
+        let _ffi = instrument::scope(Subsystem::Bytes, "is_basic_block_end");
         unsafe { is_basic_block_end(&self.inner, call_stops_block) }
     }
 
     pub fn is_call(&self) -> bool {
+        let _ffi = instrument::scope(Subsystem::Bytes, "is_call_insn");
         unsafe { is_call_insn(&self.inner) }
     }
 
     pub fn is_indirect_jump(&self) -> bool {
+        let _ffi = instrument::scope(Subsystem::Bytes, "is_indirect_jump_insn");
         unsafe { is_indirect_jump_insn(&self.inner) }
     }
 
@@ -146,6 +150,7 @@ impl Insn {
     }
 
     pub fn is_ret_with(&self, iri: IsReturnFlags) -> bool {
+        let _ffi = instrument::scope(Subsystem::Bytes, "is_ret_insn");
         unsafe { is_ret_insn(&self.inner, iri.bits()) }
     }
 }
@@ -302,3 +307,240 @@ impl Operand {
         )
     }
 }
+
+/// How `IDB::decode_range` chooses the addresses to decode.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Hash)]
+pub enum DecodeMode {
+    /// Only items the database marks as code.
+    #[default]
+    Code,
+    /// Every address in turn (a linear sweep), skipping past each decoded
+    /// instruction; useful for regions analysis has not covered.
+    Linear,
+}
+
+/// Decodes `[start, end)` into `batch`, returning the number of instructions
+/// appended; see `IDB::decode_range_into`.
+pub(crate) fn decode_range_into(
+    start: Address,
+    end: Address,
+    mode: DecodeMode,
+    batch: &mut InsnBatch,
+) -> usize {
+    let _ffi = instrument::scope(Subsystem::Bytes, "decode_range");
+    let linear = mode == DecodeMode::Linear;
+    unsafe { idalib_decode_range(start.into(), end.into(), linear, batch.raw_mut()) }
+}
+
+/// Instructions decoded in bulk, stored as parallel arrays.
+///
+/// Decoding functions append to the batch, so one batch can be reused (after
+/// `clear`) or accumulate several ranges without reallocating.
+#[derive(Debug, Default)]
+pub struct InsnBatch {
+    raw: insn_batch_t,
+}
+
+impl InsnBatch {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn clear(&mut self) {
+        let raw = &mut self.raw;
+
+        raw.eas.clear();
+        raw.sizes.clear();
+        raw.itypes.clear();
+        raw.flags.clear();
+        raw.op_offsets.clear();
+        raw.op_types.clear();
+        raw.op_dtypes.clear();
+        raw.op_flags.clear();
+        raw.op_regs.clear();
+        raw.op_values.clear();
+        raw.op_addrs.clear();
+        raw.op_specvals.clear();
+    }
+
+    pub(crate) fn raw_mut(&mut self) -> &mut insn_batch_t {
+        &mut self.raw
+    }
+
+    pub fn len(&self) -> usize {
+        self.raw.eas.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.raw.eas.is_empty()
+    }
+
+    pub fn get(&self, index: usize) -> Option<DecodedInsn<'_>> {
+        (index < self.len()).then_some(DecodedInsn { batch: self, index })
+    }
+
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = DecodedInsn<'_>> + '_ {
+        (0..self.len()).map(|index| DecodedInsn { batch: self, index })
+    }
+
+    pub fn addresses(&self) -> &[Address] {
+        &self.raw.eas
+    }
+
+    pub fn sizes(&self) -> &[u16] {
+        &self.raw.sizes
+    }
+
+    pub fn itypes(&self) -> &[InsnType] {
+        &self.raw.itypes
+    }
+
+    /// Operand types of all instructions; see `operand_offsets`.
+    pub fn operand_types(&self) -> &[u8] {
+        &self.raw.op_types
+    }
+
+    /// Operand values (immediates) of all instructions.
+    pub fn operand_values(&self) -> &[u64] {
+        &self.raw.op_values
+    }
+
+    /// Operand addresses of all instructions.
+    pub fn operand_addresses(&self) -> &[u64] {
+        &self.raw.op_addrs
+    }
+
+    /// The operands of instruction `i` are at
+    /// `operand_offsets[i]..operand_offsets[i + 1]` in the operand arrays.
+    pub fn operand_offsets(&self) -> &[u32] {
+        &self.raw.op_offsets
+    }
+}
+
+/// An instruction in an `InsnBatch`.
+#[derive(Clone, Copy)]
+pub struct DecodedInsn<'b> {
+    batch: &'b InsnBatch,
+    index: usize,
+}
+
+impl<'b> DecodedInsn<'b> {
+    pub fn address(&self) -> Address {
+        self.batch.raw.eas[self.index]
+    }
+
+    pub fn itype(&self) -> InsnType {
+        self.batch.raw.itypes[self.index]
+    }
+
+    pub fn len(&self) -> usize {
+        self.batch.raw.sizes[self.index] as _
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// The instruction's `insn_t::flags`.
+    pub fn flags(&self) -> u32 {
+        self.batch.raw.flags[self.index]
+    }
+
+    pub fn operand_count(&self) -> usize {
+        let offsets = &self.batch.raw.op_offsets;
+        (offsets[self.index + 1] - offsets[self.index]) as _
+    }
+
+    pub fn operand(&self, n: usize) -> Option<DecodedOperand<'b>> {
+        (n < self.operand_count()).then(|| DecodedOperand {
+            batch: self.batch,
+            index: self.batch.raw.op_offsets[self.index] as usize + n,
+            n,
+        })
+    }
+
+    pub fn operands(&self) -> impl ExactSizeIterator<Item = DecodedOperand<'b>> + 'b {
+        let batch = self.batch;
+        let start = batch.raw.op_offsets[self.index] as usize;
+
+        (0..self.operand_count()).map(move |n| DecodedOperand {
+            batch,
+            index: start + n,
+            n,
+        })
+    }
+}
+
+/// An operand of a `DecodedInsn`; accessors follow `Operand`.
+#[derive(Clone, Copy)]
+pub struct DecodedOperand<'b> {
+    batch: &'b InsnBatch,
+    index: usize,
+    n: usize,
+}
+
+impl<'b> DecodedOperand<'b> {
+    pub fn n(&self) -> usize {
+        self.n
+    }
+
+    pub fn flags(&self) -> OperandFlags {
+        OperandFlags::from_bits_retain(self.batch.raw.op_flags[self.index])
+    }
+
+    pub fn type_(&self) -> OperandType {
+        unsafe { mem::transmute(self.batch.raw.op_types[self.index]) }
+    }
+
+    pub fn dtype(&self) -> OperandDataType {
+        unsafe { mem::transmute(self.batch.raw.op_dtypes[self.index]) }
+    }
+
+    pub fn reg(&self) -> Option<Register> {
+        (self.is_processor_specific() || self.type_() == OperandType::Reg)
+            .then(|| self.batch.raw.op_regs[self.index])
+    }
+
+    pub fn phrase(&self) -> Option<Phrase> {
+        (self.is_processor_specific()
+            || matches!(self.type_(), OperandType::Phrase | OperandType::Displ))
+        .then(|| self.batch.raw.op_regs[self.index])
+    }
+
+    pub fn value(&self) -> Option<u64> {
+        (self.is_processor_specific() || self.type_() == OperandType::Imm)
+            .then(|| self.batch.raw.op_values[self.index])
+    }
+
+    pub fn outer_displacement(&self) -> Option<u64> {
+        self.flags()
+            .contains(OperandFlags::OUTER_DISP)
+            .then(|| self.batch.raw.op_values[self.index])
+    }
+
+    pub fn addr(&self) -> Option<Address> {
+        (self.is_processor_specific()
+            || matches!(
+                self.type_(),
+                OperandType::Mem | OperandType::Displ | OperandType::Far | OperandType::Near
+            ))
+        .then(|| self.batch.raw.op_addrs[self.index])
+    }
+
+    pub fn processor_specific(&self) -> Option<u64> {
+        self.is_processor_specific()
+            .then(|| self.batch.raw.op_specvals[self.index])
+    }
+
+    pub fn is_processor_specific(&self) -> bool {
+        matches!(
+            self.type_(),
+            OperandType::IdpSpec0
+                | OperandType::IdpSpec1
+                | OperandType::IdpSpec2
+                | OperandType::IdpSpec3
+                | OperandType::IdpSpec4
+                | OperandType::IdpSpec5
+        )
+    }
+}
@@ -0,0 +1,220 @@
+//! Opt-in counters for calls across the `idalib-sys` boundary.
+//!
+//! With the `instrument` feature enabled, the wrappers in this crate that
+//! call into the IDA kernel are counted and timed per thread, grouped by
+//! `Subsystem`. Without it, `scope` compiles to nothing and every snapshot
+//! is empty, so callers can use this module unconditionally.
+//!
+//! ```ignore
+//! idalib::instrument::reset();
+//! let before = idalib::instrument::snapshot();
+//! run_job(&idb)?;
+//! for (subsystem, counter) in idalib::instrument::snapshot().since(&before).iter() {
+//!     println!("{}: {} calls, {:?}", subsystem.name(), counter.calls, counter.elapsed());
+//! }
+//! ```
+//!
+//! With the `tracing` feature as well, each counted call is also entered as
+//! a `trace`-level span named `ffi`, carrying the subsystem and entry point.
+//!
+//! Each counter keeps two timers. `nanos` is inclusive: a counted call that
+//! itself makes counted calls (e.g., decompiling a function) includes their
+//! time in its own. `self_nanos` is exclusive, leaving out the time spent in
+//! nested counted calls, so it can be summed across subsystems without
+//! counting any time twice.
+
+use std::time::Duration;
+
+#[cfg(feature = "instrument")]
+use std::cell::{Cell, RefCell};
+#[cfg(feature = "instrument")]
+use std::time::Instant;
+
+/// The group a counted call is charged to.
+///
+/// Each wrapper that calls into the kernel opens one scope around its own
+/// calls; wrappers built from other counted wrappers do not add another.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum Subsystem {
+    /// The address space: bytes, flags, heads, instruction decoding,
+    /// segments, and the name and string lists
+    Bytes,
+    /// Functions, entry points, flow charts and the call graph
+    Funcs,
+    /// Hex-Rays decompilation and microcode
+    HexRays,
+    XRefs,
+    /// Local types: lookups, applications and builders
+    Types,
+    /// Text, immediate and defined-item searches
+    Search,
+}
+
+impl Subsystem {
+    pub const COUNT: usize = 6;
+
+    pub const ALL: [Self; Self::COUNT] = [
+        Self::Bytes,
+        Self::Funcs,
+        Self::HexRays,
+        Self::XRefs,
+        Self::Types,
+        Self::Search,
+    ];
+
+    pub fn index(&self) -> usize {
+        *self as usize
+    }
+
+    pub fn name(&self) -> &'static str {
+        match self {
+            Self::Bytes => "bytes",
+            Self::Funcs => "funcs",
+            Self::HexRays => "hexrays",
+            Self::XRefs => "xrefs",
+            Self::Types => "types",
+            Self::Search => "search",
+        }
+    }
+}
+
+/// Number of calls made and time spent in them.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct Counter {
+    pub calls: u64,
+    /// Time spent in the calls, including nested counted calls.
+    pub nanos: u64,
+    /// Time spent in the calls, excluding nested counted calls.
+    pub self_nanos: u64,
+}
+
+impl Counter {
+    pub fn elapsed(&self) -> Duration {
+        Duration::from_nanos(self.nanos)
+    }
+
+    pub fn self_elapsed(&self) -> Duration {
+        Duration::from_nanos(self.self_nanos)
+    }
+}
+
+/// This thread's counters at a point in time.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct Snapshot {
+    counters: [Counter; Subsystem::COUNT],
+}
+
+impl Snapshot {
+    pub fn get(&self, subsystem: Subsystem) -> Counter {
+        self.counters[subsystem.index()]
+    }
+
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = (Subsystem, Counter)> + '_ {
+        Subsystem::ALL.into_iter().map(|s| (s, self.get(s)))
+    }
+
+    /// Counters summed over every subsystem.
+    ///
+    /// Only exclusive times are summed, since a nested call's inclusive time
+    /// is already part of its caller's; both timers of the total are the
+    /// time spent in outermost counted calls.
+    pub fn total(&self) -> Counter {
+        let mut total = self
+            .counters
+            .iter()
+            .fold(Counter::default(), |acc, c| Counter {
+                calls: acc.calls + c.calls,
+                nanos: 0,
+                self_nanos: acc.self_nanos + c.self_nanos,
+            });
+        total.nanos = total.self_nanos;
+        total
+    }
+
+    /// The calls made between `earlier` and this snapshot.
+    pub fn since(&self, earlier: &Snapshot) -> Snapshot {
+        let mut delta = *self;
+        for (d, e) in delta.counters.iter_mut().zip(&earlier.counters) {
+            d.calls = d.calls.saturating_sub(e.calls);
+            d.nanos = d.nanos.saturating_sub(e.nanos);
+            d.self_nanos = d.self_nanos.saturating_sub(e.self_nanos);
+        }
+        delta
+    }
+}
+
+/// True if this build was compiled with the `instrument` feature.
+pub const fn enabled() -> bool {
+    cfg!(feature = "instrument")
+}
+
+#[cfg(feature = "instrument")]
+thread_local! {
+    static COUNTERS: RefCell<Snapshot> = RefCell::new(Snapshot::default());
+    // NOTE: inclusive time of the finished scopes nested in the innermost
+    // open one; each scope saves and restores its parent's value
+    static NESTED: Cell<u64> = const { Cell::new(0) };
+}
+
+/// The calling thread's counters.
+pub fn snapshot() -> Snapshot {
+    #[cfg(feature = "instrument")]
+    {
+        COUNTERS.with(|c| *c.borrow())
+    }
+
+    #[cfg(not(feature = "instrument"))]
+    {
+        Snapshot::default()
+    }
+}
+
+/// Reset the calling thread's counters.
+pub fn reset() {
+    #[cfg(feature = "instrument")]
+    COUNTERS.with(|c| *c.borrow_mut() = Snapshot::default());
+}
+
+/// Counts one call into `subsystem` and times it until dropped.
+#[must_use]
+pub(crate) struct Scope {
+    #[cfg(feature = "instrument")]
+    subsystem: Subsystem,
+    #[cfg(feature = "instrument")]
+    start: Instant,
+    #[cfg(feature = "instrument")]
+    parent_nested: u64,
+    #[cfg(feature = "tracing")]
+    _span: tracing::span::EnteredSpan,
+}
+
+#[inline(always)]
+#[allow(unused_variables)]
+pub(crate) fn scope(subsystem: Subsystem, entry: &'static str) -> Scope {
+    Scope {
+        #[cfg(feature = "instrument")]
+        subsystem,
+        #[cfg(feature = "tracing")]
+        _span: tracing::trace_span!("ffi", subsystem = subsystem.name(), entry).entered(),
+        #[cfg(feature = "instrument")]
+        parent_nested: NESTED.replace(0),
+        #[cfg(feature = "instrument")]
+        start: Instant::now(),
+    }
+}
+
+#[cfg(feature = "instrument")]
+impl Drop for Scope {
+    #[inline]
+    fn drop(&mut self) {
+        let nanos = self.start.elapsed().as_nanos() as u64;
+        let nested = NESTED.replace(self.parent_nested.saturating_add(nanos));
+        COUNTERS.with(|c| {
+            let mut c = c.borrow_mut();
+            let counter = &mut c.counters[self.subsystem.index()];
+            counter.calls += 1;
+            counter.nanos += nanos;
+            counter.self_nanos += nanos.saturating_sub(nested);
+        });
+    }
+}
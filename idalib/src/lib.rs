@@ -80,18 +80,33 @@ use std::ffi::c_char;
 use std::marker::PhantomData;
 use std::sync::{Mutex, MutexGuard, OnceLock};
 
+pub mod annotations;
+pub mod auto;
 pub mod bookmarks;
+pub mod bytes;
+mod cache;
+pub mod callgraph;
 pub mod decompiler;
+pub mod executor;
+pub mod export;
+pub mod features;
+pub mod flags;
 pub mod func;
 pub mod idb;
 pub mod insn;
+pub mod instrument;
 pub mod license;
+pub mod memory;
 pub mod meta;
+pub mod microcode;
 pub mod name;
 pub mod plugin;
+pub mod pool;
 pub mod processor;
+pub mod scan;
 pub mod segment;
 pub mod strings;
+pub mod template;
 pub mod types;
 pub mod xref;
 
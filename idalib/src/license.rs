@@ -1,8 +1,12 @@
 use std::fmt::Display;
 use std::ops::Deref;
+use std::time::{Duration, Instant};
 
+use crate::ffi::ida::license_state_t;
 use crate::{ffi, init_library, IDAError};
 
+pub use crate::ffi::ida::DEFAULT_LICENSE_CACHE_TTL;
+
 #[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
 pub struct LicenseId([u8; 6]);
 
@@ -37,6 +41,71 @@ impl From<LicenseId> for [u8; 6] {
     }
 }
 
+/// The result of checking (and, if needed, borrowing) the license.
+///
+/// Valid states are cached for the whole process, so that opening further
+/// databases does not query the license manager (and possibly a floating
+/// license server) again; see `set_license_cache_ttl`. Invalid states are
+/// never cached.
+#[derive(Debug, Clone)]
+pub struct LicenseState {
+    state: license_state_t,
+    checked_at: Instant,
+    ttl: Duration,
+}
+
+impl LicenseState {
+    fn new((state, checked_at): (license_state_t, Instant)) -> Self {
+        Self {
+            state,
+            checked_at,
+            ttl: ffi::ida::license_cache_ttl(),
+        }
+    }
+
+    pub fn is_valid(&self) -> bool {
+        self.state.valid
+    }
+
+    pub fn id(&self) -> Option<LicenseId> {
+        self.state.valid.then_some(LicenseId(self.state.id))
+    }
+
+    /// True if the initial check failed and a license had to be borrowed
+    /// (or re-acquired).
+    pub fn was_borrowed(&self) -> bool {
+        self.state.borrowed
+    }
+
+    /// The license manager's result for the borrow, if one was attempted;
+    /// zero on success.
+    pub fn borrow_result(&self) -> Option<i32> {
+        self.state.borrowed.then_some(self.state.borrow_result)
+    }
+
+    /// The license manager's description of why the license could not be
+    /// obtained.
+    pub fn error(&self) -> Option<&str> {
+        (!self.state.error.is_empty()).then_some(self.state.error.as_str())
+    }
+
+    pub fn checked_at(&self) -> Instant {
+        self.checked_at
+    }
+
+    /// When this state stops being reused, if it is cached.
+    pub fn expires_at(&self) -> Option<Instant> {
+        self.state
+            .valid
+            .then(|| self.checked_at.checked_add(self.ttl))
+            .flatten()
+    }
+
+    pub fn is_expired(&self) -> bool {
+        self.expires_at().is_none_or(|at| Instant::now() >= at)
+    }
+}
+
 pub fn is_valid_license() -> bool {
     init_library();
     ffi::ida::is_license_valid()
@@ -46,3 +115,32 @@ pub fn license_id() -> Result<LicenseId, IDAError> {
     init_library();
     Ok(LicenseId(ffi::ida::license_id()?))
 }
+
+/// The cached license state, or a fresh one if none is cached or it has
+/// expired.
+pub fn license_state() -> LicenseState {
+    init_library();
+    LicenseState::new(ffi::ida::license_state())
+}
+
+/// Check the license again, ignoring (and replacing) any cached state.
+pub fn refresh_license() -> LicenseState {
+    init_library();
+    LicenseState::new(ffi::ida::refresh_license_state())
+}
+
+/// Drop the cached license state; the next check queries the license
+/// manager.
+pub fn invalidate_license() {
+    ffi::ida::invalidate_license_state()
+}
+
+pub fn license_cache_ttl() -> Duration {
+    ffi::ida::license_cache_ttl()
+}
+
+/// Set how long a valid license state is reused (default:
+/// `DEFAULT_LICENSE_CACHE_TTL`); zero disables caching.
+pub fn set_license_cache_ttl(ttl: Duration) {
+    ffi::ida::set_license_cache_ttl(ttl)
+}
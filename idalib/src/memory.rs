@@ -0,0 +1,135 @@
+use std::fs;
+use std::path::{Path, PathBuf};
+
+/// Extensions of the files an open database is unpacked into.
+const UNPACKED_COMPONENTS: [&str; 5] = ["id0", "id1", "id2", "nam", "til"];
+
+/// Memory used by the process, and the size of the unpacked database
+/// backing the kernel's page cache; see `IDB::memory_usage`.
+///
+/// When the database is unpacked onto a tmpfs or ramfs (see
+/// `IDBOpenOptions::work_dir`), its files are held in memory too, and are
+/// counted in `total`, the figure to size worker density against.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct MemoryUsage {
+    /// Resident set size, in bytes; `None` where it cannot be read (only
+    /// Linux is supported).
+    pub resident: Option<u64>,
+    /// Peak resident set size, in bytes.
+    pub peak_resident: Option<u64>,
+    /// Virtual memory size, in bytes.
+    pub virtual_size: Option<u64>,
+    /// The unpacked database's component files and their sizes.
+    pub database_files: Vec<(PathBuf, u64)>,
+    /// Whether the unpacked database is on a memory-backed filesystem
+    /// (tmpfs or ramfs); only detected on Linux.
+    pub database_in_memory: bool,
+}
+
+impl MemoryUsage {
+    pub(crate) fn new(unpacked: Option<&Path>) -> Self {
+        let mut usage = Self::default();
+
+        #[cfg(target_os = "linux")]
+        if let Ok(status) = fs::read_to_string("/proc/self/status") {
+            usage.resident = status_field(&status, "VmRSS:");
+            usage.peak_resident = status_field(&status, "VmHWM:");
+            usage.virtual_size = status_field(&status, "VmSize:");
+        }
+
+        if let Some(id0) = unpacked {
+            usage.database_files = UNPACKED_COMPONENTS
+                .iter()
+                .map(|ext| id0.with_extension(ext))
+                .filter_map(|path| {
+                    let size = fs::metadata(&path).ok()?.len();
+                    Some((path, size))
+                })
+                .collect();
+
+            #[cfg(target_os = "linux")]
+            if let Some(dir) = id0.parent() {
+                usage.database_in_memory = in_memory(dir);
+            }
+        }
+
+        usage
+    }
+
+    /// Total size of the unpacked database's files, in bytes.
+    pub fn database_size(&self) -> u64 {
+        self.database_files.iter().map(|(_, size)| size).sum()
+    }
+
+    /// Resident set size, plus the unpacked database's size if it is held
+    /// in memory, in bytes.
+    pub fn total(&self) -> Option<u64> {
+        let database = if self.database_in_memory {
+            self.database_size()
+        } else {
+            0
+        };
+        Some(self.resident? + database)
+    }
+}
+
+// Parses a `/proc/self/status` line such as `VmRSS:     1234 kB`
+#[cfg(target_os = "linux")]
+fn status_field(status: &str, name: &str) -> Option<u64> {
+    let line = status.lines().find(|line| line.starts_with(name))?;
+    let kb = line[name.len()..]
+        .split_whitespace()
+        .next()?
+        .parse::<u64>()
+        .ok()?;
+    Some(kb * 1024)
+}
+
+// Whether `path` is on a tmpfs or ramfs, going by the innermost mount in
+// `/proc/self/mounts` that contains it
+#[cfg(target_os = "linux")]
+fn in_memory(path: &Path) -> bool {
+    let Ok(path) = fs::canonicalize(path) else {
+        return false;
+    };
+    let Ok(mounts) = fs::read_to_string("/proc/self/mounts") else {
+        return false;
+    };
+
+    mounts
+        .lines()
+        .filter_map(|line| {
+            let mut fields = line.split_whitespace();
+            let point = unescape_mount(fields.nth(1)?);
+            let fstype = fields.next()?;
+            Some((point, fstype))
+        })
+        .filter(|(point, _)| path.starts_with(point))
+        .max_by_key(|(point, _)| point.len())
+        .is_some_and(|(_, fstype)| matches!(fstype, "tmpfs" | "ramfs"))
+}
+
+// Undoes the octal escapes (e.g., `\040` for a space) of a mount point
+#[cfg(target_os = "linux")]
+fn unescape_mount(field: &str) -> String {
+    let mut out = String::with_capacity(field.len());
+    let mut rest = field;
+
+    while let Some(at) = rest.find('\\') {
+        out.push_str(&rest[..at]);
+        let escape = rest.get(at + 1..at + 4);
+        match escape.and_then(|oct| u8::from_str_radix(oct, 8).ok()) {
+            Some(byte) => {
+                out.push(char::from(byte));
+                rest = &rest[at + 4..];
+            }
+            None => {
+                out.push('\\');
+                rest = &rest[at + 1..];
+            }
+        }
+    }
+
+    out.push_str(rest);
+    out
+}
@@ -131,683 +131,6 @@ impl<'a> Metadata<'a> {
         }
     }
 
-    pub fn version(&self) -> u16 {
-        unsafe { idalib_inf_get_version() }
-    }
-
-    pub fn genflags(&self) -> u16 {
-        unsafe { idalib_inf_get_genflags() }
-    }
-
-    pub fn is_auto_enabled(&self) -> bool {
-        unsafe { idalib_inf_is_auto_enabled() }
-    }
-
-    pub fn use_allasm(&self) -> bool {
-        unsafe { idalib_inf_use_allasm() }
-    }
-
-    pub fn loading_idc(&self) -> bool {
-        unsafe { idalib_inf_loading_idc() }
-    }
-
-    pub fn no_store_user_info(&self) -> bool {
-        unsafe { idalib_inf_no_store_user_info() }
-    }
-
-    pub fn readonly_idb(&self) -> bool {
-        unsafe { idalib_inf_readonly_idb() }
-    }
-
-    pub fn check_manual_ops(&self) -> bool {
-        unsafe { idalib_inf_check_manual_ops() }
-    }
-
-    pub fn allow_non_matched_ops(&self) -> bool {
-        unsafe { idalib_inf_allow_non_matched_ops() }
-    }
-
-    pub fn is_graph_view(&self) -> bool {
-        unsafe { idalib_inf_is_graph_view() }
-    }
-
-    pub fn lflags(&self) -> u32 {
-        unsafe { idalib_inf_get_lflags() }
-    }
-
-    pub fn decode_fpp(&self) -> bool {
-        unsafe { idalib_inf_decode_fpp() }
-    }
-
-    pub fn is_32bit_or_higher(&self) -> bool {
-        unsafe { idalib_inf_is_32bit_or_higher() }
-    }
-
-    pub fn is_32bit_exactly(&self) -> bool {
-        unsafe { idalib_inf_is_32bit_exactly() }
-    }
-
-    pub fn is_16bit(&self) -> bool {
-        unsafe { idalib_inf_is_16bit() }
-    }
-
-    pub fn is_64bit(&self) -> bool {
-        unsafe { idalib_inf_is_64bit() }
-    }
-
-    pub fn is_dll(&self) -> bool {
-        unsafe { idalib_inf_is_dll() }
-    }
-
-    pub fn is_flat_off32(&self) -> bool {
-        unsafe { idalib_inf_is_flat_off32() }
-    }
-
-    pub fn is_be(&self) -> bool {
-        unsafe { idalib_inf_is_be() }
-    }
-
-    pub fn is_wide_high_byte_first(&self) -> bool {
-        unsafe { idalib_inf_is_wide_high_byte_first() }
-    }
-
-    pub fn dbg_no_store_path(&self) -> bool {
-        unsafe { idalib_inf_dbg_no_store_path() }
-    }
-
-    pub fn is_snapshot(&self) -> bool {
-        unsafe { idalib_inf_is_snapshot() }
-    }
-
-    pub fn pack_idb(&self) -> bool {
-        unsafe { idalib_inf_pack_idb() }
-    }
-
-    pub fn compress_idb(&self) -> bool {
-        unsafe { idalib_inf_compress_idb() }
-    }
-
-    pub fn is_kernel_mode(&self) -> bool {
-        unsafe { idalib_inf_is_kernel_mode() }
-    }
-
-    pub fn app_bitness(&self) -> u32 {
-        unsafe { idalib_inf_get_app_bitness().into() }
-    }
-
-    pub fn database_change_count(&self) -> u32 {
-        unsafe { idalib_inf_get_database_change_count() }
-    }
-
-    pub fn filetype(&self) -> FileType {
-        unsafe { mem::transmute(idalib_inf_get_filetype()) }
-    }
-
-    pub fn ostype(&self) -> u16 {
-        unsafe { idalib_inf_get_ostype() }
-    }
-
-    pub fn apptype(&self) -> u16 {
-        unsafe { idalib_inf_get_apptype() }
-    }
-
-    pub fn asmtype(&self) -> u8 {
-        unsafe { idalib_inf_get_asmtype() }
-    }
-
-    pub fn specsegs(&self) -> u8 {
-        unsafe { idalib_inf_get_specsegs() }
-    }
-
-    pub fn af(&self) -> AnalysisFlags {
-        AnalysisFlags::from_bits_retain(unsafe { idalib_inf_get_af() })
-    }
-
-    pub fn trace_flow(&self) -> bool {
-        unsafe { idalib_inf_trace_flow() }
-    }
-
-    pub fn mark_code(&self) -> bool {
-        unsafe { idalib_inf_mark_code() }
-    }
-
-    pub fn create_jump_tables(&self) -> bool {
-        unsafe { idalib_inf_create_jump_tables() }
-    }
-
-    pub fn noflow_to_data(&self) -> bool {
-        unsafe { idalib_inf_noflow_to_data() }
-    }
-
-    pub fn create_all_xrefs(&self) -> bool {
-        unsafe { idalib_inf_create_all_xrefs() }
-    }
-
-    pub fn create_func_from_ptr(&self) -> bool {
-        unsafe { idalib_inf_create_func_from_ptr() }
-    }
-
-    pub fn create_func_from_call(&self) -> bool {
-        unsafe { idalib_inf_create_func_from_call() }
-    }
-
-    pub fn create_func_tails(&self) -> bool {
-        unsafe { idalib_inf_create_func_tails() }
-    }
-
-    pub fn should_create_stkvars(&self) -> bool {
-        unsafe { idalib_inf_should_create_stkvars() }
-    }
-
-    pub fn propagate_stkargs(&self) -> bool {
-        unsafe { idalib_inf_propagate_stkargs() }
-    }
-
-    pub fn propagate_regargs(&self) -> bool {
-        unsafe { idalib_inf_propagate_regargs() }
-    }
-
-    pub fn should_trace_sp(&self) -> bool {
-        unsafe { idalib_inf_should_trace_sp() }
-    }
-
-    pub fn full_sp_ana(&self) -> bool {
-        unsafe { idalib_inf_full_sp_ana() }
-    }
-
-    pub fn noret_ana(&self) -> bool {
-        unsafe { idalib_inf_noret_ana() }
-    }
-
-    pub fn guess_func_type(&self) -> bool {
-        unsafe { idalib_inf_guess_func_type() }
-    }
-
-    pub fn truncate_on_del(&self) -> bool {
-        unsafe { idalib_inf_truncate_on_del() }
-    }
-
-    pub fn create_strlit_on_xref(&self) -> bool {
-        unsafe { idalib_inf_create_strlit_on_xref() }
-    }
-
-    pub fn check_unicode_strlits(&self) -> bool {
-        unsafe { idalib_inf_check_unicode_strlits() }
-    }
-
-    pub fn create_off_using_fixup(&self) -> bool {
-        unsafe { idalib_inf_create_off_using_fixup() }
-    }
-
-    pub fn create_off_on_dref(&self) -> bool {
-        unsafe { idalib_inf_create_off_on_dref() }
-    }
-
-    pub fn op_offset(&self) -> bool {
-        unsafe { idalib_inf_op_offset() }
-    }
-
-    pub fn data_offset(&self) -> bool {
-        unsafe { idalib_inf_data_offset() }
-    }
-
-    pub fn use_flirt(&self) -> bool {
-        unsafe { idalib_inf_use_flirt() }
-    }
-
-    pub fn append_sigcmt(&self) -> bool {
-        unsafe { idalib_inf_append_sigcmt() }
-    }
-
-    pub fn allow_sigmulti(&self) -> bool {
-        unsafe { idalib_inf_allow_sigmulti() }
-    }
-
-    pub fn hide_libfuncs(&self) -> bool {
-        unsafe { idalib_inf_hide_libfuncs() }
-    }
-
-    pub fn rename_jumpfunc(&self) -> bool {
-        unsafe { idalib_inf_rename_jumpfunc() }
-    }
-
-    pub fn rename_nullsub(&self) -> bool {
-        unsafe { idalib_inf_rename_nullsub() }
-    }
-
-    pub fn coagulate_data(&self) -> bool {
-        unsafe { idalib_inf_coagulate_data() }
-    }
-
-    pub fn coagulate_code(&self) -> bool {
-        unsafe { idalib_inf_coagulate_code() }
-    }
-
-    pub fn final_pass(&self) -> bool {
-        unsafe { idalib_inf_final_pass() }
-    }
-
-    pub fn af2(&self) -> u32 {
-        unsafe { idalib_inf_get_af2() }
-    }
-
-    pub fn handle_eh(&self) -> bool {
-        unsafe { idalib_inf_handle_eh() }
-    }
-
-    pub fn handle_rtti(&self) -> bool {
-        unsafe { idalib_inf_handle_rtti() }
-    }
-
-    pub fn macros_enabled(&self) -> bool {
-        unsafe { idalib_inf_macros_enabled() }
-    }
-
-    pub fn merge_strlits(&self) -> bool {
-        unsafe { idalib_inf_merge_strlits() }
-    }
-
-    pub fn base_address(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_baseaddr() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn start_stack_segment(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_start_ss() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn start_code_segment(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_start_cs() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn start_instruction_pointer(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_start_ip() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn start_address(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_start_ea() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn start_stack_pointer(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_start_sp() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn main_address(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_main() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn min_address(&self) -> Address {
-        unsafe { idalib_inf_get_min_ea().into() }
-    }
-
-    pub fn max_address(&self) -> Address {
-        unsafe { idalib_inf_get_max_ea().into() }
-    }
-
-    pub fn omin_address(&self) -> Address {
-        unsafe { idalib_inf_get_omin_ea().into() }
-    }
-
-    pub fn omax_ea(&self) -> Address {
-        unsafe { idalib_inf_get_omax_ea().into() }
-    }
-
-    pub fn lowoff(&self) -> u64 {
-        unsafe { idalib_inf_get_lowoff().into() }
-    }
-
-    pub fn highoff(&self) -> u64 {
-        unsafe { idalib_inf_get_highoff().into() }
-    }
-
-    pub fn maxref(&self) -> u64 {
-        unsafe { idalib_inf_get_maxref().into() }
-    }
-
-    pub fn netdelta(&self) -> i64 {
-        unsafe { idalib_inf_get_netdelta().into() }
-    }
-
-    pub fn xrefnum(&self) -> u8 {
-        unsafe { idalib_inf_get_xrefnum() }
-    }
-
-    pub fn type_xrefnum(&self) -> u8 {
-        unsafe { idalib_inf_get_type_xrefnum() }
-    }
-
-    pub fn refcmtnum(&self) -> u8 {
-        unsafe { idalib_inf_get_refcmtnum() }
-    }
-
-    pub fn xrefflag(&self) -> u8 {
-        unsafe { idalib_inf_get_xrefflag() }
-    }
-
-    pub fn show_xref_seg(&self) -> bool {
-        unsafe { idalib_inf_show_xref_seg() }
-    }
-
-    pub fn show_xref_tmarks(&self) -> bool {
-        unsafe { idalib_inf_show_xref_tmarks() }
-    }
-
-    pub fn show_xref_fncoff(&self) -> bool {
-        unsafe { idalib_inf_show_xref_fncoff() }
-    }
-
-    pub fn show_xref_val(&self) -> bool {
-        unsafe { idalib_inf_show_xref_val() }
-    }
-
-    pub fn max_autoname_len(&self) -> u16 {
-        unsafe { idalib_inf_get_max_autoname_len() }
-    }
-
-    pub fn nametype(&self) -> i8 {
-        unsafe { idalib_inf_get_nametype() }
-    }
-
-    pub fn short_demnames(&self) -> u32 {
-        unsafe { idalib_inf_get_short_demnames() }
-    }
-
-    pub fn long_demnames(&self) -> u32 {
-        unsafe { idalib_inf_get_long_demnames() }
-    }
-
-    pub fn demnames(&self) -> u8 {
-        unsafe { idalib_inf_get_demnames() }
-    }
-
-    pub fn listnames(&self) -> u8 {
-        unsafe { idalib_inf_get_listnames() }
-    }
-
-    pub fn indent(&self) -> u8 {
-        unsafe { idalib_inf_get_indent() }
-    }
-
-    pub fn cmt_indent(&self) -> u8 {
-        unsafe { idalib_inf_get_cmt_indent() }
-    }
-
-    pub fn margin(&self) -> u16 {
-        unsafe { idalib_inf_get_margin() }
-    }
-
-    pub fn lenxref(&self) -> u16 {
-        unsafe { idalib_inf_get_lenxref() }
-    }
-
-    pub fn outflags(&self) -> u32 {
-        unsafe { idalib_inf_get_outflags() }
-    }
-
-    pub fn show_void(&self) -> bool {
-        unsafe { idalib_inf_show_void() }
-    }
-
-    pub fn show_auto(&self) -> bool {
-        unsafe { idalib_inf_show_auto() }
-    }
-
-    pub fn gen_null(&self) -> bool {
-        unsafe { idalib_inf_gen_null() }
-    }
-
-    pub fn show_line_pref(&self) -> bool {
-        unsafe { idalib_inf_show_line_pref() }
-    }
-
-    pub fn line_pref_with_seg(&self) -> bool {
-        unsafe { idalib_inf_line_pref_with_seg() }
-    }
-
-    pub fn gen_lzero(&self) -> bool {
-        unsafe { idalib_inf_gen_lzero() }
-    }
-
-    pub fn gen_org(&self) -> bool {
-        unsafe { idalib_inf_gen_org() }
-    }
-
-    pub fn gen_assume(&self) -> bool {
-        unsafe { idalib_inf_gen_assume() }
-    }
-
-    pub fn gen_tryblks(&self) -> bool {
-        unsafe { idalib_inf_gen_tryblks() }
-    }
-
-    pub fn cmtflg(&self) -> u8 {
-        unsafe { idalib_inf_get_cmtflg() }
-    }
-
-    pub fn show_repeatables(&self) -> bool {
-        unsafe { idalib_inf_show_repeatables() }
-    }
-
-    pub fn show_all_comments(&self) -> bool {
-        unsafe { idalib_inf_show_all_comments() }
-    }
-
-    pub fn hide_comments(&self) -> bool {
-        unsafe { idalib_inf_hide_comments() }
-    }
-
-    pub fn show_src_linnum(&self) -> bool {
-        unsafe { idalib_inf_show_src_linnum() }
-    }
-
-    pub fn test_mode(&self) -> bool {
-        unsafe { idalib_inf_test_mode() }
-    }
-
-    pub fn show_hidden_insns(&self) -> bool {
-        unsafe { idalib_inf_show_hidden_insns() }
-    }
-
-    pub fn show_hidden_funcs(&self) -> bool {
-        unsafe { idalib_inf_show_hidden_funcs() }
-    }
-
-    pub fn show_hidden_segms(&self) -> bool {
-        unsafe { idalib_inf_show_hidden_segms() }
-    }
-
-    pub fn limiter(&self) -> u8 {
-        unsafe { idalib_inf_get_limiter() }
-    }
-
-    pub fn is_limiter_thin(&self) -> bool {
-        unsafe { idalib_inf_is_limiter_thin() }
-    }
-
-    pub fn is_limiter_thick(&self) -> bool {
-        unsafe { idalib_inf_is_limiter_thick() }
-    }
-
-    pub fn is_limiter_empty(&self) -> bool {
-        unsafe { idalib_inf_is_limiter_empty() }
-    }
-
-    pub fn bin_prefix_size(&self) -> i16 {
-        unsafe { idalib_inf_get_bin_prefix_size().into() }
-    }
-
-    pub fn prefflag(&self) -> u8 {
-        unsafe { idalib_inf_get_prefflag() }
-    }
-
-    pub fn prefix_show_segaddr(&self) -> bool {
-        unsafe { idalib_inf_prefix_show_segaddr() }
-    }
-
-    pub fn prefix_show_funcoff(&self) -> bool {
-        unsafe { idalib_inf_prefix_show_funcoff() }
-    }
-
-    pub fn prefix_show_stack(&self) -> bool {
-        unsafe { idalib_inf_prefix_show_stack() }
-    }
-
-    pub fn prefix_truncate_opcode_bytes(&self) -> bool {
-        unsafe { idalib_inf_prefix_truncate_opcode_bytes() }
-    }
-
-    pub fn strlit_flags(&self) -> u8 {
-        unsafe { idalib_inf_get_strlit_flags() }
-    }
-
-    pub fn strlit_names(&self) -> bool {
-        unsafe { idalib_inf_strlit_names() }
-    }
-
-    pub fn strlit_name_bit(&self) -> bool {
-        unsafe { idalib_inf_strlit_name_bit() }
-    }
-
-    pub fn strlit_serial_names(&self) -> bool {
-        unsafe { idalib_inf_strlit_serial_names() }
-    }
-
-    pub fn unicode_strlits(&self) -> bool {
-        unsafe { idalib_inf_unicode_strlits() }
-    }
-
-    pub fn strlit_autocmt(&self) -> bool {
-        unsafe { idalib_inf_strlit_autocmt() }
-    }
-
-    pub fn strlit_savecase(&self) -> bool {
-        unsafe { idalib_inf_strlit_savecase() }
-    }
-
-    pub fn strlit_break(&self) -> u8 {
-        unsafe { idalib_inf_get_strlit_break() }
-    }
-
-    pub fn strlit_zeroes(&self) -> i8 {
-        unsafe { idalib_inf_get_strlit_zeroes() }
-    }
-
-    pub fn strtype(&self) -> i32 {
-        unsafe { idalib_inf_get_strtype() }
-    }
-
-    pub fn strlit_sernum(&self) -> u64 {
-        unsafe { idalib_inf_get_strlit_sernum().into() }
-    }
-
-    pub fn datatypes(&self) -> u64 {
-        unsafe { idalib_inf_get_datatypes().into() }
-    }
-
-    pub fn abibits(&self) -> u32 {
-        unsafe { idalib_inf_get_abibits() }
-    }
-
-    pub fn is_mem_aligned4(&self) -> bool {
-        unsafe { idalib_inf_is_mem_aligned4() }
-    }
-
-    pub fn pack_stkargs(&self) -> bool {
-        unsafe { idalib_inf_pack_stkargs() }
-    }
-
-    pub fn big_arg_align(&self) -> bool {
-        unsafe { idalib_inf_big_arg_align() }
-    }
-
-    pub fn stack_ldbl(&self) -> bool {
-        unsafe { idalib_inf_stack_ldbl() }
-    }
-
-    pub fn stack_varargs(&self) -> bool {
-        unsafe { idalib_inf_stack_varargs() }
-    }
-
-    pub fn is_hard_float(&self) -> bool {
-        unsafe { idalib_inf_is_hard_float() }
-    }
-
-    pub fn abi_set_by_user(&self) -> bool {
-        unsafe { idalib_inf_abi_set_by_user() }
-    }
-
-    pub fn use_gcc_layout(&self) -> bool {
-        unsafe { idalib_inf_use_gcc_layout() }
-    }
-
-    pub fn map_stkargs(&self) -> bool {
-        unsafe { idalib_inf_map_stkargs() }
-    }
-
-    pub fn huge_arg_align(&self) -> bool {
-        unsafe { idalib_inf_huge_arg_align() }
-    }
-
-    pub fn appcall_options(&self) -> u32 {
-        unsafe { idalib_inf_get_appcall_options() }
-    }
-
-    pub fn privrange_start_address(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_privrange_start_ea() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn privrange_end_address(&self) -> Option<Address> {
-        let ea = unsafe { idalib_inf_get_privrange_end_ea() };
-        if ea != BADADDR { Some(ea.into()) } else { None }
-    }
-
-    pub fn cc_id(&self) -> Compiler {
-        unsafe { mem::transmute(idalib_inf_get_cc_id() & COMP_MASK) }
-    }
-
-    pub fn cc_cm(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_cm() }
-    }
-
-    pub fn cc_size_i(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_size_i() }
-    }
-
-    pub fn cc_size_b(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_size_b() }
-    }
-
-    pub fn cc_size_e(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_size_e() }
-    }
-
-    pub fn cc_defalign(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_defalign() }
-    }
-
-    pub fn cc_size_s(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_size_s() }
-    }
-
-    pub fn cc_size_l(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_size_l() }
-    }
-
-    pub fn cc_size_ll(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_size_ll() }
-    }
-
-    pub fn cc_size_ldbl(&self) -> u8 {
-        unsafe { idalib_inf_get_cc_size_ldbl() }
-    }
-
     pub fn procname(&self) -> String {
         unsafe { idalib_inf_get_procname() }
     }
@@ -835,12 +158,289 @@ impl<'a> Metadata<'a> {
     pub fn input_file_path(&self) -> String {
         unsafe { idalib_get_input_file_path() }
     }
+}
 
-    pub fn input_file_size(&self) -> usize {
-        unsafe { retrieve_input_file_size() }
+/// A copy of all database metadata taken in a single call; see
+/// `IDB::meta_snapshot`.
+///
+/// The accessors mirror those of `Metadata`, but read from the copy, so the
+/// snapshot stays valid (and unchanged) after the database is modified or
+/// closed.
+#[derive(Debug, Clone)]
+pub struct MetadataSnapshot {
+    raw: inf_snapshot_t,
+}
+
+impl MetadataSnapshot {
+    pub(crate) fn new() -> Self {
+        let mut raw = inf_snapshot_t::default();
+        unsafe { idalib_inf_snapshot(&mut raw) };
+        Self { raw }
+    }
+
+    pub fn procname(&self) -> &str {
+        &self.raw.procname
+    }
+
+    pub fn strlit_pref(&self) -> &str {
+        &self.raw.strlit_pref
+    }
+
+    pub fn input_file_md5(&self) -> [u8; 16] {
+        self.raw.input_file_md5
+    }
+
+    pub fn input_file_sha256(&self) -> [u8; 32] {
+        self.raw.input_file_sha256
+    }
+
+    pub fn input_file_path(&self) -> &str {
+        &self.raw.input_file_path
     }
 }
 
+// The accessors shared by `Metadata` and `MetadataSnapshot`, as
+// `name: type = kind(getter)`: the `Metadata` accessor calls the getter, and
+// the `MetadataSnapshot` accessor reads the `inf_snapshot_t` field of the
+// same name, which `idalib_inf_snapshot` fills from the same getter. `kind`
+// is how the raw value is converted:
+//
+// - `value`: returned as is
+// - `into`: converted with `Into` from the getter's C type
+// - `address`: `None` if `BADADDR`
+// - `flags`: `from_bits_retain` of the bitflags type
+// - `repr`: transmuted to the enum of the same representation
+// - `compiler`: as `repr`, after masking the getter's value by `COMP_MASK`
+//   (the snapshot is masked when taken)
+macro_rules! metadata_accessors {
+    ($($name:ident: $ty:ty = $kind:ident($get:ident),)*) => {
+        impl<'a> Metadata<'a> {
+            $(
+                pub fn $name(&self) -> $ty {
+                    unsafe { metadata_accessors!(@live $kind $ty, $get()) }
+                }
+            )*
+        }
+
+        impl MetadataSnapshot {
+            $(
+                pub fn $name(&self) -> $ty {
+                    metadata_accessors!(@snapshot $kind $ty, self.raw.$name)
+                }
+            )*
+        }
+    };
+    (@live value $ty:ty, $raw:expr) => {
+        $raw
+    };
+    (@live into $ty:ty, $raw:expr) => {
+        $raw.into()
+    };
+    (@live address $ty:ty, $raw:expr) => {{
+        let ea = $raw;
+        if ea != BADADDR { Some(ea.into()) } else { None }
+    }};
+    (@live flags $ty:ty, $raw:expr) => {
+        <$ty>::from_bits_retain($raw)
+    };
+    (@live repr $ty:ty, $raw:expr) => {
+        mem::transmute($raw)
+    };
+    (@live compiler $ty:ty, $raw:expr) => {
+        mem::transmute($raw & COMP_MASK)
+    };
+    (@snapshot value $ty:ty, $raw:expr) => {
+        $raw
+    };
+    (@snapshot into $ty:ty, $raw:expr) => {
+        $raw
+    };
+    (@snapshot address $ty:ty, $raw:expr) => {{
+        let ea = $raw;
+        (ea != u64::from(BADADDR)).then_some(ea)
+    }};
+    (@snapshot flags $ty:ty, $raw:expr) => {
+        <$ty>::from_bits_retain($raw)
+    };
+    (@snapshot repr $ty:ty, $raw:expr) => {
+        unsafe { mem::transmute($raw) }
+    };
+    (@snapshot compiler $ty:ty, $raw:expr) => {
+        unsafe { mem::transmute($raw) }
+    };
+}
+
+metadata_accessors! {
+    version: u16 = value(idalib_inf_get_version),
+    genflags: u16 = value(idalib_inf_get_genflags),
+    is_auto_enabled: bool = value(idalib_inf_is_auto_enabled),
+    use_allasm: bool = value(idalib_inf_use_allasm),
+    loading_idc: bool = value(idalib_inf_loading_idc),
+    no_store_user_info: bool = value(idalib_inf_no_store_user_info),
+    readonly_idb: bool = value(idalib_inf_readonly_idb),
+    check_manual_ops: bool = value(idalib_inf_check_manual_ops),
+    allow_non_matched_ops: bool = value(idalib_inf_allow_non_matched_ops),
+    is_graph_view: bool = value(idalib_inf_is_graph_view),
+    lflags: u32 = value(idalib_inf_get_lflags),
+    decode_fpp: bool = value(idalib_inf_decode_fpp),
+    is_32bit_or_higher: bool = value(idalib_inf_is_32bit_or_higher),
+    is_32bit_exactly: bool = value(idalib_inf_is_32bit_exactly),
+    is_16bit: bool = value(idalib_inf_is_16bit),
+    is_64bit: bool = value(idalib_inf_is_64bit),
+    is_dll: bool = value(idalib_inf_is_dll),
+    is_flat_off32: bool = value(idalib_inf_is_flat_off32),
+    is_be: bool = value(idalib_inf_is_be),
+    is_wide_high_byte_first: bool = value(idalib_inf_is_wide_high_byte_first),
+    dbg_no_store_path: bool = value(idalib_inf_dbg_no_store_path),
+    is_snapshot: bool = value(idalib_inf_is_snapshot),
+    pack_idb: bool = value(idalib_inf_pack_idb),
+    compress_idb: bool = value(idalib_inf_compress_idb),
+    is_kernel_mode: bool = value(idalib_inf_is_kernel_mode),
+    app_bitness: u32 = into(idalib_inf_get_app_bitness),
+    database_change_count: u32 = value(idalib_inf_get_database_change_count),
+    filetype: FileType = repr(idalib_inf_get_filetype),
+    ostype: u16 = value(idalib_inf_get_ostype),
+    apptype: u16 = value(idalib_inf_get_apptype),
+    asmtype: u8 = value(idalib_inf_get_asmtype),
+    specsegs: u8 = value(idalib_inf_get_specsegs),
+    af: AnalysisFlags = flags(idalib_inf_get_af),
+    trace_flow: bool = value(idalib_inf_trace_flow),
+    mark_code: bool = value(idalib_inf_mark_code),
+    create_jump_tables: bool = value(idalib_inf_create_jump_tables),
+    noflow_to_data: bool = value(idalib_inf_noflow_to_data),
+    create_all_xrefs: bool = value(idalib_inf_create_all_xrefs),
+    create_func_from_ptr: bool = value(idalib_inf_create_func_from_ptr),
+    create_func_from_call: bool = value(idalib_inf_create_func_from_call),
+    create_func_tails: bool = value(idalib_inf_create_func_tails),
+    should_create_stkvars: bool = value(idalib_inf_should_create_stkvars),
+    propagate_stkargs: bool = value(idalib_inf_propagate_stkargs),
+    propagate_regargs: bool = value(idalib_inf_propagate_regargs),
+    should_trace_sp: bool = value(idalib_inf_should_trace_sp),
+    full_sp_ana: bool = value(idalib_inf_full_sp_ana),
+    noret_ana: bool = value(idalib_inf_noret_ana),
+    guess_func_type: bool = value(idalib_inf_guess_func_type),
+    truncate_on_del: bool = value(idalib_inf_truncate_on_del),
+    create_strlit_on_xref: bool = value(idalib_inf_create_strlit_on_xref),
+    check_unicode_strlits: bool = value(idalib_inf_check_unicode_strlits),
+    create_off_using_fixup: bool = value(idalib_inf_create_off_using_fixup),
+    create_off_on_dref: bool = value(idalib_inf_create_off_on_dref),
+    op_offset: bool = value(idalib_inf_op_offset),
+    data_offset: bool = value(idalib_inf_data_offset),
+    use_flirt: bool = value(idalib_inf_use_flirt),
+    append_sigcmt: bool = value(idalib_inf_append_sigcmt),
+    allow_sigmulti: bool = value(idalib_inf_allow_sigmulti),
+    hide_libfuncs: bool = value(idalib_inf_hide_libfuncs),
+    rename_jumpfunc: bool = value(idalib_inf_rename_jumpfunc),
+    rename_nullsub: bool = value(idalib_inf_rename_nullsub),
+    coagulate_data: bool = value(idalib_inf_coagulate_data),
+    coagulate_code: bool = value(idalib_inf_coagulate_code),
+    final_pass: bool = value(idalib_inf_final_pass),
+    af2: u32 = value(idalib_inf_get_af2),
+    handle_eh: bool = value(idalib_inf_handle_eh),
+    handle_rtti: bool = value(idalib_inf_handle_rtti),
+    macros_enabled: bool = value(idalib_inf_macros_enabled),
+    merge_strlits: bool = value(idalib_inf_merge_strlits),
+    base_address: Option<Address> = address(idalib_inf_get_baseaddr),
+    start_stack_segment: Option<Address> = address(idalib_inf_get_start_ss),
+    start_code_segment: Option<Address> = address(idalib_inf_get_start_cs),
+    start_instruction_pointer: Option<Address> = address(idalib_inf_get_start_ip),
+    start_address: Option<Address> = address(idalib_inf_get_start_ea),
+    start_stack_pointer: Option<Address> = address(idalib_inf_get_start_sp),
+    main_address: Option<Address> = address(idalib_inf_get_main),
+    min_address: Address = into(idalib_inf_get_min_ea),
+    max_address: Address = into(idalib_inf_get_max_ea),
+    omin_address: Address = into(idalib_inf_get_omin_ea),
+    omax_ea: Address = into(idalib_inf_get_omax_ea),
+    lowoff: u64 = into(idalib_inf_get_lowoff),
+    highoff: u64 = into(idalib_inf_get_highoff),
+    maxref: u64 = into(idalib_inf_get_maxref),
+    netdelta: i64 = into(idalib_inf_get_netdelta),
+    xrefnum: u8 = value(idalib_inf_get_xrefnum),
+    type_xrefnum: u8 = value(idalib_inf_get_type_xrefnum),
+    refcmtnum: u8 = value(idalib_inf_get_refcmtnum),
+    xrefflag: u8 = value(idalib_inf_get_xrefflag),
+    show_xref_seg: bool = value(idalib_inf_show_xref_seg),
+    show_xref_tmarks: bool = value(idalib_inf_show_xref_tmarks),
+    show_xref_fncoff: bool = value(idalib_inf_show_xref_fncoff),
+    show_xref_val: bool = value(idalib_inf_show_xref_val),
+    max_autoname_len: u16 = value(idalib_inf_get_max_autoname_len),
+    nametype: i8 = value(idalib_inf_get_nametype),
+    short_demnames: u32 = value(idalib_inf_get_short_demnames),
+    long_demnames: u32 = value(idalib_inf_get_long_demnames),
+    demnames: u8 = value(idalib_inf_get_demnames),
+    listnames: u8 = value(idalib_inf_get_listnames),
+    indent: u8 = value(idalib_inf_get_indent),
+    cmt_indent: u8 = value(idalib_inf_get_cmt_indent),
+    margin: u16 = value(idalib_inf_get_margin),
+    lenxref: u16 = value(idalib_inf_get_lenxref),
+    outflags: u32 = value(idalib_inf_get_outflags),
+    show_void: bool = value(idalib_inf_show_void),
+    show_auto: bool = value(idalib_inf_show_auto),
+    gen_null: bool = value(idalib_inf_gen_null),
+    show_line_pref: bool = value(idalib_inf_show_line_pref),
+    line_pref_with_seg: bool = value(idalib_inf_line_pref_with_seg),
+    gen_lzero: bool = value(idalib_inf_gen_lzero),
+    gen_org: bool = value(idalib_inf_gen_org),
+    gen_assume: bool = value(idalib_inf_gen_assume),
+    gen_tryblks: bool = value(idalib_inf_gen_tryblks),
+    cmtflg: u8 = value(idalib_inf_get_cmtflg),
+    show_repeatables: bool = value(idalib_inf_show_repeatables),
+    show_all_comments: bool = value(idalib_inf_show_all_comments),
+    hide_comments: bool = value(idalib_inf_hide_comments),
+    show_src_linnum: bool = value(idalib_inf_show_src_linnum),
+    test_mode: bool = value(idalib_inf_test_mode),
+    show_hidden_insns: bool = value(idalib_inf_show_hidden_insns),
+    show_hidden_funcs: bool = value(idalib_inf_show_hidden_funcs),
+    show_hidden_segms: bool = value(idalib_inf_show_hidden_segms),
+    limiter: u8 = value(idalib_inf_get_limiter),
+    is_limiter_thin: bool = value(idalib_inf_is_limiter_thin),
+    is_limiter_thick: bool = value(idalib_inf_is_limiter_thick),
+    is_limiter_empty: bool = value(idalib_inf_is_limiter_empty),
+    bin_prefix_size: i16 = into(idalib_inf_get_bin_prefix_size),
+    prefflag: u8 = value(idalib_inf_get_prefflag),
+    prefix_show_segaddr: bool = value(idalib_inf_prefix_show_segaddr),
+    prefix_show_funcoff: bool = value(idalib_inf_prefix_show_funcoff),
+    prefix_show_stack: bool = value(idalib_inf_prefix_show_stack),
+    prefix_truncate_opcode_bytes: bool = value(idalib_inf_prefix_truncate_opcode_bytes),
+    strlit_flags: u8 = value(idalib_inf_get_strlit_flags),
+    strlit_names: bool = value(idalib_inf_strlit_names),
+    strlit_name_bit: bool = value(idalib_inf_strlit_name_bit),
+    strlit_serial_names: bool = value(idalib_inf_strlit_serial_names),
+    unicode_strlits: bool = value(idalib_inf_unicode_strlits),
+    strlit_autocmt: bool = value(idalib_inf_strlit_autocmt),
+    strlit_savecase: bool = value(idalib_inf_strlit_savecase),
+    strlit_break: u8 = value(idalib_inf_get_strlit_break),
+    strlit_zeroes: i8 = value(idalib_inf_get_strlit_zeroes),
+    strtype: i32 = value(idalib_inf_get_strtype),
+    strlit_sernum: u64 = into(idalib_inf_get_strlit_sernum),
+    datatypes: u64 = into(idalib_inf_get_datatypes),
+    abibits: u32 = value(idalib_inf_get_abibits),
+    is_mem_aligned4: bool = value(idalib_inf_is_mem_aligned4),
+    pack_stkargs: bool = value(idalib_inf_pack_stkargs),
+    big_arg_align: bool = value(idalib_inf_big_arg_align),
+    stack_ldbl: bool = value(idalib_inf_stack_ldbl),
+    stack_varargs: bool = value(idalib_inf_stack_varargs),
+    is_hard_float: bool = value(idalib_inf_is_hard_float),
+    abi_set_by_user: bool = value(idalib_inf_abi_set_by_user),
+    use_gcc_layout: bool = value(idalib_inf_use_gcc_layout),
+    map_stkargs: bool = value(idalib_inf_map_stkargs),
+    huge_arg_align: bool = value(idalib_inf_huge_arg_align),
+    appcall_options: u32 = value(idalib_inf_get_appcall_options),
+    privrange_start_address: Option<Address> = address(idalib_inf_get_privrange_start_ea),
+    privrange_end_address: Option<Address> = address(idalib_inf_get_privrange_end_ea),
+    cc_id: Compiler = compiler(idalib_inf_get_cc_id),
+    cc_cm: u8 = value(idalib_inf_get_cc_cm),
+    cc_size_i: u8 = value(idalib_inf_get_cc_size_i),
+    cc_size_b: u8 = value(idalib_inf_get_cc_size_b),
+    cc_size_e: u8 = value(idalib_inf_get_cc_size_e),
+    cc_defalign: u8 = value(idalib_inf_get_cc_defalign),
+    cc_size_s: u8 = value(idalib_inf_get_cc_size_s),
+    cc_size_l: u8 = value(idalib_inf_get_cc_size_l),
+    cc_size_ll: u8 = value(idalib_inf_get_cc_size_ll),
+    cc_size_ldbl: u8 = value(idalib_inf_get_cc_size_ldbl),
+    input_file_size: usize = value(retrieve_input_file_size),
+}
+
 pub struct MetadataMut<'a> {
     _marker: PhantomData<&'a mut IDB>,
 }
@@ -0,0 +1,348 @@
+use std::ops::Range;
+
+use crate::ffi::BADADDR;
+use crate::ffi::hexrays::{gen_microcode, microcode_export_t, minsn_node_t, mop_node_t};
+use crate::func::Function;
+use crate::instrument::{self, Subsystem};
+use crate::{Address, IDAError};
+
+/// How far Hex-Rays runs before microcode is exported (`mba_maturity_t`).
+///
+/// Each level includes all earlier passes; stopping early skips the
+/// remaining optimisation passes as well as ctree construction.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash, Default)]
+pub enum Maturity {
+    /// Immediately after generation
+    Generated,
+    /// After preoptimization
+    Preoptimized,
+    /// After local optimizations
+    LocalOpt,
+    /// After call analysis (arguments and return values are known)
+    #[default]
+    Calls,
+    /// After the first pass of global optimizations
+    GlobalOpt1,
+    /// After the second pass of global optimizations
+    GlobalOpt2,
+    /// After the third pass of global optimizations
+    GlobalOpt3,
+    /// After local variable allocation
+    LocalVars,
+}
+
+impl Maturity {
+    pub fn as_raw(&self) -> i32 {
+        match self {
+            Self::Generated => 1,
+            Self::Preoptimized => 2,
+            Self::LocalOpt => 3,
+            Self::Calls => 4,
+            Self::GlobalOpt1 => 5,
+            Self::GlobalOpt2 => 6,
+            Self::GlobalOpt3 => 7,
+            Self::LocalVars => 8,
+        }
+    }
+
+    fn from_raw(raw: i32) -> Option<Self> {
+        Some(match raw {
+            1 => Self::Generated,
+            2 => Self::Preoptimized,
+            3 => Self::LocalOpt,
+            4 => Self::Calls,
+            5 => Self::GlobalOpt1,
+            6 => Self::GlobalOpt2,
+            7 => Self::GlobalOpt3,
+            8 => Self::LocalVars,
+            _ => return None,
+        })
+    }
+}
+
+/// The kind of a microcode operand (`mopt_t`).
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum MOperandKind {
+    /// Micro register (`mop_r`)
+    Register,
+    /// Immediate number (`mop_n`)
+    Number,
+    /// Immediate string (`mop_str`)
+    String,
+    /// Result of a nested instruction (`mop_d`)
+    Insn,
+    /// Local stack variable (`mop_S`)
+    Stack,
+    /// Global variable (`mop_v`)
+    Global,
+    /// Block number (`mop_b`)
+    Block,
+    /// List of call arguments (`mop_f`)
+    Call,
+    /// Local variable (`mop_l`)
+    LocalVar,
+    /// Address of an operand (`mop_a`)
+    Address,
+    /// Helper function name (`mop_h`)
+    Helper,
+    /// Switch cases (`mop_c`)
+    Cases,
+    /// Floating point constant (`mop_fn`)
+    Float,
+    /// Operand pair (`mop_p`)
+    Pair,
+    /// Scattered operand (`mop_sc`)
+    Scattered,
+    Other(u8),
+}
+
+impl MOperandKind {
+    fn from_raw(raw: u8) -> Self {
+        match raw {
+            1 => Self::Register,
+            2 => Self::Number,
+            3 => Self::String,
+            4 => Self::Insn,
+            5 => Self::Stack,
+            6 => Self::Global,
+            7 => Self::Block,
+            8 => Self::Call,
+            9 => Self::LocalVar,
+            10 => Self::Address,
+            11 => Self::Helper,
+            12 => Self::Cases,
+            13 => Self::Float,
+            14 => Self::Pair,
+            15 => Self::Scattered,
+            other => Self::Other(other),
+        }
+    }
+}
+
+pub type MBlockId = usize;
+pub type MInsnId = usize;
+pub type MOperandId = usize;
+
+/// A function's microcode at a chosen maturity, flattened into arrays of
+/// blocks, instructions and operands.
+///
+/// Instructions are stored in pre-order: each top-level instruction of a
+/// block is followed by the instructions nested in its operands, so a
+/// block's instructions (top-level and nested) are a contiguous range.
+#[derive(Debug)]
+pub struct Microcode {
+    raw: microcode_export_t,
+}
+
+impl Microcode {
+    pub(crate) fn new(
+        f: &Function,
+        maturity: Maturity,
+        all_blocks: bool,
+    ) -> Result<Self, IDAError> {
+        let _ffi = instrument::scope(Subsystem::HexRays, "microcode");
+
+        let mut raw = microcode_export_t::default();
+        unsafe { gen_microcode(f.as_ptr(), maturity.as_raw(), all_blocks, &mut raw)? };
+
+        Ok(Self { raw })
+    }
+
+    /// The maturity actually reached.
+    pub fn maturity(&self) -> Option<Maturity> {
+        Maturity::from_raw(self.raw.maturity)
+    }
+
+    pub fn block_count(&self) -> usize {
+        self.raw.block_starts.len()
+    }
+
+    pub fn block(&self, id: MBlockId) -> Option<MBlock<'_>> {
+        (id < self.block_count()).then_some(MBlock { mc: self, id })
+    }
+
+    pub fn blocks(&self) -> impl ExactSizeIterator<Item = MBlock<'_>> + '_ {
+        (0..self.block_count()).map(|id| MBlock { mc: self, id })
+    }
+
+    pub fn insn_count(&self) -> usize {
+        self.raw.insns.len()
+    }
+
+    pub fn insn(&self, id: MInsnId) -> Option<MInsn<'_>> {
+        (id < self.insn_count()).then_some(MInsn { mc: self, id })
+    }
+
+    /// Every instruction, top-level and nested, in pre-order.
+    pub fn insns(&self) -> impl ExactSizeIterator<Item = MInsn<'_>> + '_ {
+        (0..self.insn_count()).map(|id| MInsn { mc: self, id })
+    }
+
+    pub fn operand_count(&self) -> usize {
+        self.raw.operands.len()
+    }
+
+    pub fn operand(&self, id: MOperandId) -> Option<MOperand<'_>> {
+        (id < self.operand_count()).then_some(MOperand { mc: self, id })
+    }
+
+    pub fn operands(&self) -> impl ExactSizeIterator<Item = MOperand<'_>> + '_ {
+        (0..self.operand_count()).map(|id| MOperand { mc: self, id })
+    }
+
+    fn index(id: i32) -> Option<usize> {
+        (id >= 0).then_some(id as usize)
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct MBlock<'m> {
+    mc: &'m Microcode,
+    id: MBlockId,
+}
+
+impl<'m> MBlock<'m> {
+    pub fn id(&self) -> MBlockId {
+        self.id
+    }
+
+    pub fn start_address(&self) -> Address {
+        self.mc.raw.block_starts[self.id]
+    }
+
+    pub fn end_address(&self) -> Address {
+        self.mc.raw.block_ends[self.id]
+    }
+
+    /// The block's `mblock_type_t`.
+    pub fn kind(&self) -> i32 {
+        self.mc.raw.block_types[self.id]
+    }
+
+    pub fn succs(&self) -> &'m [u32] {
+        let raw = &self.mc.raw;
+        let (start, end) = (raw.succ_offsets[self.id], raw.succ_offsets[self.id + 1]);
+        &raw.succs[start as usize..end as usize]
+    }
+
+    pub fn preds(&self) -> &'m [u32] {
+        let raw = &self.mc.raw;
+        let (start, end) = (raw.pred_offsets[self.id], raw.pred_offsets[self.id + 1]);
+        &raw.preds[start as usize..end as usize]
+    }
+
+    /// Ids of the block's instructions, including nested ones.
+    pub fn insn_range(&self) -> Range<MInsnId> {
+        let raw = &self.mc.raw;
+        raw.insn_offsets[self.id] as usize..raw.insn_offsets[self.id + 1] as usize
+    }
+
+    /// The block's top-level instructions, in order.
+    pub fn insns(&self) -> impl Iterator<Item = MInsn<'m>> + 'm {
+        let mc = self.mc;
+        self.insn_range()
+            .map(move |id| MInsn { mc, id })
+            .filter(|insn| insn.parent().is_none())
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct MInsn<'m> {
+    mc: &'m Microcode,
+    id: MInsnId,
+}
+
+impl<'m> MInsn<'m> {
+    fn raw(&self) -> &'m minsn_node_t {
+        &self.mc.raw.insns[self.id]
+    }
+
+    pub fn id(&self) -> MInsnId {
+        self.id
+    }
+
+    /// The instruction's `mcode_t` opcode (`m_*`).
+    pub fn opcode(&self) -> u16 {
+        self.raw().opcode
+    }
+
+    pub fn address(&self) -> Option<Address> {
+        let ea = self.raw().ea;
+        (ea != u64::from(BADADDR)).then_some(ea)
+    }
+
+    pub fn block(&self) -> MBlockId {
+        self.raw().block as _
+    }
+
+    /// For a nested instruction, the instruction whose operand holds it.
+    pub fn parent(&self) -> Option<MInsnId> {
+        Microcode::index(self.raw().parent)
+    }
+
+    pub fn left(&self) -> Option<MOperand<'m>> {
+        self.operand(self.raw().l)
+    }
+
+    pub fn right(&self) -> Option<MOperand<'m>> {
+        self.operand(self.raw().r)
+    }
+
+    pub fn dest(&self) -> Option<MOperand<'m>> {
+        self.operand(self.raw().d)
+    }
+
+    fn operand(&self, id: i32) -> Option<MOperand<'m>> {
+        Microcode::index(id).map(|id| MOperand { mc: self.mc, id })
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct MOperand<'m> {
+    mc: &'m Microcode,
+    id: MOperandId,
+}
+
+impl<'m> MOperand<'m> {
+    fn raw(&self) -> &'m mop_node_t {
+        &self.mc.raw.operands[self.id]
+    }
+
+    pub fn id(&self) -> MOperandId {
+        self.id
+    }
+
+    pub fn kind(&self) -> MOperandKind {
+        MOperandKind::from_raw(self.raw().kind)
+    }
+
+    /// Size in bytes, if known.
+    pub fn size(&self) -> Option<usize> {
+        let size = self.raw().size;
+        (size > 0).then_some(size as usize)
+    }
+
+    /// Kind-specific value: the micro register for `Register`, the constant
+    /// for `Number`, the address for `Global`, the stack offset for `Stack`,
+    /// the variable index for `LocalVar`, the block for `Block` and the
+    /// callee for `Call`; zero otherwise.
+    pub fn value(&self) -> u64 {
+        self.raw().value
+    }
+
+    /// The instruction this operand belongs to.
+    pub fn insn(&self) -> MInsnId {
+        self.raw().insn as _
+    }
+
+    /// For an operand nested in another (the target of an `Address`, an
+    /// argument of a `Call`, or half of a `Pair`), the enclosing operand.
+    pub fn parent(&self) -> Option<MOperandId> {
+        Microcode::index(self.raw().parent)
+    }
+
+    /// For an `Insn` operand, the nested instruction computing it.
+    pub fn sub_insn(&self) -> Option<MInsn<'m>> {
+        Microcode::index(self.raw().sub_insn).map(|id| MInsn { mc: self.mc, id })
+    }
+}
@@ -5,12 +5,13 @@ use bitflags::bitflags;
 
 use crate::ffi::BADADDR;
 use crate::ffi::name::{
-    get_nlist_ea, get_nlist_idx, get_nlist_name, get_nlist_size, is_in_nlist, is_public_name,
-    is_weak_name,
+    get_nlist_ea, get_nlist_idx, get_nlist_name, get_nlist_size, idalib_get_name_table,
+    is_in_nlist, is_public_name, is_weak_name, name_table_t,
 };
 
 use crate::Address;
 use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
 
 pub type NameIndex = usize;
 
@@ -61,6 +62,8 @@ impl<'a> NameList<'a> {
 
     pub fn get_by_index(&self, index: NameIndex) -> Option<Name> {
         let addr = self.get_address_by_index(index)?;
+
+        let _ffi = instrument::scope(Subsystem::Bytes, "name_by_index");
         let name = unsafe { get_nlist_name(index) };
         if name.is_null() {
             return None;
@@ -87,11 +90,15 @@ impl<'a> NameList<'a> {
     }
 
     pub fn get_closest_by_address(&self, address: Address) -> Option<Name> {
-        let index = unsafe { get_nlist_idx(address.into()) };
+        let index = {
+            let _ffi = instrument::scope(Subsystem::Bytes, "name_closest_index");
+            unsafe { get_nlist_idx(address.into()) }
+        };
         self.get_by_index(index)
     }
 
     pub fn get_address_by_index(&self, index: NameIndex) -> Option<Address> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "name_address_by_index");
         let addr = unsafe { get_nlist_ea(index) };
         if addr == BADADDR {
             None
@@ -101,10 +108,12 @@ impl<'a> NameList<'a> {
     }
 
     pub fn has_name(&self, address: Address) -> bool {
+        let _ffi = instrument::scope(Subsystem::Bytes, "has_name");
         unsafe { is_in_nlist(address.into()) }
     }
 
     pub fn len(&self) -> usize {
+        let _ffi = instrument::scope(Subsystem::Bytes, "name_count");
         unsafe { get_nlist_size() }
     }
 
@@ -118,6 +127,16 @@ impl<'a> NameList<'a> {
             current_index: 0,
         }
     }
+
+    /// Copy the whole name list in one call into a `NameListSnapshot`, which
+    /// answers lookups without going back to the kernel.
+    pub fn snapshot(&self) -> NameListSnapshot {
+        let _ffi = instrument::scope(Subsystem::Bytes, "name_table");
+        let mut raw = name_table_t::default();
+        unsafe { idalib_get_name_table(&mut raw) };
+
+        NameListSnapshot::new(raw)
+    }
 }
 
 pub struct NameListIter<'s, 'a> {
@@ -141,3 +160,187 @@ impl<'s, 'a> Iterator for NameListIter<'s, 'a> {
         None
     }
 }
+
+/// All names in the database, packed into a single string arena and indexed
+/// by address.
+///
+/// Nearest-name lookups search an Eytzinger (breadth-first) copy of the
+/// sorted addresses, which keeps the hot top levels of the search together
+/// in cache when resolving many addresses.
+#[derive(Debug, Clone)]
+pub struct NameListSnapshot {
+    addresses: Vec<Address>,
+    offsets: Vec<u32>,
+    properties: Vec<NameProperties>,
+    arena: String,
+    // 1-based Eytzinger layout of `addresses`, with the sorted index of each
+    // slot; slot 0 is unused
+    layout: Vec<Address>,
+    layout_index: Vec<u32>,
+}
+
+impl NameListSnapshot {
+    fn new(raw: name_table_t) -> Self {
+        let name_table_t {
+            eas,
+            offsets,
+            flags,
+            arena,
+        } = raw;
+
+        let mut order = (0..eas.len()).collect::<Vec<_>>();
+        if !eas.is_sorted() {
+            order.sort_by_key(|i| eas[*i]);
+        }
+
+        // NOTE: names are normally UTF-8, so this only copies in the rare
+        // case where one is not
+        let bytes = |i: usize| &arena[offsets[i] as usize..offsets[i + 1] as usize];
+        let mut packed = String::with_capacity(arena.len());
+        let mut packed_offsets = Vec::with_capacity(offsets.len());
+        packed_offsets.push(0);
+
+        for i in &order {
+            packed.push_str(&String::from_utf8_lossy(bytes(*i)));
+            packed_offsets.push(packed.len() as u32);
+        }
+
+        let addresses = order.iter().map(|i| eas[*i]).collect::<Vec<_>>();
+        let properties = order
+            .iter()
+            .map(|i| NameProperties::from_bits_truncate(flags[*i]))
+            .collect();
+
+        let mut layout = vec![0; addresses.len() + 1];
+        let mut layout_index = vec![0; addresses.len() + 1];
+        eytzinger(&addresses, &mut layout, &mut layout_index, &mut 0, 1);
+
+        Self {
+            addresses,
+            offsets: packed_offsets,
+            properties,
+            arena: packed,
+            layout,
+            layout_index,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.addresses.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.addresses.is_empty()
+    }
+
+    /// Name addresses, in ascending order.
+    pub fn addresses(&self) -> &[Address] {
+        &self.addresses
+    }
+
+    pub fn get(&self, index: usize) -> Option<NameEntry<'_>> {
+        (index < self.len()).then(|| self.entry(index))
+    }
+
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = NameEntry<'_>> + '_ {
+        (0..self.len()).map(|i| self.entry(i))
+    }
+
+    /// The name at exactly `address`.
+    pub fn get_by_address(&self, address: Address) -> Option<NameEntry<'_>> {
+        self.closest_index(address)
+            .filter(|i| self.addresses[*i] == address)
+            .map(|i| self.entry(i))
+    }
+
+    /// The name at the highest address not above `address`.
+    pub fn closest(&self, address: Address) -> Option<NameEntry<'_>> {
+        self.closest_index(address).map(|i| self.entry(i))
+    }
+
+    /// The closest name at or below `address` and the offset of `address`
+    /// from it, e.g., to render `name+0x10`.
+    pub fn symbolize(&self, address: Address) -> Option<(NameEntry<'_>, u64)> {
+        let entry = self.closest(address)?;
+        Some((entry, address - entry.address))
+    }
+
+    /// Index of the closest name at or below `address`.
+    pub fn closest_index(&self, address: Address) -> Option<usize> {
+        let n = self.addresses.len();
+
+        // find the slot of the first address above `address`
+        let mut k = 1;
+        while k <= n {
+            k = 2 * k + (self.layout[k] <= address) as usize;
+        }
+        k >>= k.trailing_ones() + 1;
+
+        let upper = if k == 0 {
+            n
+        } else {
+            self.layout_index[k] as usize
+        };
+
+        upper.checked_sub(1)
+    }
+
+    fn entry(&self, index: usize) -> NameEntry<'_> {
+        let name = &self.arena[self.offsets[index] as usize..self.offsets[index + 1] as usize];
+
+        NameEntry {
+            address: self.addresses[index],
+            name,
+            index,
+            properties: self.properties[index],
+        }
+    }
+}
+
+fn eytzinger(
+    sorted: &[Address],
+    layout: &mut [Address],
+    layout_index: &mut [u32],
+    next: &mut usize,
+    k: usize,
+) {
+    if k < layout.len() {
+        eytzinger(sorted, layout, layout_index, next, 2 * k);
+        layout[k] = sorted[*next];
+        layout_index[k] = *next as u32;
+        *next += 1;
+        eytzinger(sorted, layout, layout_index, next, 2 * k + 1);
+    }
+}
+
+/// A name borrowed from a `NameListSnapshot`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct NameEntry<'s> {
+    address: Address,
+    name: &'s str,
+    index: usize,
+    properties: NameProperties,
+}
+
+impl<'s> NameEntry<'s> {
+    pub fn address(&self) -> Address {
+        self.address
+    }
+
+    pub fn name(&self) -> &'s str {
+        self.name
+    }
+
+    /// Position of the name in the snapshot.
+    pub fn index(&self) -> usize {
+        self.index
+    }
+
+    pub fn is_public(&self) -> bool {
+        self.properties.contains(NameProperties::PUBLIC)
+    }
+
+    pub fn is_weak(&self) -> bool {
+        self.properties.contains(NameProperties::WEAK)
+    }
+}
@@ -0,0 +1,525 @@
+//! A pool of worker processes, each with its own IDA runtime.
+//!
+//! The IDA kernel can only have one database open per process and is not
+//! thread-safe, so all access within a process is serialised (see
+//! `prepare_library`). To use more than one core, `WorkerPool` runs jobs in
+//! separate processes and keeps them alive between jobs so that each sample
+//! only pays for opening its database, not for initialising IDA.
+//!
+//! Workers are normally the same executable as the supervisor, started with
+//! `WORKER_ENV` set; the program must call `run_worker` early in `main`:
+//!
+//! ```ignore
+//! fn main() -> anyhow::Result<()> {
+//!     if idalib::pool::is_worker() {
+//!         return Ok(idalib::pool::run_worker(|idb, _query| {
+//!             Ok(idb.function_count().to_le_bytes().to_vec())
+//!         })?);
+//!     }
+//!
+//!     let mut pool = idalib::pool::WorkerPool::spawn(8)?;
+//!     for result in pool.run(jobs) {
+//!         // ...
+//!     }
+//!     Ok(())
+//! }
+//! ```
+//!
+//! Requests and responses are exchanged over the workers' stdin and stdout.
+//! Each frame starts with a marker, so any stray output a worker writes to
+//! stdout is skipped rather than corrupting the stream. Payloads are limited
+//! to 256 MiB; a longer frame is an error, failing the job.
+
+use std::collections::VecDeque;
+use std::env;
+use std::ffi::OsString;
+use std::io::{self, BufRead, BufReader, Write};
+use std::path::{Path, PathBuf};
+use std::process::{Child, ChildStdin, ChildStdout, Command, Stdio};
+use std::sync::{Mutex, mpsc};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use crate::idb::{IDB, IDBOpenOptions};
+use crate::{IDAError, enable_console_messages};
+
+/// Environment variable set for worker processes.
+pub const WORKER_ENV: &str = "IDALIB_POOL_WORKER";
+
+const FRAME_MAGIC: &[u8; 8] = b"\0IDALIBP";
+
+// Largest payload a frame may carry; a length beyond it is taken to be a
+// corrupt header rather than allocated
+const MAX_FRAME_LEN: usize = 256 << 20;
+
+const REQUEST_RUN: u8 = 1;
+const REQUEST_EXIT: u8 = 2;
+
+const RESPONSE_OK: u8 = 1;
+const RESPONSE_ERR: u8 = 2;
+
+/// True if this process was started as a pool worker.
+pub fn is_worker() -> bool {
+    env::var_os(WORKER_ENV).is_some()
+}
+
+/// Serves jobs from the supervisor until it closes the pool.
+///
+/// For each job the worker opens the database, passes it and the job's
+/// query to `handler`, returns the handler's output and closes the database
+/// again; the IDA runtime itself stays initialised across jobs.
+pub fn run_worker<F>(mut handler: F) -> Result<(), IDAError>
+where
+    F: FnMut(&mut IDB, &[u8]) -> Result<Vec<u8>, String>,
+{
+    // NOTE: stdout carries responses, so keep the kernel's messages off it
+    enable_console_messages(false);
+
+    let mut input = BufReader::new(io::stdin().lock());
+    let mut output = io::stdout().lock();
+
+    loop {
+        let (tag, payload) = match read_frame(&mut input) {
+            Ok(frame) => frame,
+            Err(e) if e.kind() == io::ErrorKind::UnexpectedEof => return Ok(()),
+            Err(e) => return Err(IDAError::ffi(e)),
+        };
+
+        match tag {
+            REQUEST_RUN => {
+                let response = match decode_job(&payload) {
+                    Some((path, auto_analyse, query)) => {
+                        run_job(&path, auto_analyse, query, &mut handler)
+                    }
+                    None => Err("malformed job request".to_owned()),
+                };
+
+                let written = match response {
+                    Ok(out) if out.len() > MAX_FRAME_LEN => write_frame(
+                        &mut output,
+                        RESPONSE_ERR,
+                        format!("response of {} bytes exceeds the frame limit", out.len())
+                            .as_bytes(),
+                    ),
+                    Ok(out) => write_frame(&mut output, RESPONSE_OK, &out),
+                    Err(e) => write_frame(&mut output, RESPONSE_ERR, e.as_bytes()),
+                };
+                written.map_err(IDAError::ffi)?;
+            }
+            REQUEST_EXIT => return Ok(()),
+            _ => {
+                write_frame(&mut output, RESPONSE_ERR, b"unknown request")
+                    .map_err(IDAError::ffi)?;
+            }
+        }
+    }
+}
+
+fn run_job<F>(
+    path: &Path,
+    auto_analyse: bool,
+    query: &[u8],
+    handler: &mut F,
+) -> Result<Vec<u8>, String>
+where
+    F: FnMut(&mut IDB, &[u8]) -> Result<Vec<u8>, String>,
+{
+    let mut idb = IDBOpenOptions::new()
+        .auto_analyse(auto_analyse)
+        .open(path)
+        .map_err(|e| e.to_string())?;
+
+    handler(&mut idb, query)
+}
+
+/// A unit of work: open `path`, run `query` against it, close it.
+#[derive(Debug, Clone)]
+pub struct Job {
+    pub path: PathBuf,
+    pub auto_analyse: bool,
+    pub query: Vec<u8>,
+}
+
+impl Job {
+    pub fn new(path: impl AsRef<Path>, query: impl Into<Vec<u8>>) -> Self {
+        Self {
+            path: path.as_ref().to_owned(),
+            auto_analyse: true,
+            query: query.into(),
+        }
+    }
+
+    pub fn auto_analyse(mut self, auto_analyse: bool) -> Self {
+        self.auto_analyse = auto_analyse;
+        self
+    }
+}
+
+#[derive(Debug)]
+pub struct JobResult {
+    /// Index of the job in the submitted list
+    pub job: usize,
+    pub worker: usize,
+    pub result: Result<Vec<u8>, String>,
+    pub elapsed: Duration,
+}
+
+#[derive(Debug, Clone)]
+pub struct WorkerStats {
+    jobs: usize,
+    failures: usize,
+    restarts: usize,
+    busy: Duration,
+    started: Instant,
+}
+
+impl WorkerStats {
+    fn new() -> Self {
+        Self {
+            jobs: 0,
+            failures: 0,
+            restarts: 0,
+            busy: Duration::ZERO,
+            started: Instant::now(),
+        }
+    }
+
+    pub fn jobs(&self) -> usize {
+        self.jobs
+    }
+
+    pub fn failures(&self) -> usize {
+        self.failures
+    }
+
+    /// Number of times the worker process died and was replaced.
+    pub fn restarts(&self) -> usize {
+        self.restarts
+    }
+
+    /// Time spent running jobs.
+    pub fn busy(&self) -> Duration {
+        self.busy
+    }
+
+    pub fn uptime(&self) -> Duration {
+        self.started.elapsed()
+    }
+
+    /// Jobs completed per second of uptime.
+    pub fn throughput(&self) -> f64 {
+        let secs = self.uptime().as_secs_f64();
+        if secs > 0.0 {
+            self.jobs as f64 / secs
+        } else {
+            0.0
+        }
+    }
+}
+
+struct Worker {
+    child: Child,
+    stdin: ChildStdin,
+    stdout: BufReader<ChildStdout>,
+    stats: WorkerStats,
+}
+
+impl Worker {
+    fn spawn(program: &Path, args: &[OsString]) -> io::Result<Self> {
+        let mut child = Command::new(program)
+            .args(args)
+            .env(WORKER_ENV, "1")
+            .stdin(Stdio::piped())
+            .stdout(Stdio::piped())
+            .stderr(Stdio::inherit())
+            .spawn()?;
+
+        let stdin = child.stdin.take().expect("piped stdin");
+        let stdout = BufReader::new(child.stdout.take().expect("piped stdout"));
+
+        Ok(Self {
+            child,
+            stdin,
+            stdout,
+            stats: WorkerStats::new(),
+        })
+    }
+
+    fn run(&mut self, job: &Job) -> io::Result<Result<Vec<u8>, String>> {
+        write_frame(&mut self.stdin, REQUEST_RUN, &encode_job(job)?)?;
+
+        let (tag, payload) = read_frame(&mut self.stdout)?;
+        match tag {
+            RESPONSE_OK => Ok(Ok(payload)),
+            RESPONSE_ERR => Ok(Err(String::from_utf8_lossy(&payload).into_owned())),
+            _ => Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                "unknown response from worker",
+            )),
+        }
+    }
+
+    fn exit(mut self) {
+        let _ = write_frame(&mut self.stdin, REQUEST_EXIT, &[]);
+        drop(self.stdin);
+        let _ = self.child.wait();
+    }
+}
+
+/// Supervises a set of worker processes; see the module documentation.
+pub struct WorkerPool {
+    program: PathBuf,
+    args: Vec<OsString>,
+    workers: Vec<Worker>,
+}
+
+impl WorkerPool {
+    /// Starts `workers` copies of the current executable as workers.
+    pub fn spawn(workers: usize) -> Result<Self, IDAError> {
+        let program = env::current_exe().map_err(IDAError::ffi)?;
+        Self::spawn_with(program, Vec::<OsString>::new(), workers)
+    }
+
+    /// Starts `workers` instances of `program` (with `args`) as workers.
+    pub fn spawn_with(
+        program: impl AsRef<Path>,
+        args: impl IntoIterator<Item = impl Into<OsString>>,
+        workers: usize,
+    ) -> Result<Self, IDAError> {
+        let program = program.as_ref().to_owned();
+        let args = args.into_iter().map(Into::into).collect::<Vec<_>>();
+
+        let workers = (0..workers.max(1))
+            .map(|_| Worker::spawn(&program, &args))
+            .collect::<io::Result<Vec<_>>>()
+            .map_err(IDAError::ffi)?;
+
+        Ok(Self {
+            program,
+            args,
+            workers,
+        })
+    }
+
+    pub fn len(&self) -> usize {
+        self.workers.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.workers.is_empty()
+    }
+
+    pub fn stats(&self) -> Vec<WorkerStats> {
+        self.workers.iter().map(|w| w.stats.clone()).collect()
+    }
+
+    /// Runs all `jobs`, returning their results ordered by job index.
+    pub fn run(&mut self, jobs: impl IntoIterator<Item = Job>) -> Vec<JobResult> {
+        let mut results = Vec::new();
+        self.run_with(jobs, |result| results.push(result));
+        results.sort_by_key(|result| result.job);
+        results
+    }
+
+    /// Runs all `jobs`, passing each result to `on_result` as soon as it
+    /// arrives (in completion order).
+    pub fn run_with<F>(&mut self, jobs: impl IntoIterator<Item = Job>, mut on_result: F)
+    where
+        F: FnMut(JobResult),
+    {
+        let queue = Mutex::new(jobs.into_iter().enumerate().collect::<VecDeque<_>>());
+        let (tx, rx) = mpsc::channel();
+
+        let program = &self.program;
+        let args = &self.args;
+
+        // Each worker thread returns whether it gave up on a dead worker
+        let dead = thread::scope(|s| {
+            let threads = self
+                .workers
+                .iter_mut()
+                .enumerate()
+                .map(|(index, worker)| {
+                    let queue = &queue;
+                    let tx = tx.clone();
+
+                    s.spawn(move || {
+                        loop {
+                            let Some((job_index, job)) = queue.lock().unwrap().pop_front() else {
+                                return false;
+                            };
+
+                            let start = Instant::now();
+                            let result = match worker.run(&job) {
+                                Ok(result) => result,
+                                Err(e) => {
+                                    // The worker died or desynchronised; replace it
+                                    let restarts = worker.stats.restarts + 1;
+                                    let stats = worker.stats.clone();
+
+                                    match Worker::spawn(program, args) {
+                                        Ok(fresh) => {
+                                            let _ = worker.child.kill();
+                                            let _ = worker.child.wait();
+                                            *worker = fresh;
+                                            worker.stats = WorkerStats { restarts, ..stats };
+                                        }
+                                        Err(_) => {
+                                            let elapsed = start.elapsed();
+
+                                            worker.stats.jobs += 1;
+                                            worker.stats.failures += 1;
+                                            worker.stats.busy += elapsed;
+
+                                            let _ = tx.send(JobResult {
+                                                job: job_index,
+                                                worker: index,
+                                                result: Err(format!("worker failed: {e}")),
+                                                elapsed,
+                                            });
+                                            return true;
+                                        }
+                                    }
+
+                                    Err(format!("worker failed: {e}"))
+                                }
+                            };
+                            let elapsed = start.elapsed();
+
+                            worker.stats.jobs += 1;
+                            worker.stats.busy += elapsed;
+                            if result.is_err() {
+                                worker.stats.failures += 1;
+                            }
+
+                            if tx
+                                .send(JobResult {
+                                    job: job_index,
+                                    worker: index,
+                                    result,
+                                    elapsed,
+                                })
+                                .is_err()
+                            {
+                                return false;
+                            }
+                        }
+                    })
+                })
+                .collect::<Vec<_>>();
+
+            drop(tx);
+
+            for result in &rx {
+                on_result(result);
+            }
+
+            threads
+                .into_iter()
+                .enumerate()
+                .filter(|(_, thread)| thread.join().unwrap_or(true))
+                .map(|(index, _)| index)
+                .collect::<Vec<_>>()
+        });
+
+        // If every worker died and could not be replaced, jobs may be left
+        // over; fail them rather than drop them, charging each to one of the
+        // dead workers
+        let leftover = queue.into_inner().unwrap_or_else(|e| e.into_inner());
+        for ((job, _), index) in leftover.into_iter().zip(dead.iter().cycle()) {
+            self.workers[*index].stats.jobs += 1;
+            self.workers[*index].stats.failures += 1;
+
+            on_result(JobResult {
+                job,
+                worker: *index,
+                result: Err("no live workers".to_owned()),
+                elapsed: Duration::ZERO,
+            });
+        }
+    }
+}
+
+impl Drop for WorkerPool {
+    fn drop(&mut self) {
+        for worker in self.workers.drain(..) {
+            worker.exit();
+        }
+    }
+}
+
+fn encode_job(job: &Job) -> io::Result<Vec<u8>> {
+    let path = job.path.to_str().ok_or_else(|| {
+        io::Error::new(
+            io::ErrorKind::InvalidInput,
+            format!("path is not valid UTF-8: {}", job.path.display()),
+        )
+    })?;
+
+    let mut out = Vec::with_capacity(4 + path.len() + 1 + job.query.len());
+    out.extend_from_slice(&(path.len() as u32).to_le_bytes());
+    out.extend_from_slice(path.as_bytes());
+    out.push(job.auto_analyse as u8);
+    out.extend_from_slice(&job.query);
+
+    Ok(out)
+}
+
+fn decode_job(payload: &[u8]) -> Option<(PathBuf, bool, &[u8])> {
+    let len = u32::from_le_bytes(payload.get(..4)?.try_into().ok()?) as usize;
+    let path = std::str::from_utf8(payload.get(4..4 + len)?).ok()?;
+    let auto_analyse = *payload.get(4 + len)? != 0;
+    let query = payload.get(4 + len + 1..)?;
+
+    Some((PathBuf::from(path), auto_analyse, query))
+}
+
+fn write_frame(out: &mut impl Write, tag: u8, payload: &[u8]) -> io::Result<()> {
+    if payload.len() > MAX_FRAME_LEN {
+        return Err(io::Error::new(
+            io::ErrorKind::InvalidInput,
+            format!("frame of {} bytes exceeds the limit", payload.len()),
+        ));
+    }
+
+    let mut frame = Vec::with_capacity(FRAME_MAGIC.len() + 5 + payload.len());
+    frame.extend_from_slice(FRAME_MAGIC);
+    frame.push(tag);
+    frame.extend_from_slice(&(payload.len() as u32).to_le_bytes());
+    frame.extend_from_slice(payload);
+
+    out.write_all(&frame)?;
+    out.flush()
+}
+
+fn read_frame(input: &mut impl BufRead) -> io::Result<(u8, Vec<u8>)> {
+    // Skip anything up to the next frame marker; the marker's first byte
+    // does not reoccur in it, so a mismatch can simply restart the match
+    let mut matched = 0;
+    while matched < FRAME_MAGIC.len() {
+        let mut byte = [0u8];
+        input.read_exact(&mut byte)?;
+
+        if byte[0] == FRAME_MAGIC[matched] {
+            matched += 1;
+        } else {
+            matched = (byte[0] == FRAME_MAGIC[0]) as usize;
+        }
+    }
+
+    let mut header = [0u8; 5];
+    input.read_exact(&mut header)?;
+
+    let len = u32::from_le_bytes(header[1..].try_into().expect("4 bytes")) as usize;
+    if len > MAX_FRAME_LEN {
+        return Err(io::Error::new(
+            io::ErrorKind::InvalidData,
+            format!("frame of {len} bytes exceeds the limit"),
+        ));
+    }
+
+    let mut payload = vec![0u8; len];
+    input.read_exact(&mut payload)?;
+
+    Ok((header[0], payload))
+}
@@ -1,7 +1,10 @@
 use std::marker::PhantomData;
 
+use autocxx::c_int;
+
 use crate::ffi::processor::*;
 use crate::idb::IDB;
+use crate::insn::Register;
 use crate::Address;
 
 pub use crate::ffi::processor::ids as id;
@@ -349,4 +352,131 @@ impl<'a> Processor<'a> {
     pub fn is_thumb_at(&self, ea: Address) -> bool {
         unsafe { idalib_is_thumb_at(self.ptr, ea.into()) }
     }
+
+    /// Every range of segment register `reg` in one call, or `None` if
+    /// `reg` is not a segment register of this processor.
+    pub fn sreg_ranges(&self, reg: Register) -> Option<SRegRanges> {
+        let mut raw = sreg_ranges_t::default();
+        let found = unsafe { idalib_get_sreg_ranges(self.ptr, c_int(reg as _), &mut raw) };
+
+        found.then_some(SRegRanges { reg, raw })
+    }
+
+    /// The ranges of the ARM `T` (Thumb mode) register; `None` unless this
+    /// is a 32-bit ARM database.
+    pub fn thumb_ranges(&self) -> Option<SRegRanges> {
+        let reg = unsafe { idalib_arm_t_register() };
+        self.sreg_ranges(reg as Register)
+            .filter(|ranges| ranges.raw.thumb)
+    }
+}
+
+/// How a segment register range got its value (`SR_*`).
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum SRegTag {
+    /// Inherited from the previous range
+    Inherit,
+    /// Set by the user
+    User,
+    /// Set by the processor module
+    Auto,
+    /// As `Auto`, at the start of a segment
+    AutoStart,
+    Other(u8),
+}
+
+impl SRegTag {
+    fn from_raw(raw: u8) -> Self {
+        match raw {
+            1 => Self::Inherit,
+            2 => Self::User,
+            3 => Self::Auto,
+            4 => Self::AutoStart,
+            other => Self::Other(other),
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct SRegRange {
+    pub start: Address,
+    pub end: Address,
+    /// `None` if the value is unknown (`BADSEL`)
+    pub value: Option<u64>,
+    pub tag: SRegTag,
+}
+
+/// Snapshot of every range of one segment register, sorted by address, so
+/// that the value at an address is a binary search rather than a call to
+/// `get_sreg`.
+#[derive(Debug, Clone)]
+pub struct SRegRanges {
+    reg: Register,
+    raw: sreg_ranges_t,
+}
+
+impl SRegRanges {
+    pub fn register(&self) -> Register {
+        self.reg
+    }
+
+    pub fn len(&self) -> usize {
+        self.raw.starts.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.raw.starts.is_empty()
+    }
+
+    pub fn starts(&self) -> &[Address] {
+        &self.raw.starts
+    }
+
+    pub fn ends(&self) -> &[Address] {
+        &self.raw.ends
+    }
+
+    /// Raw values, `u64::MAX` (`BADSEL`) where unknown.
+    pub fn values(&self) -> &[u64] {
+        &self.raw.values
+    }
+
+    pub fn get(&self, index: usize) -> Option<SRegRange> {
+        Some(SRegRange {
+            start: *self.raw.starts.get(index)?,
+            end: self.raw.ends[index],
+            value: Self::value(self.raw.values[index]),
+            tag: SRegTag::from_raw(self.raw.tags[index]),
+        })
+    }
+
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = SRegRange> + '_ {
+        (0..self.len()).map(|i| self.get(i).expect("index in bounds"))
+    }
+
+    /// The range containing `ea`.
+    pub fn range_at(&self, ea: Address) -> Option<SRegRange> {
+        let i = self.raw.starts.partition_point(|start| *start <= ea);
+        if i == 0 || ea >= self.raw.ends[i - 1] {
+            return None;
+        }
+        self.get(i - 1)
+    }
+
+    /// The register's value at `ea`, as `get_sreg` would return it (but
+    /// `None` rather than `BADSEL`).
+    pub fn value_at(&self, ea: Address) -> Option<u64> {
+        self.range_at(ea)?.value
+    }
+
+    /// For the ARM `T` register (see `Processor::thumb_ranges`), whether
+    /// `ea` is in Thumb mode; matches `Processor::is_thumb_at`, and so is
+    /// false for any other register or database.
+    pub fn is_thumb_at(&self, ea: Address) -> bool {
+        self.raw.thumb && self.value_at(ea).is_some_and(|v| v != 0)
+    }
+
+    fn value(raw: u64) -> Option<u64> {
+        (raw != u64::MAX).then_some(raw)
+    }
 }
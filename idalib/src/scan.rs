@@ -0,0 +1,322 @@
+use std::num::NonZeroUsize;
+use std::thread;
+
+use crate::bytes::ByteMask;
+use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
+use crate::{Address, IDAError};
+
+/// A byte signature where each byte is compared under a mask, e.g.
+/// `48 8b ?? 05 ?0` (`?` matches any nibble).
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct BytePattern {
+    bytes: Vec<u8>,
+    mask: Vec<u8>,
+    anchor: usize,
+}
+
+impl BytePattern {
+    pub fn new(bytes: impl Into<Vec<u8>>, mask: impl Into<Vec<u8>>) -> Result<Self, IDAError> {
+        let mask = mask.into();
+        let mut bytes = bytes.into();
+
+        if bytes.len() != mask.len() {
+            return Err(IDAError::ffi_with(format!(
+                "pattern has {} bytes but {} mask bytes",
+                bytes.len(),
+                mask.len()
+            )));
+        }
+
+        for (b, m) in bytes.iter_mut().zip(mask.iter()) {
+            *b &= *m;
+        }
+
+        // NOTE: the anchor is the byte used to dispatch candidates while
+        // scanning; prefer a fully-literal byte that is not padding, as those
+        // occur far more often than anything else in an image.
+        let literal = |(_, (_, m)): &(usize, (&u8, &u8))| **m == 0xff;
+        let anchor = bytes
+            .iter()
+            .zip(mask.iter())
+            .enumerate()
+            .filter(literal)
+            .find(|(_, (b, _))| !matches!(**b, 0x00 | 0xcc | 0x90 | 0xff))
+            .or_else(|| bytes.iter().zip(mask.iter()).enumerate().find(literal))
+            .map(|(i, _)| i)
+            .ok_or_else(|| IDAError::ffi_with("pattern has no fully-literal byte"))?;
+
+        Ok(Self {
+            bytes,
+            mask,
+            anchor,
+        })
+    }
+
+    pub fn literal(bytes: impl Into<Vec<u8>>) -> Result<Self, IDAError> {
+        let bytes = bytes.into();
+        let mask = vec![0xff; bytes.len()];
+        Self::new(bytes, mask)
+    }
+
+    /// Parses a whitespace-separated hex signature; `?` or `??` is a
+    /// wildcard byte and `?` in a single nibble position matches that nibble.
+    pub fn parse(pattern: impl AsRef<str>) -> Result<Self, IDAError> {
+        let pattern = pattern.as_ref();
+
+        let mut bytes = Vec::new();
+        let mut mask = Vec::new();
+
+        for token in pattern.split_whitespace() {
+            let token = if token == "?" { "??" } else { token };
+            let digits = token.as_bytes();
+
+            if digits.len() != 2 {
+                return Err(IDAError::ffi_with(format!(
+                    "invalid pattern byte `{token}` in `{pattern}`"
+                )));
+            }
+
+            let mut b = 0u8;
+            let mut m = 0u8;
+
+            for d in digits {
+                b <<= 4;
+                m <<= 4;
+
+                if *d != b'?' {
+                    let v = (*d as char).to_digit(16).ok_or_else(|| {
+                        IDAError::ffi_with(format!("invalid pattern byte `{token}` in `{pattern}`"))
+                    })?;
+                    b |= v as u8;
+                    m |= 0xf;
+                }
+            }
+
+            bytes.push(b);
+            mask.push(m);
+        }
+
+        Self::new(bytes, mask)
+    }
+
+    pub fn bytes(&self) -> &[u8] {
+        &self.bytes
+    }
+
+    pub fn mask(&self) -> &[u8] {
+        &self.mask
+    }
+
+    pub fn len(&self) -> usize {
+        self.bytes.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.bytes.is_empty()
+    }
+
+    fn matches(&self, data: &[u8], valid: &ByteMask, start: usize) -> bool {
+        let Some(window) = data.get(start..start + self.bytes.len()) else {
+            return false;
+        };
+
+        window
+            .iter()
+            .zip(self.bytes.iter().zip(self.mask.iter()))
+            .enumerate()
+            .all(|(i, (d, (b, m)))| *m == 0 || (*d & *m == *b && valid.is_loaded(start + i)))
+    }
+}
+
+/// A set of patterns matched together in a single pass over the data.
+///
+/// Patterns are bucketed by the value of their anchor byte, so each scanned
+/// byte only considers the patterns that could start a match there.
+#[derive(Debug, Clone)]
+pub struct PatternSet {
+    patterns: Vec<BytePattern>,
+    buckets: Vec<Vec<usize>>,
+    present: [bool; 256],
+    max_len: usize,
+}
+
+impl Default for PatternSet {
+    fn default() -> Self {
+        Self {
+            patterns: Vec::new(),
+            buckets: vec![Vec::new(); 256],
+            present: [false; 256],
+            max_len: 0,
+        }
+    }
+}
+
+impl PatternSet {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Adds a pattern, returning its index (as reported in `ScanHit`).
+    pub fn add(&mut self, pattern: BytePattern) -> usize {
+        let index = self.patterns.len();
+        let anchor = pattern.bytes[pattern.anchor] as usize;
+
+        self.buckets[anchor].push(index);
+        self.present[anchor] = true;
+        self.max_len = self.max_len.max(pattern.len());
+        self.patterns.push(pattern);
+
+        index
+    }
+
+    pub fn get(&self, index: usize) -> Option<&BytePattern> {
+        self.patterns.get(index)
+    }
+
+    pub fn len(&self) -> usize {
+        self.patterns.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.patterns.is_empty()
+    }
+
+    /// Finds every match starting in `data[from..to]`; `data` may extend past
+    /// `to` so matches straddling the end of the window are still found.
+    fn scan_window(
+        &self,
+        base: Address,
+        data: &[u8],
+        valid: &ByteMask,
+        from: usize,
+        to: usize,
+        hits: &mut Vec<ScanHit>,
+    ) {
+        let limit = (to + self.max_len).min(data.len());
+
+        for (pos, byte) in data[..limit].iter().enumerate().skip(from) {
+            if !self.present[*byte as usize] {
+                continue;
+            }
+
+            for &index in &self.buckets[*byte as usize] {
+                let pattern = &self.patterns[index];
+
+                let Some(start) = pos.checked_sub(pattern.anchor) else {
+                    continue;
+                };
+
+                if start < from || start >= to {
+                    continue;
+                }
+
+                if pattern.matches(data, valid, start) {
+                    hits.push(ScanHit {
+                        pattern: index,
+                        address: base + start as Address,
+                    });
+                }
+            }
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct ScanHit {
+    pub address: Address,
+    pub pattern: usize,
+}
+
+/// A copy of a range of the database, taken once so it can be scanned from
+/// multiple threads without calling back into the kernel.
+#[derive(Debug, Clone)]
+pub struct ByteImage {
+    start: Address,
+    bytes: Vec<u8>,
+    mask: Vec<u8>,
+}
+
+impl ByteImage {
+    pub(crate) fn new(idb: &IDB, start: Address, end: Address) -> Result<Self, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "snapshot_bytes");
+        let size = end.saturating_sub(start) as usize;
+
+        let mut bytes = vec![0xffu8; size];
+        let mut mask = vec![0u8; ByteMask::len_for(size)];
+
+        idb.get_bytes_with_mask(start, &mut bytes, &mut mask)?;
+
+        Ok(Self { start, bytes, mask })
+    }
+
+    pub fn start_address(&self) -> Address {
+        self.start
+    }
+
+    pub fn end_address(&self) -> Address {
+        self.start + self.bytes.len() as Address
+    }
+
+    pub fn bytes(&self) -> &[u8] {
+        &self.bytes
+    }
+
+    pub fn mask(&self) -> ByteMask<'_> {
+        ByteMask::new(&self.mask, self.bytes.len())
+    }
+}
+
+/// Minimum number of bytes given to each worker thread.
+const SCAN_SPLIT_SIZE: usize = 1 << 20;
+
+/// Scans `images` for all patterns in `set`, splitting the work across up to
+/// `threads` worker threads. Hits are returned sorted by address.
+pub fn scan_images(set: &PatternSet, images: &[ByteImage], threads: NonZeroUsize) -> Vec<ScanHit> {
+    if set.is_empty() {
+        return Vec::new();
+    }
+
+    let mut windows = Vec::new();
+    for image in images {
+        let mut from = 0;
+        while from < image.bytes.len() {
+            let to = (from + SCAN_SPLIT_SIZE).min(image.bytes.len());
+            windows.push((image, from, to));
+            from = to;
+        }
+    }
+
+    let threads = threads.get().min(windows.len()).max(1);
+    let per_thread = windows.len().div_ceil(threads);
+
+    let mut hits = thread::scope(|s| {
+        let workers = windows
+            .chunks(per_thread.max(1))
+            .map(|windows| {
+                s.spawn(move || {
+                    let mut hits = Vec::new();
+                    for (image, from, to) in windows {
+                        set.scan_window(
+                            image.start,
+                            &image.bytes,
+                            &image.mask(),
+                            *from,
+                            *to,
+                            &mut hits,
+                        );
+                    }
+                    hits
+                })
+            })
+            .collect::<Vec<_>>();
+
+        workers
+            .into_iter()
+            .flat_map(|worker| worker.join().expect("scan worker panicked"))
+            .collect::<Vec<_>>()
+    });
+
+    hits.sort_unstable();
+    hits
+}
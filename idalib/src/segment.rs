@@ -5,9 +5,12 @@ use std::pin::Pin;
 use autocxx::moveit::Emplace;
 use bitflags::bitflags;
 
+use crate::bytes::ByteChunks;
+use crate::insn::{self, DecodeMode, InsnBatch};
 use crate::ffi::range_t;
 use crate::ffi::segment::*;
 use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
 use crate::Address;
 
 pub struct Segment<'a> {
@@ -245,6 +248,7 @@ impl<'a> Segment<'a> {
     }
 
     pub fn name(&self) -> Option<String> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "segment_name");
         let name = unsafe { idalib_segm_name(self.ptr) }.ok()?;
 
         if name.is_empty() {
@@ -264,6 +268,7 @@ impl<'a> Segment<'a> {
     }
 
     pub fn set_permissions(&mut self, permissions: SegmentPermissions) {
+        let _ffi = instrument::scope(Subsystem::Bytes, "set_segment_permissions");
         unsafe { idalib_segm_set_perm(self.ptr, permissions.bits()) };
     }
 
@@ -276,6 +281,7 @@ impl<'a> Segment<'a> {
     }
 
     pub fn bytes(&self) -> Vec<u8> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "segment_bytes");
         let size = self.len();
         let mut buf = Vec::with_capacity(size);
 
@@ -290,6 +296,18 @@ impl<'a> Segment<'a> {
         buf
     }
 
+    /// Streams the segment's contents in chunks of `chunk_size` bytes; see
+    /// `IDB::byte_chunks`.
+    pub fn byte_chunks(&self, chunk_size: usize) -> ByteChunks<'a> {
+        ByteChunks::new(self.start_address(), self.end_address(), chunk_size)
+    }
+
+    /// Decodes the segment's instructions into `batch`; see
+    /// `IDB::decode_range_into`.
+    pub fn decode_into(&self, mode: DecodeMode, batch: &mut InsnBatch) -> usize {
+        insn::decode_range_into(self.start_address(), self.end_address(), mode, batch)
+    }
+
     pub fn address_bits(&self) -> u32 {
         unsafe { (*self.ptr).abits().0 as _ }
     }
@@ -1,14 +1,17 @@
+use std::borrow::Cow;
 use std::marker::PhantomData;
 
 use crate::ffi::bytes::idalib_get_bytes;
 use crate::ffi::strings::{
-    build_strlist, clear_strlist, get_strlist_qty, idalib_get_strlist_item_addr,
-    idalib_get_strlist_item_length,
+    build_strlist, clear_strlist, get_strlist_qty, idalib_get_strlist_contents,
+    idalib_get_strlist_item_addr, idalib_get_strlist_item_length, idalib_get_strlist_items,
+    strlist_item_t,
 };
 use crate::ffi::BADADDR;
 
 use crate::idb::IDB;
-use crate::Address;
+use crate::instrument::{self, Subsystem};
+use crate::{Address, IDAError};
 
 pub type StringIndex = usize;
 
@@ -24,10 +27,12 @@ impl<'a> StringList<'a> {
     }
 
     pub fn rebuild(&self) {
+        let _ffi = instrument::scope(Subsystem::Bytes, "build_strlist");
         unsafe { build_strlist() }
     }
 
     pub fn clear(&self) {
+        let _ffi = instrument::scope(Subsystem::Bytes, "clear_strlist");
         unsafe { clear_strlist() }
     }
 
@@ -35,6 +40,8 @@ impl<'a> StringList<'a> {
         let addr = self.get_address_by_index(index)?;
         let size = self.get_length_by_index(index);
 
+        let _ffi = instrument::scope(Subsystem::Bytes, "string_contents");
+
         // See also `IDB::get_bytes`
         let mut buf = Vec::with_capacity(size);
         let Ok(new_len) = (unsafe { idalib_get_bytes(addr.into(), &mut buf) }) else {
@@ -49,6 +56,7 @@ impl<'a> StringList<'a> {
     }
 
     pub fn get_address_by_index(&self, index: StringIndex) -> Option<Address> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "string_address_by_index");
         let addr = unsafe { idalib_get_strlist_item_addr(index) };
         if addr == BADADDR {
             None
@@ -58,10 +66,12 @@ impl<'a> StringList<'a> {
     }
 
     fn get_length_by_index(&self, index: StringIndex) -> usize {
+        let _ffi = instrument::scope(Subsystem::Bytes, "string_length_by_index");
         unsafe { idalib_get_strlist_item_length(index) }
     }
 
     pub fn len(&self) -> usize {
+        let _ffi = instrument::scope(Subsystem::Bytes, "string_count");
         unsafe { get_strlist_qty() }
     }
 
@@ -75,6 +85,94 @@ impl<'a> StringList<'a> {
             current_index: 0,
         }
     }
+
+    /// Captures every item of the string list, with its contents, using two
+    /// FFI calls in total; the contents share a single contiguous buffer.
+    pub fn snapshot(&self) -> Result<StringListSnapshot, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Bytes, "string_snapshot");
+        let mut items = Vec::new();
+        let size = unsafe { idalib_get_strlist_items(&mut items) };
+
+        let mut arena = vec![0u8; size];
+        unsafe { idalib_get_strlist_contents(&mut items, &mut arena) }.map_err(IDAError::ffi)?;
+
+        Ok(StringListSnapshot { items, arena })
+    }
+}
+
+pub struct StringListSnapshot {
+    items: Vec<strlist_item_t>,
+    arena: Vec<u8>,
+}
+
+impl StringListSnapshot {
+    /// The `index`th readable string; items the kernel failed to return are
+    /// left out, so this need not be string list index `index` (see
+    /// `StringEntry::index`).
+    pub fn get(&self, index: usize) -> Option<StringEntry<'_>> {
+        self.items.get(index).map(|item| self.entry(item))
+    }
+
+    pub fn len(&self) -> usize {
+        self.items.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.items.is_empty()
+    }
+
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = StringEntry<'_>> + '_ {
+        self.items.iter().map(|item| self.entry(item))
+    }
+
+    fn entry<'s>(&'s self, item: &strlist_item_t) -> StringEntry<'s> {
+        StringEntry {
+            index: item.index,
+            address: item.ea,
+            strtype: item.strtype,
+            bytes: &self.arena[item.offset..item.offset + item.length],
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy)]
+pub struct StringEntry<'s> {
+    index: StringIndex,
+    address: Address,
+    strtype: i32,
+    bytes: &'s [u8],
+}
+
+impl<'s> StringEntry<'s> {
+    /// The entry's index in the kernel's string list, as taken by
+    /// `StringList::get_by_index`.
+    pub fn index(&self) -> StringIndex {
+        self.index
+    }
+
+    pub fn address(&self) -> Address {
+        self.address
+    }
+
+    pub fn strtype(&self) -> i32 {
+        self.strtype
+    }
+
+    pub fn bytes(&self) -> &'s [u8] {
+        self.bytes
+    }
+
+    pub fn len(&self) -> usize {
+        self.bytes.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.bytes.is_empty()
+    }
+
+    pub fn to_string_lossy(&self) -> Cow<'s, str> {
+        String::from_utf8_lossy(self.bytes)
+    }
 }
 
 pub struct StringListIter<'s, 'a> {
@@ -0,0 +1,165 @@
+//! A cache of analysed databases, keyed by the SHA-256 of their input file.
+//!
+//! Opening a sample through `IDBTemplateCache::open` analyses it as usual
+//! the first time, keeping a packed copy of the result. Later opens of an
+//! identical input start from a private copy of that database and skip
+//! loading and auto-analysis entirely.
+
+use std::fs::{self, File};
+use std::io::{self, Read};
+use std::path::{Path, PathBuf};
+use std::process;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::Instant;
+
+use sha2::{Digest, Sha256};
+
+use crate::IDAError;
+use crate::idb::{IDB, IDBOpenOptions, OpenProfile};
+
+/// How the template cache was used when opening a database.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum TemplateUse {
+    /// Opened from an existing template.
+    Hit,
+    /// Analysed from scratch and stored as a new template.
+    Created,
+}
+
+static WORKING_COPY: AtomicU64 = AtomicU64::new(0);
+
+#[derive(Debug, Clone)]
+pub struct IDBTemplateCache {
+    dir: PathBuf,
+    compress: bool,
+}
+
+impl IDBTemplateCache {
+    /// Use (and create if needed) `dir` to store templates.
+    pub fn new(dir: impl AsRef<Path>) -> Result<Self, IDAError> {
+        let dir = dir.as_ref().to_owned();
+        fs::create_dir_all(&dir).map_err(IDAError::ffi)?;
+
+        Ok(Self {
+            dir,
+            compress: true,
+        })
+    }
+
+    /// Whether new templates are stored compressed (the default).
+    pub fn compress(&mut self, compress: bool) -> &mut Self {
+        self.compress = compress;
+        self
+    }
+
+    pub fn dir(&self) -> &Path {
+        &self.dir
+    }
+
+    /// The key for `input`: the hex SHA-256 of its contents, which matches
+    /// `Metadata::input_file_sha256` once it is loaded.
+    pub fn key_for(input: impl AsRef<Path>) -> Result<String, IDAError> {
+        let digest = sha256_file(input.as_ref()).map_err(IDAError::ffi)?;
+        Ok(digest.iter().map(|b| format!("{b:02x}")).collect())
+    }
+
+    pub fn template_path(&self, key: impl AsRef<str>) -> PathBuf {
+        self.dir.join(format!("{}.i64", key.as_ref()))
+    }
+
+    pub fn contains(&self, input: impl AsRef<Path>) -> Result<bool, IDAError> {
+        Ok(self.template_path(Self::key_for(input)?).is_file())
+    }
+
+    /// Remove the template for `input`, if any.
+    pub fn remove(&self, input: impl AsRef<Path>) -> Result<bool, IDAError> {
+        match fs::remove_file(self.template_path(Self::key_for(input)?)) {
+            Ok(()) => Ok(true),
+            Err(e) if e.kind() == io::ErrorKind::NotFound => Ok(false),
+            Err(e) => Err(IDAError::ffi(e)),
+        }
+    }
+
+    /// Open `input` from its template if one exists; otherwise open and
+    /// auto-analyse it with `options` and store the result as its template.
+    ///
+    /// On a miss, the database is created where `options` would create it
+    /// (its `idb` path or `work_dir`, else next to `input`), and the template
+    /// is a copy of it. On a hit, the returned database is a private working
+    /// copy of the template (so several processes can share a cache), made in
+    /// `options`' `work_dir` if set and deleted on close; `options`' output
+    /// database path and auto-analysis setting are ignored.
+    pub fn open(
+        &self,
+        input: impl AsRef<Path>,
+        options: &IDBOpenOptions,
+    ) -> Result<(IDB, OpenProfile), IDAError> {
+        let start = Instant::now();
+
+        let input = input.as_ref();
+        if !input.is_file() {
+            return Err(IDAError::not_found(input));
+        }
+
+        let key = Self::key_for(input)?;
+        let template = self.template_path(&key);
+
+        let mut profile = OpenProfile::default();
+
+        let idb = if template.is_file() {
+            let working = working_path(options.work_dir_path().unwrap_or(&self.dir), &key);
+            fs::copy(&template, &working).map_err(IDAError::ffi)?;
+
+            let mut idb = match options.open_into(&working, None, false, &mut profile) {
+                Ok(idb) => idb,
+                Err(e) => {
+                    let _ = fs::remove_file(&working);
+                    return Err(e);
+                }
+            };
+            idb.remove_on_close(working);
+
+            profile.template = Some(TemplateUse::Hit);
+            idb
+        } else {
+            let output = options.output(input);
+            let idb = options.open_into(input, output.as_deref(), true, &mut profile)?;
+
+            // NOTE: write under a private name and rename, so concurrent
+            // creators never expose a partially written template
+            let working = working_path(&self.dir, &key);
+            idb.save_copy(&working, self.compress)?;
+            fs::rename(&working, &template).map_err(|e| {
+                let _ = fs::remove_file(&working);
+                IDAError::ffi(e)
+            })?;
+
+            profile.template = Some(TemplateUse::Created);
+            idb
+        };
+
+        profile.total = start.elapsed();
+        Ok((idb, profile))
+    }
+}
+
+fn working_path(dir: &Path, key: &str) -> PathBuf {
+    let n = WORKING_COPY.fetch_add(1, Ordering::Relaxed);
+    dir.join(format!("{key}.{}.{n}.work.i64", process::id()))
+}
+
+fn sha256_file(path: &Path) -> io::Result<[u8; 32]> {
+    let mut file = File::open(path)?;
+    let mut hasher = Sha256::new();
+    let mut buf = vec![0u8; 1 << 16];
+
+    loop {
+        let n = file.read(&mut buf)?;
+        if n == 0 {
+            break;
+        }
+        hasher.update(&buf[..n]);
+    }
+
+    Ok(hasher.finalize().into())
+}
@@ -1,12 +1,11 @@
 use crate::ffi::types::{
-    create_struct_type, create_union_type, add_field_to_type,
-    finalize_type, get_primitive_type_ordinal, get_type_size,
-    create_enum_type, add_enum_member,
-    create_array_type, create_pointer_type,
-    add_bitfield_to_struct,
-    create_function_type, add_function_parameter,
-    set_function_attributes, create_function_pointer_type,
+    create_struct_type, create_union_type, get_primitive_type_ordinal,
+    create_enum_type, create_array_type, create_pointer_type,
+    create_function_type, set_function_attributes, create_function_pointer_type,
+    set_udt_members, set_enum_members, set_function_parameters,
+    UdtFieldSpec, UdtBitfieldSpec, EnumMemberSpec, FuncParamSpec,
 };
+use crate::instrument::{self, Subsystem};
 use crate::types::Type;
 use crate::IDAError;
 
@@ -103,6 +102,7 @@ impl PrimitiveType {
 
     /// Create a Type from this primitive
     pub fn to_type(self) -> Result<Type, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "primitive_type");
         let ordinal = get_primitive_type_ordinal(self.to_ida_type());
         if ordinal == 0 {
             return Err(IDAError::ffi_with("Failed to create primitive type"));
@@ -271,6 +271,7 @@ impl TypeValidator for StructBuilder {
 
 impl TypeBuilder for StructBuilder {
     fn build(self) -> Result<Type, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "build_struct");
         // Validate before building
         TypeValidator::validate(&self)?;
         // Create the empty struct/union
@@ -288,8 +289,10 @@ impl TypeBuilder for StructBuilder {
             )));
         }
 
-        // Add fields
-        let mut current_offset = 0u64;
+        // Stage fields; offsets are resolved on the C++ side when the members
+        // are committed
+        let mut self_ptr_ordinal = None;
+        let mut fields = Vec::with_capacity(self.fields.len());
         for field in self.fields {
             // Get the field type ordinal
             let field_type_ordinal = match field.field_type {
@@ -301,8 +304,9 @@ impl TypeBuilder for StructBuilder {
                     // For forward references, we need to create a pointer to the struct being built
                     // This allows self-referential structures like linked lists
                     if name == &self.name {
-                        // Self-reference - create a pointer to this struct
-                        create_pointer_type(struct_ordinal)
+                        // Self-reference - create a pointer to this struct (once)
+                        *self_ptr_ordinal
+                            .get_or_insert_with(|| create_pointer_type(struct_ordinal))
                     } else {
                         // Forward reference to another type - this would need a type registry
                         // For now, we'll return an error
@@ -321,53 +325,30 @@ impl TypeBuilder for StructBuilder {
                 )));
             }
 
-            let offset = field.offset.unwrap_or(current_offset);
-            
-            let success = add_field_to_type(
-                struct_ordinal,
-                &field.name,
-                field_type_ordinal,
-                offset,
-            );
-
-            if !success {
-                return Err(IDAError::ffi_with(format!(
-                    "Failed to add field '{}' to {}",
-                    field.name,
-                    self.name
-                )));
-            }
-
-            // Update offset for next field (only for structs, not unions)
-            if !self.is_union && field.offset.is_none() {
-                let field_size = get_type_size(field_type_ordinal);
-                current_offset += if field_size > 0 { field_size } else { 8 };
-            }
-        }
-
-        // Add bitfields
-        for bitfield in self.bitfields {
-            let success = add_bitfield_to_struct(
-                struct_ordinal,
-                &bitfield.name,
-                bitfield.bit_offset,
-                bitfield.bit_width,
-                bitfield.is_unsigned,
-            );
-
-            if !success {
-                return Err(IDAError::ffi_with(format!(
-                    "Failed to add bitfield '{}' to {}",
-                    bitfield.name,
-                    self.name
-                )));
-            }
-        }
-
-        // Finalize the type
-        if !finalize_type(struct_ordinal) {
-            return Err(IDAError::ffi_with("Failed to finalize type"));
-        }
+            fields.push(UdtFieldSpec {
+                name: field.name,
+                type_ordinal: field_type_ordinal,
+                offset: field.offset.unwrap_or(0),
+                explicit_offset: field.offset.is_some(),
+            });
+        }
+
+        // Stage bitfields
+        let bitfields = self
+            .bitfields
+            .into_iter()
+            .map(|bitfield| UdtBitfieldSpec {
+                name: bitfield.name,
+                bit_offset: bitfield.bit_offset,
+                bit_width: bitfield.bit_width,
+                is_unsigned: bitfield.is_unsigned,
+            })
+            .collect::<Vec<_>>();
+
+        // Commit all members with a single type library store
+        set_udt_members(struct_ordinal, &fields, &bitfields).map_err(|e| {
+            IDAError::ffi_with(format!("Failed to add members to {}: {e}", self.name))
+        })?;
 
         Ok(Type::from_ordinal(struct_ordinal))
     }
@@ -499,6 +480,7 @@ impl TypeValidator for EnumBuilder {
 
 impl TypeBuilder for EnumBuilder {
     fn build(self) -> Result<Type, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "build_enum");
         // Validate before building
         TypeValidator::validate(&self)?;
 
@@ -511,20 +493,22 @@ impl TypeBuilder for EnumBuilder {
             )));
         }
 
-        // Add members
-        for member in self.members {
-            if !add_enum_member(enum_ordinal, &member.name, member.value) {
-                return Err(IDAError::ffi_with(format!(
-                    "Failed to add member '{}' to enum '{}'",
-                    member.name, self.name
-                )));
-            }
-        }
+        // Add members with a single type library store
+        let members = self
+            .members
+            .into_iter()
+            .map(|member| EnumMemberSpec {
+                name: member.name,
+                value: member.value,
+            })
+            .collect::<Vec<_>>();
 
-        // Finalize the type
-        if !finalize_type(enum_ordinal) {
-            return Err(IDAError::ffi_with("Failed to finalize enum type"));
-        }
+        set_enum_members(enum_ordinal, &members).map_err(|e| {
+            IDAError::ffi_with(format!(
+                "Failed to add members to enum '{}': {e}",
+                self.name
+            ))
+        })?;
 
         Ok(Type::from_ordinal(enum_ordinal))
     }
@@ -549,6 +533,7 @@ impl ArrayBuilder {
 
 impl TypeBuilder for ArrayBuilder {
     fn build(self) -> Result<Type, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "build_array");
         // Get the element type ordinal
         let element_ordinal = match self.element_type {
             FieldType::Primitive(prim) => get_primitive_type_ordinal(prim.to_ida_type()),
@@ -591,6 +576,7 @@ impl PointerBuilder {
 
 impl TypeBuilder for PointerBuilder {
     fn build(self) -> Result<Type, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "build_pointer");
         // Get the target type ordinal
         let target_ordinal = match self.target_type {
             FieldType::Primitive(prim) => get_primitive_type_ordinal(prim.to_ida_type()),
@@ -793,6 +779,7 @@ impl TypeValidator for FunctionBuilder {
 
 impl TypeBuilder for FunctionBuilder {
     fn build(self) -> Result<Type, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "build_function");
         // Validate before building
         TypeValidator::validate(&self)?;
         
@@ -819,7 +806,8 @@ impl TypeBuilder for FunctionBuilder {
             return Err(IDAError::ffi_with("Failed to create function type"));
         }
         
-        // Add parameters
+        // Stage parameters
+        let mut params = Vec::with_capacity(self.parameters.len());
         for param in self.parameters {
             let param_ordinal = match param.param_type {
                 FieldType::Primitive(prim) => get_primitive_type_ordinal(prim.to_ida_type()),
@@ -838,19 +826,18 @@ impl TypeBuilder for FunctionBuilder {
                 )));
             }
             
-            if !add_function_parameter(
-                func_ordinal,
-                &param.name,
-                param_ordinal,
-                param.is_hidden,
-            ) {
-                return Err(IDAError::ffi_with(format!(
-                    "Failed to add parameter '{}'",
-                    param.name
-                )));
-            }
+            params.push(FuncParamSpec {
+                name: param.name,
+                type_ordinal: param_ordinal,
+                is_hidden: param.is_hidden,
+            });
         }
         
+        // Add parameters with a single type library store
+        set_function_parameters(func_ordinal, &params).map_err(|e| {
+            IDAError::ffi_with(format!("Failed to add parameters: {e}"))
+        })?;
+        
         // Set function attributes
         if !set_function_attributes(
             func_ordinal,
@@ -884,6 +871,7 @@ impl FunctionPointerBuilder {
 
 impl TypeBuilder for FunctionPointerBuilder {
     fn build(self) -> Result<Type, IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "build_function_pointer");
         let ptr_ordinal = create_function_pointer_type(self.function_type.ordinal());
         
         if ptr_ordinal == 0 {
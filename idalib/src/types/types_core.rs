@@ -1,10 +1,11 @@
 use std::marker::PhantomData;
 
 use crate::ffi::types::{
-    idalib_apply_type_by_ordinal, idalib_get_type_ordinal_limit, idalib_is_valid_type_ordinal,
-    idalib_tinfo_get_name_by_ordinal,
+    idalib_apply_type_by_ordinal, idalib_get_type_ordinal_limit, idalib_get_type_table,
+    idalib_is_valid_type_ordinal, idalib_tinfo_get_name_by_ordinal, type_table_t,
 };
 use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
 use crate::{Address, IDAError};
 
 pub type TypeIndex = u32;
@@ -34,6 +35,7 @@ impl Type {
     }
 
     pub fn name(&self) -> Option<String> {
+        let _ffi = instrument::scope(Subsystem::Types, "type_name");
         let name = unsafe { idalib_tinfo_get_name_by_ordinal(self.ordinal) }.ok()?;
         if name.is_empty() {
             None
@@ -53,6 +55,7 @@ impl Type {
         address: Address,
         flags: TypeFlags,
     ) -> Result<(), IDAError> {
+        let _ffi = instrument::scope(Subsystem::Types, "apply_type");
         let success =
             unsafe { idalib_apply_type_by_ordinal(address.into(), self.ordinal, flags as u32) };
         if success {
@@ -80,6 +83,7 @@ impl<'a> TypeList<'a> {
     }
 
     pub fn get_by_index(&self, index: TypeIndex) -> Option<Type> {
+        let _ffi = instrument::scope(Subsystem::Types, "get_by_index");
         if index == 0 {
             return None; // Ordinals start at 1
         }
@@ -93,6 +97,7 @@ impl<'a> TypeList<'a> {
     }
 
     pub fn len(&self) -> usize {
+        let _ffi = instrument::scope(Subsystem::Types, "type_ordinal_limit");
         let limit = unsafe { idalib_get_type_ordinal_limit() };
         if limit == 0 || limit == u32::MAX {
             0
@@ -106,12 +111,30 @@ impl<'a> TypeList<'a> {
     }
 
     pub fn iter(&self) -> TypeListIter<'_, 'a> {
+        let _ffi = instrument::scope(Subsystem::Types, "type_ordinal_limit");
         TypeListIter {
             type_list: self,
             current_ordinal: 1, // Start at 1, not 0
             max_ordinal: unsafe { idalib_get_type_ordinal_limit() },
         }
     }
+
+    /// Enumerate every local type with a single walk of the type library,
+    /// capturing ordinals, names, kinds and sizes.
+    pub fn snapshot(&self) -> TypeListSnapshot {
+        self.snapshot_with(true, false)
+    }
+
+    /// As `snapshot`, choosing whether to compute sizes (which requires
+    /// deserializing each type) and whether to also copy each type's
+    /// serialized type and fields strings.
+    pub fn snapshot_with(&self, sizes: bool, serialized: bool) -> TypeListSnapshot {
+        let _ffi = instrument::scope(Subsystem::Types, "snapshot_with");
+        let mut raw = type_table_t::default();
+        unsafe { idalib_get_type_table(sizes, serialized, &mut raw) };
+
+        TypeListSnapshot::new(raw)
+    }
 }
 
 pub struct TypeListIter<'s, 'a> {
@@ -136,3 +159,197 @@ impl<'s, 'a> Iterator for TypeListIter<'s, 'a> {
         None
     }
 }
+
+/// The kind of a local type, taken from its serialized form without
+/// decoding it.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+#[repr(u8)]
+pub enum TypeKind {
+    Unknown = 0,
+    Primitive = 1,
+    Pointer = 2,
+    Array = 3,
+    Function = 4,
+    Struct = 5,
+    Union = 6,
+    Enum = 7,
+    Typedef = 8,
+}
+
+impl TypeKind {
+    fn from_raw(raw: u8) -> Self {
+        match raw {
+            1 => Self::Primitive,
+            2 => Self::Pointer,
+            3 => Self::Array,
+            4 => Self::Function,
+            5 => Self::Struct,
+            6 => Self::Union,
+            7 => Self::Enum,
+            8 => Self::Typedef,
+            _ => Self::Unknown,
+        }
+    }
+}
+
+/// A copy of the local type list taken in one call; names (and, if
+/// requested, serialized types) share single buffers. Full type details
+/// are only decoded on demand, via `TypeEntry::to_type`.
+#[derive(Debug, Clone)]
+pub struct TypeListSnapshot {
+    ordinals: Vec<TypeIndex>,
+    kinds: Vec<u8>,
+    sizes: Vec<u64>,
+    name_offsets: Vec<u32>,
+    names: String,
+    type_offsets: Vec<u32>,
+    field_offsets: Vec<u32>,
+    serialized: Vec<u8>,
+}
+
+impl TypeListSnapshot {
+    fn new(raw: type_table_t) -> Self {
+        let type_table_t {
+            ordinals,
+            kinds,
+            sizes,
+            name_offsets,
+            names,
+            type_offsets,
+            field_offsets,
+            serialized,
+        } = raw;
+
+        // NOTE: type names are normally ASCII, so this only copies in the
+        // rare case where one is not valid UTF-8
+        let (names, name_offsets) = match String::from_utf8(names) {
+            Ok(names) => (names, name_offsets),
+            Err(e) => {
+                let bytes = e.into_bytes();
+                let mut packed = String::with_capacity(bytes.len());
+                let mut offsets = Vec::with_capacity(name_offsets.len());
+                offsets.push(0);
+
+                for range in name_offsets.windows(2) {
+                    let name = &bytes[range[0] as usize..range[1] as usize];
+                    packed.push_str(&String::from_utf8_lossy(name));
+                    offsets.push(packed.len() as u32);
+                }
+
+                (packed, offsets)
+            }
+        };
+
+        Self {
+            ordinals,
+            kinds,
+            sizes,
+            name_offsets,
+            names,
+            type_offsets,
+            field_offsets,
+            serialized,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.ordinals.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.ordinals.is_empty()
+    }
+
+    /// Valid ordinals, in ascending order.
+    pub fn ordinals(&self) -> &[TypeIndex] {
+        &self.ordinals
+    }
+
+    pub fn get(&self, index: usize) -> Option<TypeEntry<'_>> {
+        (index < self.len()).then(|| self.entry(index))
+    }
+
+    pub fn get_by_ordinal(&self, ordinal: TypeIndex) -> Option<TypeEntry<'_>> {
+        let index = self.ordinals.binary_search(&ordinal).ok()?;
+        Some(self.entry(index))
+    }
+
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = TypeEntry<'_>> + '_ {
+        (0..self.len()).map(|i| self.entry(i))
+    }
+
+    /// True if the snapshot holds serialized types.
+    pub fn has_serialized(&self) -> bool {
+        self.field_offsets.len() == self.len() && !self.is_empty()
+    }
+
+    fn entry(&self, index: usize) -> TypeEntry<'_> {
+        let name =
+            &self.names[self.name_offsets[index] as usize..self.name_offsets[index + 1] as usize];
+
+        let serialized = self.has_serialized().then(|| {
+            let start = self.type_offsets[index] as usize;
+            let fields = self.field_offsets[index] as usize;
+            let end = self.type_offsets[index + 1] as usize;
+            (
+                &self.serialized[start..fields],
+                &self.serialized[fields..end],
+            )
+        });
+
+        TypeEntry {
+            ordinal: self.ordinals[index],
+            kind: TypeKind::from_raw(self.kinds[index]),
+            size: self.sizes[index],
+            name,
+            serialized,
+        }
+    }
+}
+
+/// A type borrowed from a `TypeListSnapshot`.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct TypeEntry<'s> {
+    ordinal: TypeIndex,
+    kind: TypeKind,
+    size: u64,
+    name: &'s str,
+    serialized: Option<(&'s [u8], &'s [u8])>,
+}
+
+impl<'s> TypeEntry<'s> {
+    pub fn ordinal(&self) -> TypeIndex {
+        self.ordinal
+    }
+
+    pub fn kind(&self) -> TypeKind {
+        self.kind
+    }
+
+    /// Size in bytes; `None` if unknown or if sizes were not requested.
+    pub fn size(&self) -> Option<u64> {
+        (self.size != u64::MAX).then_some(self.size)
+    }
+
+    /// The type's name; empty for unnamed types.
+    pub fn name(&self) -> &'s str {
+        self.name
+    }
+
+    /// The serialized type string, if the snapshot was taken with
+    /// serialized types.
+    pub fn type_string(&self) -> Option<&'s [u8]> {
+        self.serialized.map(|(type_, _)| type_)
+    }
+
+    /// The serialized fields string (member names), if the snapshot was
+    /// taken with serialized types.
+    pub fn fields_string(&self) -> Option<&'s [u8]> {
+        self.serialized.map(|(_, fields)| fields)
+    }
+
+    /// The full type, for details beyond those in the snapshot.
+    pub fn to_type(&self) -> Type {
+        Type::from_ordinal(self.ordinal)
+    }
+}
@@ -8,6 +8,7 @@ use crate::ffi::xref::dref_t::*;
 use crate::ffi::xref::*;
 
 use crate::idb::IDB;
+use crate::instrument::{self, Subsystem};
 use crate::Address;
 
 pub struct XRef<'a> {
@@ -79,6 +80,146 @@ bitflags! {
     }
 }
 
+fn decode_flags(raw: u8) -> XRefFlags {
+    XRefFlags::from_bits_retain(raw & !(XREF_MASK as u8))
+}
+
+fn decode_type(iscode: bool, raw: u8) -> XRefType {
+    let type_ = raw & (XREF_MASK as u8);
+
+    if iscode {
+        XRefType::Code(unsafe { mem::transmute::<u8, CodeRef>(type_) })
+    } else {
+        XRefType::Data(unsafe { mem::transmute::<u8, DataRef>(type_) })
+    }
+}
+
+/// Restricts batched xref queries to code or data references.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Hash)]
+#[repr(u8)]
+pub enum XRefKinds {
+    #[default]
+    All = 0,
+    Code = 1,
+    Data = 2,
+}
+
+/// A reusable buffer of xrefs filled by `IDB::xrefs_to_into` and friends.
+#[derive(Debug, Default)]
+pub struct XRefBuffer {
+    items: Vec<xref_item_t>,
+}
+
+impl XRefBuffer {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    pub fn with_capacity(capacity: usize) -> Self {
+        Self {
+            items: Vec::with_capacity(capacity),
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.items.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.items.is_empty()
+    }
+
+    pub fn clear(&mut self) {
+        self.items.clear();
+    }
+
+    pub fn get(&self, index: usize) -> Option<XRefEntry> {
+        self.items.get(index).map(XRefEntry::from_item)
+    }
+
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = XRefEntry> + '_ {
+        self.items.iter().map(XRefEntry::from_item)
+    }
+
+    pub(crate) fn fill(
+        &mut self,
+        start: Address,
+        end: Address,
+        to: bool,
+        flags: XRefQuery,
+        kinds: XRefKinds,
+    ) -> usize {
+        let _ffi = instrument::scope(Subsystem::XRefs, "xrefs_collect");
+        let len = self.items.len();
+        unsafe {
+            idalib_xrefs_collect(
+                start.into(),
+                end.into(),
+                to,
+                flags.bits().into(),
+                kinds as u8,
+                &mut self.items,
+            )
+        };
+        self.items.len() - len
+    }
+}
+
+/// A plain copy of an xref, as produced by batched queries.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct XRefEntry {
+    from: Address,
+    to: Address,
+    iscode: bool,
+    raw: u8,
+    user: bool,
+}
+
+impl XRefEntry {
+    fn from_item(item: &xref_item_t) -> Self {
+        Self {
+            from: item.from,
+            to: item.to,
+            iscode: item.iscode,
+            raw: item.kind,
+            user: item.user,
+        }
+    }
+
+    pub fn from(&self) -> Address {
+        self.from
+    }
+
+    pub fn to(&self) -> Address {
+        self.to
+    }
+
+    pub fn flags(&self) -> XRefFlags {
+        decode_flags(self.raw)
+    }
+
+    pub fn type_(&self) -> XRefType {
+        decode_type(self.iscode, self.raw)
+    }
+
+    /// The `cref_t` or `dref_t` value of the xref, without its flags.
+    pub(crate) fn raw_type(&self) -> u8 {
+        self.raw & (XREF_MASK as u8)
+    }
+
+    pub fn is_code(&self) -> bool {
+        self.iscode
+    }
+
+    pub fn is_data(&self) -> bool {
+        !self.iscode
+    }
+
+    pub fn is_user_defined(&self) -> bool {
+        self.user
+    }
+}
+
 impl<'a> XRef<'a> {
     pub(crate) fn from_repr(inner: xrefblk_t) -> Self {
         Self {
@@ -96,18 +237,11 @@ impl<'a> XRef<'a> {
     }
 
     pub fn flags(&self) -> XRefFlags {
-        let flags = self.inner.type_ & !(XREF_MASK as u8);
-        XRefFlags::from_bits_retain(flags)
+        decode_flags(self.inner.type_)
     }
 
     pub fn type_(&self) -> XRefType {
-        let type_ = self.inner.type_ & (XREF_MASK as u8);
-
-        if self.is_code() {
-            XRefType::Code(unsafe { mem::transmute::<u8, CodeRef>(type_) })
-        } else {
-            XRefType::Data(unsafe { mem::transmute::<u8, DataRef>(type_) })
-        }
+        decode_type(self.inner.iscode, self.inner.type_)
     }
 
     pub fn is_code(&self) -> bool {
@@ -123,6 +257,7 @@ impl<'a> XRef<'a> {
     }
 
     pub fn next_to(&self) -> Option<Self> {
+        let _ffi = instrument::scope(Subsystem::XRefs, "next_to");
         let mut curr = self.clone();
 
         let found = unsafe { xrefblk_t_next_to(&mut curr.inner as *mut _) };
@@ -135,6 +270,7 @@ impl<'a> XRef<'a> {
     }
 
     pub fn next_from(&self) -> Option<Self> {
+        let _ffi = instrument::scope(Subsystem::XRefs, "next_from");
         let mut curr = self.clone();
 
         let found = unsafe { xrefblk_t_next_from(&mut curr.inner as *mut _) };